@@ -53,6 +53,8 @@ extern "C" {
 #include <math.h>
 #include <float.h>
 
+#include "hdsp_config.h"
+
 #define HDSP_FIR_FILTER_LEN_MAX 4096
 #define HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB 60
 #define HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB 0.1
@@ -71,12 +73,35 @@ enum hdsp_conv_type {
 };
 typedef enum hdsp_conv_type hdsp_conv_type_t;
 
+/**
+ * Instruction sets of SIMD kernels, see hdsp_simd_set.
+ */
+enum hdsp_simd {
+    HDSP_SIMD_NONE, // scalar code
+    HDSP_SIMD_SSE2,
+    HDSP_SIMD_AVX2,
+    HDSP_SIMD_AVX512,
+    HDSP_SIMD_NEON
+};
+typedef enum hdsp_simd hdsp_simd_t;
+
+#define HDSP_CONV_FFT_TAPS_MIN 32u // hdsp_fir_filter_ctx and hdsp_fir_filter_batch switch to FFT at this many
+                                   // multiplies per sample (scalar code, SIMD kernels switch later)
+
 enum hdsp_filter_design_method {
     HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING,
-    HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES
+    HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES,
+    HDSP_FILTER_DESIGN_METHOD_REMEZ // Parks-McClellan equiripple
 };
 typedef enum hdsp_filter_design_method hdsp_filter_design_method_t;
 
+enum hdsp_window {
+    HDSP_WINDOW_NONE,
+    HDSP_WINDOW_HAMMING,
+    HDSP_WINDOW_KAISER
+};
+typedef enum hdsp_window hdsp_window_t;
+
 #define hdsp_min(x, y) ((x) < (y) ? (x) : (y))
 #define hdsp_max(x, y) ((x) < (y) ? (y) : (x))
 
@@ -86,6 +111,14 @@ enum hdsp_status {
 };
 typedef enum hdsp_status hdsp_status_t;
 
+#define HDSP_FIR_ZERO_TAP_EPSILON 1e-12 // taps smaller than this (relative to the largest tap) are skipped
+
+enum hdsp_filter_symmetry {
+    HDSP_FILTER_SYMMETRY_NONE,
+    HDSP_FILTER_SYMMETRY_EVEN // b[k] == b[b_len - 1 - k], linear phase
+};
+typedef enum hdsp_filter_symmetry hdsp_filter_symmetry_t;
+
 struct hdsp_filter {
     double a[HDSP_FIR_FILTER_LEN_MAX]; // nominator
     size_t a_len;
@@ -94,9 +127,358 @@ struct hdsp_filter {
     uint16_t passband_freq_hz; // Passband frequency in Hertz
     uint16_t fs_hz; // Sampling rate in Hz
     hdsp_filter_design_method_t design_method;
+    int analysed; // b_nz_len and symmetry are set (by hdsp_fir_filter_analyse)
+    size_t b_nz_len; // number of non-zero taps in b, if analysed (see hdsp_fir_filter_nz_idx)
+    hdsp_filter_symmetry_t symmetry; // symmetry of b, if analysed
 };
 typedef struct hdsp_filter hdsp_filter_t;
 
+/**
+ * Lowpass filter specification for runtime designs (hdsp_fir_filter_design_lowpass).
+ * Passband ripple is peak-to-peak in dB (as for hdsp_design_kaiser_n_beta), stopband attenuation
+ * is relative to unity gain.
+ */
+struct hdsp_lowpass_spec {
+    uint16_t fs_hz; // Sampling rate in Hz
+    uint16_t passband_freq_hz; // Passband edge in Hz
+    uint16_t stopband_freq_hz; // Stopband edge in Hz, passband_freq_hz < stopband_freq_hz < fs_hz / 2
+    double passband_ripple_db;
+    double stopband_attenuation_db;
+};
+typedef struct hdsp_lowpass_spec hdsp_lowpass_spec_t;
+
+#define HDSP_FIR_ALIGN 64 // alignment of taps of hdsp_fir_t in bytes (cache line)
+#define HDSP_FIR_LEN_MAX UINT16_MAX // maximum length of hdsp_fir_t
+
+/**
+ * Compact FIR filter handle: taps are allocated at their length (HDSP_FIR_ALIGN aligned), the handle itself
+ * is a few words, while hdsp_filter_t holds HDSP_FIR_FILTER_LEN_MAX taps inline.
+ * Handle made by hdsp_fir_view borrows taps of hdsp_filter_t (mem is NULL) and is valid as long as the filter.
+ * Taps aren't modified by filtering, so a handle can be shared by many threads.
+ */
+struct hdsp_fir {
+    double *b; // b_len taps
+    size_t b_len;
+    uint16_t *b_nz_idx; // indices of non-zero taps in b, ascending, NULL if all taps are used
+    size_t b_nz_len; // number of non-zero taps in b (b_len if b_nz_idx is NULL)
+    hdsp_filter_symmetry_t symmetry; // symmetry of b
+    uint16_t passband_freq_hz; // Passband frequency in Hertz
+    uint16_t fs_hz; // Sampling rate in Hz
+    void *mem; // allocated memory of taps and indices, NULL for a view
+};
+typedef struct hdsp_fir hdsp_fir_t;
+
+/**
+ * Lowpass filter design: hdsp_fir_filter_init_lowpass(filter, n, fs_hz, passband_freq_hz, method) shaped
+ * by window, see hdsp_fir_filter_init_design. Key of designs shared by hdsp_fir_cache.
+ */
+struct hdsp_fir_design {
+    uint16_t fs_hz; // Sampling rate in Hz
+    uint16_t passband_freq_hz; // Passband frequency in Hertz
+    size_t n; // filter length
+    hdsp_filter_design_method_t method;
+    hdsp_window_t window;
+    double beta; // HDSP_WINDOW_KAISER only
+};
+typedef struct hdsp_fir_design hdsp_fir_design_t;
+
+/**
+ * Single precision FIR filter (taps of hdsp_filter_t rounded to float), for processing in float end to end.
+ */
+struct hdsp_filter_float {
+    float b[HDSP_FIR_FILTER_LEN_MAX];
+    size_t b_len;
+    uint16_t passband_freq_hz; // Passband frequency in Hertz
+    uint16_t fs_hz; // Sampling rate in Hz
+};
+typedef struct hdsp_filter_float hdsp_filter_float_t;
+
+/**
+ * Fixed-point FIR filter, taps of hdsp_filter_t quantized to 16 bits with common (block) scaling:
+ * b[k] ~ b_q[k] / 2^shift. Shift is chosen as large as possible (for precision) such that filtering
+ * of any int16 input accumulates in int32 without overflow.
+ */
+struct hdsp_filter_q15 {
+    int16_t b_rev[HDSP_FIR_FILTER_LEN_MAX]; // quantized taps in reverse order, b_rev[j] = b_q[b_len - 1 - j]
+    size_t b_len;
+    int shift; // taps are scaled by 2^shift (shift = 15 is Q15)
+    uint16_t passband_freq_hz; // Passband frequency in Hertz
+    uint16_t fs_hz; // Sampling rate in Hz
+};
+typedef struct hdsp_filter_q15 hdsp_filter_q15_t;
+
+#define HDSP_INTERP_FACTOR_MAX 32
+
+/**
+ * Polyphase interpolator. Taps of a FIR filter designed at the output (upsampled) rate
+ * are split into upsample_factor sub-filters, sub-filter p holding taps b[p], b[p + L], b[p + 2L], ...
+ * All sub-filters are stored back to back in h, sub-filter p starts at h[phase_offset[p]]
+ * and has phase_offset[p + 1] - phase_offset[p] taps.
+ */
+struct hdsp_interp {
+    double h[HDSP_FIR_FILTER_LEN_MAX]; // polyphase taps
+    uint16_t phase_offset[HDSP_INTERP_FACTOR_MAX + 1];
+    size_t b_len; // length of the prototype filter
+    int upsample_factor;
+};
+typedef struct hdsp_interp hdsp_interp_t;
+
+/**
+ * Single precision polyphase interpolator, see hdsp_interp_t.
+ */
+struct hdsp_interp_float {
+    float h[HDSP_FIR_FILTER_LEN_MAX]; // polyphase taps
+    uint16_t phase_offset[HDSP_INTERP_FACTOR_MAX + 1];
+    size_t b_len; // length of the prototype filter
+    int upsample_factor;
+};
+typedef struct hdsp_interp_float hdsp_interp_float_t;
+
+/**
+ * Decimating FIR filter (lowpass filter and downsampler in one), keeping filter state between frames.
+ * It is a causal filter, output lags input by (b_len - 1) / 2 input samples (group delay of a symmetric filter).
+ */
+struct hdsp_decim {
+    double b[HDSP_FIR_FILTER_LEN_MAX];
+    size_t b_len;
+    int16_t history[HDSP_FIR_FILTER_LEN_MAX]; // last b_len - 1 input samples, oldest first
+    int downsample_factor;
+};
+typedef struct hdsp_decim hdsp_decim_t;
+
+/**
+ * Single precision decimating FIR filter, see hdsp_decim_t.
+ */
+struct hdsp_decim_float {
+    float b[HDSP_FIR_FILTER_LEN_MAX];
+    size_t b_len;
+    float history[HDSP_FIR_FILTER_LEN_MAX]; // last b_len - 1 input samples, oldest first
+    int downsample_factor;
+};
+typedef struct hdsp_decim_float hdsp_decim_float_t;
+
+/**
+ * Streaming FIR filter, keeps filter state (last b_len - 1 input samples) between frames.
+ * It is a causal filter, output lags input by (b_len - 1) / 2 samples, see hdsp_fir_stream_delay.
+ */
+struct hdsp_fir_stream {
+    double b[HDSP_FIR_FILTER_LEN_MAX];
+    size_t b_len;
+    int16_t history[HDSP_FIR_FILTER_LEN_MAX]; // last b_len - 1 input samples, oldest first
+};
+typedef struct hdsp_fir_stream hdsp_fir_stream_t;
+
+#define HDSP_FFT_FACTORS_MAX 64
+
+enum hdsp_fft_type {
+    HDSP_FFT_TYPE_COMPLEX, // n complex points -> n complex points
+    HDSP_FFT_TYPE_REAL // n real samples -> n/2 + 1 complex points (computed with n/2 point complex FFT)
+};
+typedef enum hdsp_fft_type hdsp_fft_type_t;
+
+/**
+ * FFT plan: factorization, digit reversal permutation and twiddle factors precomputed for transforms
+ * of given length. Length of the complex transform must be 2^a 3^b 5^c (see hdsp_fft_len_ceil),
+ * e.g. 480, 960, 1024. Plan isn't modified by transforms, so it can be shared by many threads.
+ * Complex data is interleaved (re, im, re, im, ...).
+ */
+struct hdsp_fft_plan {
+    size_t n; // transform length
+    size_t cn; // length of complex transform, n (complex) or n/2 (real)
+    hdsp_fft_type_t type;
+    size_t n_factors;
+    size_t factors[HDSP_FFT_FACTORS_MAX]; // radices (4, 2, 3, 5) in order of stages
+    size_t *perm; // digit reversal, cn elements
+    double *w; // twiddle factors exp(-2*pi*i*k/n), k = 0, ..., n - 1, interleaved
+    int mem_external; // tables are in caller's memory (hdsp_fft_plan_init_mem), not freed by hdsp_fft_plan_deinit
+};
+typedef struct hdsp_fft_plan hdsp_fft_plan_t;
+
+/**
+ * Streaming FIR filter convolving by FFT (overlap-save), for long filters. Frames are processed in blocks
+ * of up to frame_len samples, each block together with last b_len - 1 input samples is transformed
+ * with fft_len-point FFT and multiplied by spectrum of the filter. Output is the same as of hdsp_fir_stream_t.
+ */
+struct hdsp_fir_fft_stream {
+    size_t b_len;
+    size_t frame_len; // maximum number of samples filtered with one FFT
+    size_t fft_len; // at least frame_len + b_len - 1
+    hdsp_fft_plan_t plan; // real FFT of fft_len points
+    double *b_spec; // spectrum of b, fft_len / 2 + 1 points
+    double *block; // history and block of input, fft_len samples
+    double *spec; // spectrum of the block, fft_len / 2 + 1 points
+    int16_t history[HDSP_FIR_FILTER_LEN_MAX]; // last b_len - 1 input samples, oldest first
+};
+typedef struct hdsp_fir_fft_stream hdsp_fir_fft_stream_t;
+
+/**
+ * FIR filtering context, for filtering frames (as hdsp_fir_filter does) without allocating memory per call.
+ * Context is created once for the longest frame and filter, its workspace (FFT plan and blocks, needed
+ * for long filters only) is allocated then or provided by the caller (see hdsp_fir_ctx_workspace_size).
+ */
+struct hdsp_fir_ctx {
+    size_t frame_len_max; // maximum number of samples in a frame
+    size_t b_len_max; // maximum filter length
+    hdsp_filter_t *filter; // filter in use, not copied (must outlive the context or be replaced), NULL if fir was set
+    hdsp_fir_t fir; // taps in use, view of filter or of handle set by hdsp_fir_ctx_set_fir
+    size_t fft_len; // real FFT length, 0 if frames are always convolved directly
+    hdsp_fft_plan_t plan; // real FFT of fft_len points, tables in workspace
+    double *b_spec; // spectrum of filter, fft_len / 2 + 1 points
+    double *spec; // spectrum of a block, fft_len / 2 + 1 points
+    double *block; // block of input, fft_len samples
+    void *workspace;
+    int workspace_owned; // workspace was allocated by hdsp_fir_ctx_init
+};
+typedef struct hdsp_fir_ctx hdsp_fir_ctx_t;
+
+/**
+ * Streaming FIR filter convolving by FFT with uniformly partitioned filter, for long filters at low latency.
+ * Filter is split into n_parts partitions of block_len taps. Each block of block_len input samples
+ * is transformed once (2 * block_len point FFT) and its spectrum is kept in the frequency-domain delay line,
+ * output spectrum is a sum of last n_parts input spectra multiplied by spectra of the partitions.
+ * Frames are processed as soon as a block is complete, so latency is one block regardless of filter length.
+ * Output is the same as of hdsp_fir_stream_t.
+ */
+struct hdsp_fir_part_stream {
+    size_t b_len;
+    size_t block_len; // number of samples in a block (and taps in a partition)
+    size_t n_parts; // number of partitions
+    hdsp_fft_plan_t plan; // real FFT of 2 * block_len points
+    double *h_spec; // spectra of partitions, n_parts * (block_len + 1) points
+    double *fdl; // frequency-domain delay line, spectra of last n_parts input blocks
+    size_t fdl_pos; // position of spectrum of the newest block in fdl
+    double *block; // last 2 * block_len input samples
+    double *acc; // output spectrum, block_len + 1 points
+    double *out; // output of the inverse FFT, 2 * block_len samples
+};
+typedef struct hdsp_fir_part_stream hdsp_fir_part_stream_t;
+
+#define HDSP_RESAMPLER_PASSBAND 0.9 // passband edge of the resampler's filter, as fraction of the lower Nyquist freq
+#define HDSP_RESAMPLER_TAPS_MAX 65535u // maximum length of the resampler's prototype filter
+
+#define HDSP_DITHER_LANES 16 // independent generators of hdsp_dither_t, sample j takes noise of lane j % 16
+
+/**
+ * TPDF dither generator: HDSP_DITHER_LANES xorshift32 generators stepped together (one per lane of
+ * vector kernels), so dithered output is the same whichever instruction set is used.
+ * Not thread safe, each stream should have its own one (see hdsp_dither_init).
+ */
+struct hdsp_dither {
+    uint32_t state[HDSP_DITHER_LANES];
+};
+typedef struct hdsp_dither hdsp_dither_t;
+
+enum hdsp_sample_type {
+    HDSP_SAMPLE_INT16,
+    HDSP_SAMPLE_INT32,
+    HDSP_SAMPLE_FLOAT,
+    HDSP_SAMPLE_DOUBLE
+};
+typedef enum hdsp_sample_type hdsp_sample_type_t;
+
+#define HDSP_VIEW_BLOCK_LEN 1024 // samples gathered/scattered at a time by functions taking strided views
+
+/**
+ * Strided view of samples owned by someone else: sample i is element i * stride of data (of type).
+ * Views are made by hdsp_view* functions below and passed by value, decimation (hdsp_view_decimate),
+ * picking a channel of interleaved frames (hdsp_view_channel) and slicing (hdsp_view_slice) make
+ * a new view, no samples are copied. Invalid arguments give an empty view (data is NULL, len is 0).
+ * Views are taken only by the *_view functions. Input and output views must not share samples
+ * (e.g. filtering a channel of interleaved frames into another channel of the same frames is fine,
+ * into itself is not), such calls fail with HDSP_STATUS_FALSE, except converting a view in place.
+ */
+struct hdsp_view {
+    void *data;
+    size_t len; // number of samples
+    size_t stride; // distance between samples, in samples of type (1 for contiguous buffer)
+    hdsp_sample_type_t type;
+};
+typedef struct hdsp_view hdsp_view_t;
+
+/**
+ * Rational L/M resampler (polyphase filter bank). Prototype lowpass filter runs at L * fs_in (= M * fs_out)
+ * and is split into L sub-filters of taps_per_phase taps each. For each output sample only one sub-filter
+ * is evaluated against the last taps_per_phase input samples, L-times upsampled signal is never created.
+ */
+struct hdsp_resampler {
+    uint32_t fs_in_hz;
+    uint32_t fs_out_hz;
+    int upsample_factor; // L = fs_out / gcd(fs_in, fs_out)
+    int downsample_factor; // M = fs_in / gcd(fs_in, fs_out)
+    double *bank; // L sub-filters, sub-filter p at bank[p * taps_per_phase], taps in reverse order
+    size_t taps_per_phase;
+    double *delay; // delay line, 2 * taps_per_phase frames of n_channels samples (each frame written twice)
+    size_t delay_pos;
+    int phase; // position of next output sample on the L-times upsampled time axis, relative to next input
+    size_t n_channels; // channels of interleaved frames (see hdsp_resampler_init_interleaved), 1 for mono
+};
+typedef struct hdsp_resampler hdsp_resampler_t;
+
+/**
+ * Single precision rational L/M resampler, see hdsp_resampler_t.
+ */
+struct hdsp_resampler_float {
+    uint32_t fs_in_hz;
+    uint32_t fs_out_hz;
+    int upsample_factor; // L = fs_out / gcd(fs_in, fs_out)
+    int downsample_factor; // M = fs_in / gcd(fs_in, fs_out)
+    float *bank; // L sub-filters, sub-filter p at bank[p * taps_per_phase]
+    size_t taps_per_phase;
+    float *delay; // delay line, 2 * taps_per_phase samples (each sample written twice)
+    size_t delay_pos;
+    int phase; // position of next output sample on the L-times upsampled time axis, relative to next input
+};
+typedef struct hdsp_resampler_float hdsp_resampler_float_t;
+
+#define HDSP_MULTISTAGE_STAGES_MAX 4
+
+/**
+ * Multistage resampler for integer ratios (e.g. 48000 -> 8000 as 2 x 3), cascade of resamplers.
+ * Each stage only needs to protect the final band (up to HDSP_RESAMPLER_PASSBAND of the lower Nyquist frequency),
+ * so the stages running at high rates get wide transition bands and short filters.
+ */
+struct hdsp_multistage {
+    uint32_t fs_in_hz;
+    uint32_t fs_out_hz;
+    int n_stages;
+    int factors[HDSP_MULTISTAGE_STAGES_MAX]; // upsampling (or downsampling) factor of each stage, in order
+    hdsp_resampler_t stage[HDSP_MULTISTAGE_STAGES_MAX];
+    double *buf[2]; // intermediate signals
+    size_t buf_len;
+    size_t max_frame_len;
+    double macs_per_output; // total multiply-adds per output sample
+};
+typedef struct hdsp_multistage hdsp_multistage_t;
+
+#define HDSP_ASRC_ZERO_CROSSINGS 16 // half-length of the interpolation kernel in (input) samples
+#define HDSP_ASRC_TABLE_OVERSAMPLING 256 // kernel table resolution, entries per sample
+#define HDSP_ASRC_TABLE_LEN (HDSP_ASRC_ZERO_CROSSINGS * HDSP_ASRC_TABLE_OVERSAMPLING + 1)
+#define HDSP_ASRC_CUTOFF 0.88 // kernel cutoff, as fraction of the lower Nyquist frequency
+#define HDSP_ASRC_TAPS_MAX 256 // maximum number of taps per output sample (limits downsampling ratio to 1/8)
+#define HDSP_ASRC_DRIFT_PPM_MAX 1000.0 // maximum correction applied by hdsp_asrc_track
+#define HDSP_ASRC_DRIFT_KP 0.01 // proportional gain of hdsp_asrc_track, ratio change per second of fill error
+#define HDSP_ASRC_DRIFT_KI 0.0005 // integral gain of hdsp_asrc_track
+
+/**
+ * Asynchronous sample-rate converter. Ratio fs_out / fs_in can be changed at any time (e.g. to follow clock drift
+ * of a SIP trunk or a sound card). Output samples are interpolated with a Kaiser windowed sinc kernel, which is
+ * precomputed in a table (right half, HDSP_ASRC_TABLE_OVERSAMPLING points per sample) and linearly interpolated,
+ * so each output sample costs 2 * half_taps table lookups and multiply-adds, and no sin() calls.
+ */
+struct hdsp_asrc {
+    double table[HDSP_ASRC_TABLE_LEN + 1]; // table[j] = kernel(j / HDSP_ASRC_TABLE_OVERSAMPLING), last entry 0
+    double ratio_nominal; // fs_out / fs_in
+    double ratio; // current ratio, nominal ratio with drift correction
+    double step; // input samples per output sample, 1 / ratio
+    double scale; // kernel time scale, 1 for upsampling, < 1 to move cutoff to output Nyquist when downsampling
+    size_t half_taps;
+    double delay[2 * HDSP_ASRC_TAPS_MAX]; // delay line, each sample written twice
+    size_t delay_pos;
+    double t; // position of next output sample in the delay line (in input samples)
+    double drift_integral;
+};
+typedef struct hdsp_asrc hdsp_asrc_t;
+
 /**
  * Upsample by zero insertion.
  *      x - (in) input frame
@@ -121,14 +503,87 @@ hdsp_status_t hdsp_downsample_int16(int16_t *x, size_t x_len, int downsample_fac
 hdsp_status_t hdsp_downsample_double(double *x, size_t x_len, int downsample_factor, double *y, size_t y_len);
 hdsp_status_t hdsp_downsample_float(float *x, size_t x_len, int downsample_factor, float *y, size_t y_len);
 
+/**
+ * Upsample and downsample interleaved frames (sample t of channel c is x[t * n_channels + c]), as
+ * hdsp_upsample_int16 and hdsp_downsample_* do for each channel, without deinterleaving. Whole frames
+ * are moved, x_len and y_len are numbers of frames.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_upsample_int16_interleaved(int16_t *x, size_t n_channels, size_t x_len, int upsample_factor,
+                                              int16_t *y, size_t y_len);
+hdsp_status_t hdsp_downsample_int16_interleaved(int16_t *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                int16_t *y, size_t y_len);
+hdsp_status_t hdsp_downsample_double_interleaved(double *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                 double *y, size_t y_len);
+hdsp_status_t hdsp_downsample_float_interleaved(float *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                float *y, size_t y_len);
+
 /**
  * Cast buffer of x_len samples, from type of x to type of y. Buffers must be of same number of elements.
+ * Conversions are per sample, so interleaved frames are converted in place of layout, with x_len being
+ * the number of frames times the number of channels (same for the saturating conversions below).
+ * Conversions to float and double are exact, but of int32 and double to float, which round to nearest.
  */
 void hdsp_int16_2_float(int16_t *x, size_t x_len, float *y);
+void hdsp_int16_2_double(int16_t *x, size_t x_len, double *y);
+void hdsp_int32_2_float(int32_t *x, size_t x_len, float *y);
+void hdsp_int32_2_double(int32_t *x, size_t x_len, double *y);
+void hdsp_float_2_double(float *x, size_t x_len, double *y);
 void hdsp_double_2_int16(double *x, size_t x_len, int16_t *y);
 void hdsp_double_2_float(double *x, size_t x_len, float *y);
 void hdsp_float_2_int16(float *x, size_t x_len, int16_t *y);
 
+/**
+ * Seed dither generator. Same seed gives same noise.
+ */
+void hdsp_dither_init(hdsp_dither_t *dither, uint32_t seed);
+
+/**
+ * Convert buffer of x_len samples, from type of x to type of y, rounding to nearest (ties to even)
+ * and saturating to range of y's type (NaN gives 0). Casts above truncate toward zero and wrap
+ * on overflow instead. Vectorized with kernels of instruction set selected by hdsp_simd_set.
+ *      dither - (in/out) if not NULL, TPDF noise of +/-1 LSB is added to x before rounding, NULL for no dither
+ */
+void hdsp_double_2_int16_sat(double *x, size_t x_len, int16_t *y, hdsp_dither_t *dither);
+void hdsp_float_2_int16_sat(float *x, size_t x_len, int16_t *y, hdsp_dither_t *dither);
+void hdsp_double_2_int32_sat(double *x, size_t x_len, int32_t *y);
+void hdsp_float_2_int32_sat(float *x, size_t x_len, int32_t *y);
+
+/**
+ * Convert buffer of x_len int32 samples to int16, saturating to [INT16_MIN, INT16_MAX] (no scaling).
+ */
+void hdsp_int32_2_int16_sat(int32_t *x, size_t x_len, int16_t *y);
+
+/**
+ * View of len contiguous samples of type at data.
+ */
+hdsp_view_t hdsp_view(void *data, size_t len, hdsp_sample_type_t type);
+
+/**
+ * View of channel of len interleaved frames of n_channels samples at data.
+ */
+hdsp_view_t hdsp_view_channel(void *data, size_t n_channels, size_t len, size_t channel, hdsp_sample_type_t type);
+
+/**
+ * View of samples start, ..., start + len - 1 of view.
+ */
+hdsp_view_t hdsp_view_slice(hdsp_view_t view, size_t start, size_t len);
+
+/**
+ * View of every factor-th sample of view, starting with the first one: view.len / factor samples,
+ * as hdsp_downsample_* would write.
+ */
+hdsp_view_t hdsp_view_decimate(hdsp_view_t view, size_t factor);
+
+/**
+ * Convert x.len samples of x to y, between any sample types and strides, as by the saturating conversions
+ * above (rounding to nearest and saturating to integer types, dither is used for conversions to int16 and
+ * may be NULL). Contiguous double/float to int16/int32 views run the vector kernels directly,
+ * other views are gathered and scattered through HDSP_VIEW_BLOCK_LEN sample blocks on stack.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (y shorter than x).
+ */
+hdsp_status_t hdsp_convert_view(hdsp_view_t x, hdsp_view_t y, hdsp_dither_t *dither);
+
 /**
  * Compute full-length convolution of input signal x and filter h: x*h=Sum{x[tau]h[t-tau]}.
  * Result is of length x_len + h_len - 1, written to a vector pointed to by y (y must be allocated).
@@ -141,6 +596,122 @@ void hdsp_float_2_int16(float *x, size_t x_len, int16_t *y);
  */
 uint16_t hdsp_conv_full(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y);
 
+/**
+ * Select instruction set of SIMD kernels (used by hdsp_conv_full, hdsp_conv and hdsp_fir_filter). Kernels are selected once when library
+ * is loaded: instruction set forced at configure time (./configure --enable-simd=none|sse2|avx2|avx512|neon)
+ * or, by default, the best one supported by the CPU. Results of different instruction sets differ by rounding,
+ * forcing one keeps them reproducible. Not thread safe, shouldn't be called while filtering.
+ *      isa - (in) instruction set
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if isa isn't supported by the CPU (or build).
+ */
+hdsp_status_t hdsp_simd_set(hdsp_simd_t isa);
+
+/**
+ * Returns instruction set of SIMD kernels in use.
+ */
+hdsp_simd_t hdsp_simd_get(void);
+
+/**
+ * Compute full-length convolution of input signal x and filter h skipping zero taps of h.
+ * Only taps listed in h_nz_idx (ascending indices of non-zero taps, e.g. of hdsp_fir_filter_nz_idx) are multiplied,
+ * e.g. for Nyquist (third-band, half-band) filters every M-th tap is zero and is skipped.
+ * Result is the same as of hdsp_conv_full, parameters as in hdsp_conv_full, plus:
+ *      h_nz_idx - (in) indices of non-zero taps of h, ascending
+ *      h_nz_len - (in) number of elements in h_nz_idx
+ * Returns the number of elements written to y (x_len + h_len - 1 on success, 0 on error).
+ */
+uint16_t hdsp_conv_full_sparse(int16_t *x, uint16_t x_len, double *h, uint16_t h_len,
+                               uint16_t *h_nz_idx, uint16_t h_nz_len, double *y);
+
+/**
+ * Compute full-length convolution of input signal x and symmetric (linear phase) filter h,
+ * h[k] == h[h_len - 1 - k]. Input samples multiplied by the same coefficient are added first, so there are
+ * (h_len + 1) / 2 multiplies per output sample instead of h_len. Result is the same as of hdsp_conv_full
+ * (up to rounding), parameters as in hdsp_conv_full. h isn't checked for symmetry.
+ * Returns the number of elements written to y (x_len + h_len - 1 on success, 0 on error).
+ */
+uint16_t hdsp_conv_full_symmetric(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y);
+
+/**
+ * Returns the smallest FFT length not less than n, which is 2^a 3^b 5^c.
+ */
+size_t hdsp_fft_len_ceil(size_t n);
+
+/**
+ * Initializes FFT plan. Memory is allocated, call hdsp_fft_plan_deinit to release it.
+ *      plan - (out) plan
+ *      n - (in) transform length, 2^a 3^b 5^c for complex, 2 * 2^a 3^b 5^c for real transforms
+ *      type - (in) HDSP_FFT_TYPE_COMPLEX or HDSP_FFT_TYPE_REAL
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. unsupported length).
+ */
+hdsp_status_t hdsp_fft_plan_init(hdsp_fft_plan_t *plan, size_t n, hdsp_fft_type_t type);
+
+/**
+ * Returns the number of bytes of memory needed by hdsp_fft_plan_init_mem for plan of n points.
+ */
+size_t hdsp_fft_plan_mem_size(size_t n, hdsp_fft_type_t type);
+
+/**
+ * Initializes FFT plan as hdsp_fft_plan_init, with tables in caller's memory (nothing is allocated).
+ *      mem - (in) memory for tables, aligned for double, hdsp_fft_plan_mem_size(n, type) bytes at least,
+ *      must outlive the plan
+ *      mem_size - (in) size of mem in bytes
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. unsupported length, mem too small).
+ */
+hdsp_status_t hdsp_fft_plan_init_mem(hdsp_fft_plan_t *plan, size_t n, hdsp_fft_type_t type, void *mem, size_t mem_size);
+
+/**
+ * Release memory allocated by hdsp_fft_plan_init (memory given to hdsp_fft_plan_init_mem is not released).
+ */
+void hdsp_fft_plan_deinit(hdsp_fft_plan_t *plan);
+
+/**
+ * Forward complex FFT, X[k] = Sum{x[t]exp(-2*pi*i*k*t/n)}.
+ *      plan - (in) complex plan of n points
+ *      x - (in) n complex points, interleaved
+ *      y - (out) n complex points, interleaved, must not overlap x
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fft(const hdsp_fft_plan_t *plan, double *x, double *y);
+
+/**
+ * Inverse complex FFT, not scaled (hdsp_ifft of hdsp_fft of x is n * x). Parameters as in hdsp_fft.
+ */
+hdsp_status_t hdsp_ifft(const hdsp_fft_plan_t *plan, double *x, double *y);
+
+/**
+ * Forward FFT of real signal.
+ *      plan - (in) real plan of n points
+ *      x - (in) n real samples
+ *      y - (out) n/2 + 1 complex points (bins 0 to n/2), interleaved, must not overlap x
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fft_real(const hdsp_fft_plan_t *plan, double *x, double *y);
+
+/**
+ * Inverse FFT of spectrum of real signal, not scaled (hdsp_ifft_real of hdsp_fft_real of x is n * x).
+ *      plan - (in) real plan of n points
+ *      x - (in) n/2 + 1 complex points (bins 0 to n/2), interleaved
+ *      y - (out) n real samples, must not overlap x
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_ifft_real(const hdsp_fft_plan_t *plan, double *x, double *y);
+
+/**
+ * Compute full-length convolution of input signal x and filter h by FFT (overlap-add). Input is split
+ * into blocks, each block is convolved with h by multiplication of spectra, cost per output sample grows
+ * with log(h_len) rather than h_len. Result is the same as of hdsp_conv_full (up to rounding),
+ * parameters as in hdsp_conv_full.
+ * Returns the number of elements written to y (x_len + h_len - 1 on success, 0 on error).
+ */
+uint16_t hdsp_conv_full_fft(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y);
+
+/**
+ * Single precision hdsp_conv_full, input, filter and output in float.
+ * Returns the number of elements written to y (x_len + h_len - 1 on success, 0 on error).
+ */
+uint16_t hdsp_conv_full_float(float *x, uint16_t x_len, float *h, uint16_t h_len, float *y);
+
 /**
  * Compute convolution of input signal x and filter h: x*h=Sum{x[tau]h[t-tau]}.
  * Convolution types match those from MATLAB's conv function https://www.mathworks.com/help/fixedpoint/ref/conv.html
@@ -168,10 +739,44 @@ uint16_t hdsp_conv_full(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, d
  * Returns the number of elements written to y (x_len + h_len - 1) and indices pointing to first and one past the last
  * element of convolution result for a required convolution type. In case of 'valid' convolution type a result vector
  * may be empty, which is signalled by idx_start == -1 and idx_end == -1.
+ * Convolution is direct (hdsp_conv_full), so the result doesn't depend on filter length and nothing
+ * is allocated. Convolve long filters with hdsp_conv_full_fft, or filter frames with hdsp_fir_filter_ctx,
+ * which switches to FFT with a plan made once.
  */
 uint16_t hdsp_conv(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, hdsp_conv_type_t type,
                    double *y, int32_t *idx_start, int32_t *idx_end);
 
+/**
+ * Compute 'same' part of convolution of input signal x and filter h (HDSP_CONV_TYPE_SAME, see hdsp_conv):
+ * elements h_len/2, ..., h_len/2 + x_len - 1 of the full-length convolution, written to y[0], ..., y[x_len - 1].
+ * Unlike hdsp_conv, only these elements are computed, straight into y, without a temporary buffer
+ * (directly, as in hdsp_conv).
+ *      y - (out) output, must point to a valid memory of at least sizeof(double)*x_len bytes
+ * Returns the number of elements written to y (x_len on success, 0 on error).
+ */
+uint16_t hdsp_conv_same(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y);
+
+/**
+ * Compute 'valid' part of convolution of input signal x and filter h (HDSP_CONV_TYPE_VALID, see hdsp_conv):
+ * elements h_len - 1, ..., x_len - 1 of the full-length convolution, written to y[0], ..., y[x_len - h_len].
+ * Only these elements are computed, as in hdsp_conv_same.
+ *      y - (out) output, must point to a valid memory of at least sizeof(double)*(x_len - h_len + 1) bytes
+ * Returns the number of elements written to y (x_len - h_len + 1 on success, 0 on error or if x is shorter than h).
+ */
+uint16_t hdsp_conv_valid(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y);
+
+/**
+ * Convolution of strided view x (int16 samples) and h, result of given type ('full', 'same' or 'valid' part,
+ * as by hdsp_conv_full, hdsp_conv_same and hdsp_conv_valid) written to view y of any sample type
+ * (rounded and saturated to integer types). Contiguous x and contiguous double y are convolved in place as by
+ * the functions above, other views are convolved directly in blocks of
+ * HDSP_VIEW_BLOCK_LEN outputs, gathered and scattered on stack, for h_len up to HDSP_FIR_FILTER_LEN_MAX.
+ *      y_written - (out) number of samples written to y
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. y is too short).
+ */
+hdsp_status_t hdsp_conv_view(hdsp_view_t x, double *h, size_t h_len, hdsp_conv_type_t type, hdsp_view_t y,
+                             size_t *y_written);
+
 /**
  * Create N-point symmetric Hamming window.
  *      w - (out) result (must point to a valid memory of at least sizeof(double)*n bytes
@@ -230,10 +835,29 @@ hdsp_status_t hdsp_fir_filter_init_lowpass_by_ls(hdsp_filter_t *filter, size_t n
 /**
  * Initializes filter to Finite Impulse Response lowpass filter by a specified design method.
  * Impulse response isn't windowed, use Hamming or Kaiser window to shape filter.
+ * HDSP_FILTER_DESIGN_METHOD_REMEZ designs for the transition width, ripple and attenuation
+ * of hdsp_design_kaiser_n_beta defaults (HDSP_KAISER_FILTER_*).
  */
 hdsp_status_t hdsp_fir_filter_init_lowpass(hdsp_filter_t *filter, size_t n,
                                            uint16_t fs_hz, uint16_t passband_freq_hz,
                                            hdsp_filter_design_method_t method);
+/**
+ * Analyse filter taps: taps which aren't zero (or negligible, below HDSP_FIR_ZERO_TAP_EPSILON of the largest tap)
+ * are counted in b_nz_len (hdsp_fir_init skips them). Filter is checked for symmetry (to the same precision).
+ * Taps aren't modified, analysed is set. Called by all hdsp_fir_filter_init_* functions and hdsp_fir_filter_shape.
+ * Fields set are informative only: hdsp_fir_filter and hdsp_fir_view analyse taps as they are when called,
+ * so filter->b may be modified directly.
+ */
+hdsp_status_t hdsp_fir_filter_analyse(hdsp_filter_t *filter);
+
+/**
+ * Stores ascending indices of non-zero taps of filter (as counted by hdsp_fir_filter_analyse) in b_nz_idx,
+ * which must have room for b_len indices. Indices aren't kept in hdsp_filter_t (it would grow
+ * by HDSP_FIR_FILTER_LEN_MAX indices), hdsp_fir_init keeps them with the taps.
+ * Returns the number of indices stored.
+ */
+size_t hdsp_fir_filter_nz_idx(const hdsp_filter_t *filter, uint16_t *b_nz_idx);
+
 /**
  * Apply a window to a FIR filter.
  */
@@ -251,26 +875,862 @@ hdsp_status_t hdsp_fir_filter_shape(hdsp_filter_t *filter, double *w, uint16_t w
  */
 hdsp_status_t hdsp_fir_filter_init_lowpass_kaiser_opt(hdsp_filter_t *filter, uint16_t fs_hz, uint16_t passband_freq_hz);
 
+/**
+ * Initializes filter to n taps linear phase lowpass filter minimizing squared error in passband and stopband
+ * of spec (transition band is don't care), errors are weighted by inverse squared tolerances of spec.
+ * Works for any fs, passband and stopband, n may be odd or even (even n gives half sample delay).
+ * Filter is not guaranteed to meet the spec, see hdsp_fir_filter_design_lowpass.
+ */
+hdsp_status_t hdsp_fir_filter_init_lowpass_wls(hdsp_filter_t *filter, size_t n, const hdsp_lowpass_spec_t *spec);
+
+/**
+ * Initializes filter to n taps linear phase equiripple lowpass filter by Parks-McClellan (Remez exchange)
+ * algorithm, maximum passband and stopband errors are in ratio of tolerances of spec.
+ * Filter is not guaranteed to meet the spec, see hdsp_fir_filter_design_lowpass.
+ */
+hdsp_status_t hdsp_fir_filter_init_lowpass_remez(hdsp_filter_t *filter, size_t n, const hdsp_lowpass_spec_t *spec);
+
+/**
+ * Measures passband ripple (peak-to-peak, dB) and stopband attenuation (dB) of filter
+ * on the bands of spec.
+ */
+hdsp_status_t hdsp_fir_filter_lowpass_measure(const hdsp_filter_t *filter, const hdsp_lowpass_spec_t *spec,
+                                              double *passband_ripple_db, double *stopband_attenuation_db);
+
+/**
+ * Initializes filter to the shortest lowpass filter which meets spec (as measured by
+ * hdsp_fir_filter_lowpass_measure), designed by method:
+ *      HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING - Kaiser windowed sinc
+ *      HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES - hdsp_fir_filter_init_lowpass_wls
+ *      HDSP_FILTER_DESIGN_METHOD_REMEZ - hdsp_fir_filter_init_lowpass_remez
+ * Only odd lengths are searched, so the filter delays by integer (n - 1) / 2 samples (even lengths would
+ * give half sample delay). Search starts from Kaiser's (Herrmann's for optimal designs) length estimate,
+ * grows it until spec is met and bisects down. Fails if spec can't be met with HDSP_FIR_FILTER_LEN_MAX taps.
+ */
+hdsp_status_t hdsp_fir_filter_design_lowpass(hdsp_filter_t *filter, const hdsp_lowpass_spec_t *spec,
+                                             hdsp_filter_design_method_t method);
+
+/**
+ * Initializes filter to lowpass filter of design (hdsp_fir_filter_init_lowpass shaped by window).
+ */
+hdsp_status_t hdsp_fir_filter_init_design(hdsp_filter_t *filter, const hdsp_fir_design_t *design);
+
+/**
+ * Sets design to the filter of hdsp_fir_filter_init_lowpass_kaiser_opt (same fs and passband are supported).
+ */
+hdsp_status_t hdsp_fir_design_kaiser_opt(hdsp_fir_design_t *design, uint16_t fs_hz, uint16_t passband_freq_hz);
+
 /**
  * Zero-phase filter data x with FIR filter (compensates for a delay).
  * y must point to a vector of same number of elements as x (or more).
+ * Symmetry of taps is checked on each call (as by hdsp_fir_filter_analyse), for symmetric filters input samples
+ * multiplied by the same coefficient are added first (nearly halving the number of multiplies). Zero taps are
+ * skipped by compact filters only (hdsp_fir_init).
+ * Filtering is always direct: an FFT plan would be made and scratch allocated per call, use hdsp_fir_filter_ctx
+ * to convolve frames with long filters by FFT. If SIMD kernels are in use (see hdsp_simd_set), skipped and folded taps
+ * are applied one at a time to blocks of outputs with vector instructions (asymmetric filters without zero taps
+ * use vector dot products).
+ * Only the x_len outputs are computed, directly into y (direct convolution does no heap allocation).
  */
 hdsp_status_t hdsp_fir_filter(int16_t *x, size_t x_len, hdsp_filter_t *filter, double *y, size_t y_len);
 
-#define HDSP_FACTORIAL_MAX 40
-extern double hdsp_factorial[HDSP_FACTORIAL_MAX + 1];
+/**
+ * Initializes compact filter from taps b (copied to memory allocated at b_len taps, HDSP_FIR_ALIGN aligned),
+ * taps are analysed as by hdsp_fir_filter_analyse. Call hdsp_fir_deinit to release memory.
+ *      fir - (out) compact filter
+ *      b - (in) taps
+ *      b_len - (in) number of taps, up to HDSP_FIR_LEN_MAX
+ *      fs_hz - (in) sampling rate in Hz
+ *      passband_freq_hz - (in) passband frequency in Hz
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_init(hdsp_fir_t *fir, double *b, size_t b_len, uint16_t fs_hz, uint16_t passband_freq_hz);
 
 /**
- * Returns value of the modified Bessel function of the first kind for argument x, I_zero(x).
- * Value is approximated using series with k = 0 to HDSP_FACTORIAL_MAX.
- * https://mathworld.wolfram.com/ModifiedBesselFunctionoftheFirstKind.html
+ * Initializes compact filter from taps of filter (hdsp_fir_init), filter can be released afterwards.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
  */
-extern double hdsp_modified_bessel_1st_kind_zero(double x);
+hdsp_status_t hdsp_fir_init_from_filter(hdsp_fir_t *fir, hdsp_filter_t *filter);
 
-extern double hdsp_fir_ls_57_4000_48000[HDSP_FIR_LS_KAISER_57_4000_48000_LEN];
-extern double hdsp_fir_ls_kaiser_57_4000_48000[HDSP_FIR_LS_KAISER_57_4000_48000_LEN];
-extern double hdsp_fir_ls_75_8000_48000[HDSP_FIR_LS_KAISER_75_8000_48000_LEN];
-extern double hdsp_fir_ls_kaiser_75_8000_48000[HDSP_FIR_LS_KAISER_75_8000_48000_LEN];
+/**
+ * Returns compact filter handle viewing taps of filter (nothing is copied or allocated, no need to deinit).
+ * Symmetry is found from the taps when the view is made, so view must be made again after taps of filter
+ * are changed. Symmetric filters are folded, but zero taps of a view aren't skipped (their indices aren't
+ * stored in filter), use hdsp_fir_init to skip them.
+ */
+hdsp_fir_t hdsp_fir_view(hdsp_filter_t *filter);
+
+/**
+ * Release memory allocated by hdsp_fir_init (does nothing for a view).
+ */
+void hdsp_fir_deinit(hdsp_fir_t *fir);
+
+/**
+ * hdsp_fir_filter with compact filter: zero-phase filter data x, same kernels and same result as of
+ * hdsp_fir_filter with the filter fir was made from.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_compact(int16_t *x, size_t x_len, const hdsp_fir_t *fir, double *y, size_t y_len);
+
+/**
+ * Zero-phase filter strided view x (int16 samples) with fir, as hdsp_fir_filter_compact, output of x.len
+ * samples written to view y of any sample type (e.g. straight into a channel of interleaved int16 frames).
+ * Views are handled as by hdsp_conv_view.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_view(hdsp_view_t x, const hdsp_fir_t *fir, hdsp_view_t y);
+
+/**
+ * Zero-phase filter many channels (e.g. call legs) with the same filter in one call, planar layout:
+ * channel c is x[c][0], ..., x[c][x_len - 1], filtered to y[c][0], ..., y[c][x_len - 1], as by
+ * hdsp_fir_filter_compact. Kernel is selected once for all channels, for long filters FFT plan
+ * and spectrum of filter are computed once and shared by all channels.
+ *      x - (in) n_channels pointers to input frames
+ *      n_channels - (in) number of channels
+ *      x_len - (in) number of samples in each frame
+ *      fir - (in) filter
+ *      y - (out) n_channels pointers to outputs of y_len (at least x_len) elements
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_batch(int16_t **x, size_t n_channels, size_t x_len, const hdsp_fir_t *fir,
+                                    double **y, size_t y_len);
+
+/**
+ * Zero-phase filter many channels with the same filter in one call, interleaved layout: sample t
+ * of channel c is x[t * n_channels + c], output is y[t * n_channels + c]. Vectorized across channels:
+ * accumulators of a block of channels (e.g. 32 with AVX-512) stay in registers across all taps of an output
+ * frame, which is stored once. Each tap is broadcast and multiplied by the input samples of the block, mirrored
+ * taps of symmetric filters are folded (inputs added first) and zero taps are skipped. Frames at the edges,
+ * where some taps fall outside of input, add one tap at a time to the output row instead. Filtering is direct
+ * (no FFT). Result is the same as of hdsp_fir_filter_compact for each channel (up to rounding).
+ *      x - (in) x_len frames of n_channels samples
+ *      n_channels - (in) number of channels
+ *      x_len - (in) number of frames (samples per channel)
+ *      fir - (in) filter
+ *      y - (out) y_len (at least x_len) frames of n_channels elements
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_batch_interleaved(int16_t *x, size_t n_channels, size_t x_len, const hdsp_fir_t *fir,
+                                                double *y, size_t y_len);
+
+/**
+ * Returns the number of bytes of workspace for hdsp_fir_ctx_init (0 if none is needed, e.g. short filters).
+ *      frame_len_max - (in) maximum number of samples in a frame
+ *      b_len_max - (in) maximum filter length
+ */
+size_t hdsp_fir_ctx_workspace_size(size_t frame_len_max, size_t b_len_max);
+
+/**
+ * Initializes FIR filtering context.
+ *      ctx - (out) context
+ *      frame_len_max - (in) maximum number of samples in a frame
+ *      b_len_max - (in) maximum filter length (up to HDSP_FIR_FILTER_LEN_MAX, HDSP_FIR_LEN_MAX for hdsp_fir_t)
+ *      workspace - (in) memory of hdsp_fir_ctx_workspace_size(frame_len_max, b_len_max) bytes at least,
+ *      aligned for double, owned by the caller and used until hdsp_fir_ctx_deinit, or NULL to allocate it
+ *      workspace_size - (in) size of workspace in bytes
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. workspace too small).
+ */
+hdsp_status_t hdsp_fir_ctx_init(hdsp_fir_ctx_t *ctx, size_t frame_len_max, size_t b_len_max,
+                                void *workspace, size_t workspace_size);
+
+/**
+ * Release context (workspace is freed only if allocated by hdsp_fir_ctx_init).
+ */
+void hdsp_fir_ctx_deinit(hdsp_fir_ctx_t *ctx);
+
+/**
+ * Sets filter used by context (spectrum of long filters is computed once here), filter can be replaced
+ * with another one of up to b_len_max taps at any time between frames.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_ctx_set_filter(hdsp_fir_ctx_t *ctx, hdsp_filter_t *filter);
+
+/**
+ * Sets filter used by context to compact filter fir, as hdsp_fir_ctx_set_filter (taps are not copied).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_ctx_set_fir(hdsp_fir_ctx_t *ctx, const hdsp_fir_t *fir);
+
+/**
+ * hdsp_fir_filter with context: zero-phase filter frame x of up to frame_len_max samples with the filter
+ * of context, same kernels and result as of hdsp_fir_filter (up to rounding), no memory is allocated.
+ * If the filter needs hdsp_conv_fft_taps_min or more multiplies per sample (after skipping and folding taps,
+ * HDSP_CONV_FFT_TAPS_MIN for scalar code, more for SIMD kernels) and the frame is at least that long,
+ * frame is convolved by FFT with plan and spectrum of filter of the context.
+ * Context is modified (FFT blocks), so it can't be used by many threads at a time.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_ctx(hdsp_fir_ctx_t *ctx, int16_t *x, size_t x_len, double *y, size_t y_len);
+
+/**
+ * Initializes single precision filter from filter (designed in double precision), taps are rounded to float.
+ *      filter_float - (out) single precision filter
+ *      filter - (in) filter
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_filter_float_init(hdsp_filter_float_t *filter_float, hdsp_filter_t *filter);
+
+/**
+ * Single precision hdsp_fir_filter: zero-phase filter data x, y must point to a vector of same number
+ * of elements as x (or more). Only requested outputs are computed (no temporary buffer), always directly
+ * (there is no FFT path), with SIMD kernel if available.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_float(float *x, size_t x_len, hdsp_filter_float_t *filter, float *y, size_t y_len);
+
+/**
+ * Initializes fixed-point filter from filter (designed in double precision), taps are quantized
+ * to 16 bits with block scaling (see hdsp_filter_q15_t).
+ *      filter_q15 - (out) fixed-point filter
+ *      filter - (in) filter
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. all taps are zero).
+ */
+hdsp_status_t hdsp_filter_q15_init(hdsp_filter_q15_t *filter_q15, hdsp_filter_t *filter);
+
+/**
+ * Full-length convolution of x with fixed-point filter, products are accumulated in int32,
+ * result is rounded, scaled back by 2^-shift and saturated to int16.
+ * Returns the number of elements written to y (x_len + b_len - 1 on success, 0 on error).
+ */
+uint16_t hdsp_conv_full_q15(int16_t *x, uint16_t x_len, hdsp_filter_q15_t *filter, int16_t *y);
+
+/**
+ * Fixed-point hdsp_fir_filter: zero-phase filter data x, input and output in int16, output is saturated.
+ * y must point to a vector of same number of elements as x (or more). Only requested outputs are computed,
+ * with integer multiply-add SIMD kernel if available (results are the same for all instruction sets).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_q15(int16_t *x, size_t x_len, hdsp_filter_q15_t *filter, int16_t *y, size_t y_len);
+
+/**
+ * Signal to noise ratio of fixed-point filtering of x, with the output of hdsp_fir_filter (double precision)
+ * as reference: 10log10(Sum{y_ref^2}/Sum{(y_q15 - y_ref)^2}). Noise includes quantization of taps and output
+ * and saturation. Memory for both outputs is allocated.
+ *      filter_q15 - (in) fixed-point filter
+ *      filter - (in) filter filter_q15 was initialized from
+ *      x - (in) test signal
+ *      x_len - (in) test signal length in samples
+ *      snr_db - (out) signal to noise ratio in dB (INFINITY if outputs are equal)
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_q15_snr(hdsp_filter_q15_t *filter_q15, hdsp_filter_t *filter, int16_t *x, size_t x_len,
+                                      double *snr_db);
+
+/**
+ * Initializes polyphase interpolator from a FIR filter designed at the output (upsampled) sampling rate,
+ * e.g. with hdsp_fir_filter_init_lowpass_kaiser_opt(filter, 48000, 4000) for 8 kHz -> 48 kHz.
+ *      interp - (out) interpolator
+ *      filter - (in) lowpass filter, its taps are copied (filter may be reused or released afterwards)
+ *      upsample_factor - (in) upsampling factor L, 1 to HDSP_INTERP_FACTOR_MAX
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_interp_init(hdsp_interp_t *interp, hdsp_filter_t *filter, int upsample_factor);
+
+/**
+ * Upsample and zero-phase filter data x in one pass. Equivalent to hdsp_upsample_int16 followed
+ * by hdsp_fir_filter with the filter interp was initialized from, but inserted zeros are never
+ * multiplied: each output sample is computed by one sub-filter, i.e. b_len / L multiply-adds per output
+ * instead of b_len. Products skipped are those with zero samples, so the output matches the
+ * upsample + hdsp_fir_filter chain to within HDSP_DOUBLE_ALMOST_EPSILON.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples
+ *      interp - (in) interpolator
+ *      y - (out) upsampled and filtered frame, memory should be pre-allocated
+ *      y_len - (in) y's length in samples, should be x_len * upsample_factor
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_interpolate(int16_t *x, size_t x_len, hdsp_interp_t *interp, double *y, size_t y_len);
+
+/**
+ * Single precision hdsp_interp_init.
+ */
+hdsp_status_t hdsp_interp_float_init(hdsp_interp_float_t *interp, hdsp_filter_float_t *filter, int upsample_factor);
+
+/**
+ * Single precision hdsp_interpolate, input and output in float.
+ */
+hdsp_status_t hdsp_interpolate_float(float *x, size_t x_len, hdsp_interp_float_t *interp, float *y, size_t y_len);
+
+/**
+ * Initializes decimating FIR filter from anti-aliasing lowpass filter designed at the input sampling rate,
+ * e.g. with hdsp_fir_filter_init_lowpass_kaiser_opt(filter, 48000, 4000) for 48 kHz -> 8 kHz.
+ * Filter state (history) is cleared.
+ *      decim - (out) decimator
+ *      filter - (in) lowpass filter, its taps are copied
+ *      downsample_factor - (in) downsampling factor M
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_decim_init(hdsp_decim_t *decim, hdsp_filter_t *filter, int downsample_factor);
+
+/**
+ * Filter and downsample data x. Convolution is evaluated only for retained samples x[0], x[M], x[2M], ...
+ * (same samples as kept by hdsp_downsample_int16), i.e. b_len multiply-adds per output sample
+ * instead of M * b_len. Last b_len - 1 input samples are kept in decim, so frames of a stream can be
+ * passed one by one and result is the same as if whole stream was processed at once.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples, must be a multiple of downsample_factor
+ *      decim - (in/out) decimator
+ *      y - (out) filtered and downsampled frame, memory should be pre-allocated
+ *      y_len - (in) y's length in samples, should be x_len / downsample_factor
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_decimate(int16_t *x, size_t x_len, hdsp_decim_t *decim, double *y, size_t y_len);
+
+/**
+ * Single precision hdsp_decim_init.
+ */
+hdsp_status_t hdsp_decim_float_init(hdsp_decim_float_t *decim, hdsp_filter_float_t *filter, int downsample_factor);
+
+/**
+ * Single precision hdsp_decimate, input and output in float.
+ */
+hdsp_status_t hdsp_decimate_float(float *x, size_t x_len, hdsp_decim_float_t *decim, float *y, size_t y_len);
+
+/**
+ * Initializes streaming FIR filter. Filter state (history) is cleared, as if stream was preceded by silence.
+ *      stream - (out) streaming filter
+ *      filter - (in) FIR filter, its taps are copied
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_stream_init(hdsp_fir_stream_t *stream, hdsp_filter_t *filter);
+
+/**
+ * Returns group delay of the streaming filter in samples, (b_len - 1) / 2 (for a linear phase filter).
+ * Sample x[n] of the stream shows in the output at y[n + delay].
+ */
+double hdsp_fir_stream_delay(hdsp_fir_stream_t *stream);
+
+/**
+ * Filter data x with streaming FIR filter, exactly one output sample is produced for each input sample.
+ * Unlike hdsp_fir_filter, which zero-pads each frame at both ends, filter state is carried over from frame
+ * to frame, so the output of a stream processed frame by frame is the same as if whole stream was filtered
+ * at once (there are no transients at frame boundaries). Output is delayed by hdsp_fir_stream_delay samples.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples (frames may be of different lengths)
+ *      stream - (in/out) streaming filter
+ *      y - (out) filtered frame, must point to a vector of same number of elements as x (or more)
+ *      y_len - (in) y's length
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_stream(int16_t *x, size_t x_len, hdsp_fir_stream_t *stream, double *y, size_t y_len);
+
+/**
+ * Initializes streaming FIR filter convolving by FFT (overlap-save). Filter state (history) is cleared.
+ * Memory is allocated, call hdsp_fir_fft_stream_deinit to release it.
+ *      stream - (out) streaming filter
+ *      filter - (in) FIR filter, its spectrum is computed
+ *      frame_len - (in) block length, number of samples filtered with one FFT (typically frame length);
+ *      longer frames are split into blocks
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_fft_stream_init(hdsp_fir_fft_stream_t *stream, hdsp_filter_t *filter, size_t frame_len);
+
+/**
+ * Release memory allocated by hdsp_fir_fft_stream_init.
+ */
+void hdsp_fir_fft_stream_deinit(hdsp_fir_fft_stream_t *stream);
+
+/**
+ * Returns group delay of the streaming filter in samples, (b_len - 1) / 2 (for a linear phase filter).
+ */
+double hdsp_fir_fft_stream_delay(hdsp_fir_fft_stream_t *stream);
+
+/**
+ * Filter data x with streaming FIR filter convolving by FFT. Same as hdsp_fir_filter_stream (up to rounding),
+ * exactly one output sample is produced for each input sample, frames may be of different lengths.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples
+ *      stream - (in/out) streaming filter
+ *      y - (out) filtered frame, must point to a vector of same number of elements as x (or more)
+ *      y_len - (in) y's length
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_fft_stream(int16_t *x, size_t x_len, hdsp_fir_fft_stream_t *stream,
+                                         double *y, size_t y_len);
+
+/**
+ * Initializes streaming FIR filter convolving by FFT with uniformly partitioned filter. Filter state
+ * (frequency-domain delay line) is cleared. Memory is allocated, call hdsp_fir_part_stream_deinit to release it.
+ *      stream - (out) streaming filter
+ *      filter - (in) FIR filter, spectra of its partitions are computed
+ *      block_len - (in) block length, 2^a 3^b 5^c, e.g. 48 or 480 samples (1 ms or 10 ms at 48 kHz),
+ *      frames must be multiples of it
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_part_stream_init(hdsp_fir_part_stream_t *stream, hdsp_filter_t *filter, size_t block_len);
+
+/**
+ * Release memory allocated by hdsp_fir_part_stream_init.
+ */
+void hdsp_fir_part_stream_deinit(hdsp_fir_part_stream_t *stream);
+
+/**
+ * Returns group delay of the streaming filter in samples, (b_len - 1) / 2 (for a linear phase filter).
+ */
+double hdsp_fir_part_stream_delay(hdsp_fir_part_stream_t *stream);
+
+/**
+ * Filter data x with uniformly partitioned streaming FIR filter. Same as hdsp_fir_filter_stream
+ * (up to rounding), exactly one output sample is produced for each input sample.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples, must be a multiple of block_len
+ *      stream - (in/out) streaming filter
+ *      y - (out) filtered frame, must point to a vector of same number of elements as x (or more)
+ *      y_len - (in) y's length
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_fir_filter_part_stream(int16_t *x, size_t x_len, hdsp_fir_part_stream_t *stream,
+                                          double *y, size_t y_len);
+
+/**
+ * Initializes rational resampler converting from fs_in_hz to fs_out_hz (any ratio, e.g. 44100 -> 48000
+ * is resampled with L/M = 160/147). Prototype filter is a Kaiser windowed sinc designed to meet
+ * HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB and HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB with passband
+ * edge at HDSP_RESAMPLER_PASSBAND of the lower Nyquist frequency and stopband edge at the lower Nyquist frequency.
+ * Memory for filter bank and state is allocated, release it with hdsp_resampler_deinit.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. filter would be longer
+ * than HDSP_RESAMPLER_TAPS_MAX).
+ */
+hdsp_status_t hdsp_resampler_init(hdsp_resampler_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz);
+
+/**
+ * Releases memory allocated by hdsp_resampler_init.
+ */
+void hdsp_resampler_deinit(hdsp_resampler_t *resampler);
+
+/**
+ * Returns the number of output samples next call to hdsp_resample with x_len input samples will produce.
+ * For ratios which don't divide the frame length it varies from frame to frame (by one sample).
+ */
+size_t hdsp_resampler_output_len(hdsp_resampler_t *resampler, size_t x_len);
+
+/**
+ * Returns delay of the output in relation to the input, in output samples.
+ */
+double hdsp_resampler_delay(hdsp_resampler_t *resampler);
+
+/**
+ * Resample data x. Filter state is kept in resampler, so frames of a stream can be passed one by one
+ * and the result is the same as if whole stream was processed at once.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples
+ *      resampler - (in/out) resampler
+ *      y - (out) resampled frame, memory should be pre-allocated
+ *      y_len - (in) y's length in samples, must be at least hdsp_resampler_output_len(resampler, x_len)
+ *      y_written - (out) number of samples written to y
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_resample(int16_t *x, size_t x_len, hdsp_resampler_t *resampler, double *y, size_t y_len,
+                            size_t *y_written);
+hdsp_status_t hdsp_resample_double(double *x, size_t x_len, hdsp_resampler_t *resampler, double *y, size_t y_len,
+                                   size_t *y_written);
+
+/**
+ * Initializes resampler as hdsp_resampler_init, for n_channels interleaved channels resampled
+ * by hdsp_resample_interleaved. Channels share the filter bank, the delay line holds whole frames,
+ * so each output frame is a single pass over the taps with all channels in vector lanes.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_resampler_init_interleaved(hdsp_resampler_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz,
+                                              size_t n_channels);
+
+/**
+ * Resample interleaved frames x (sample t of channel c is x[t * n_channels + c]) to interleaved frames y,
+ * each channel as by hdsp_resample (up to rounding). x_len, y_len and y_written count frames,
+ * hdsp_resampler_output_len gives the number of output frames.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_resample_interleaved(int16_t *x, size_t x_len, hdsp_resampler_t *resampler, double *y,
+                                        size_t y_len, size_t *y_written);
+
+/**
+ * Initializes single precision rational resampler, filter is designed as by hdsp_resampler_init and rounded
+ * to float. Memory is allocated, release it with hdsp_resampler_float_deinit.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_resampler_float_init(hdsp_resampler_float_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz);
+
+/**
+ * Releases memory allocated by hdsp_resampler_float_init.
+ */
+void hdsp_resampler_float_deinit(hdsp_resampler_float_t *resampler);
+
+/**
+ * Single precision hdsp_resampler_output_len.
+ */
+size_t hdsp_resampler_float_output_len(hdsp_resampler_float_t *resampler, size_t x_len);
+
+/**
+ * Single precision hdsp_resampler_delay.
+ */
+double hdsp_resampler_float_delay(hdsp_resampler_float_t *resampler);
+
+/**
+ * Single precision hdsp_resample, input and output in float.
+ */
+hdsp_status_t hdsp_resample_float(float *x, size_t x_len, hdsp_resampler_float_t *resampler, float *y, size_t y_len,
+                                  size_t *y_written);
+
+#define HDSP_FACTORIAL_MAX 40
+extern double hdsp_factorial[HDSP_FACTORIAL_MAX + 1];
+
+/**
+ * Returns value of the modified Bessel function of the first kind for argument x, I_zero(x).
+ * Value is approximated using series with k = 0 to HDSP_FACTORIAL_MAX.
+ * https://mathworld.wolfram.com/ModifiedBesselFunctionoftheFirstKind.html
+ */
+extern double hdsp_modified_bessel_1st_kind_zero(double x);
+
+extern double hdsp_fir_ls_57_4000_48000[HDSP_FIR_LS_KAISER_57_4000_48000_LEN];
+extern double hdsp_fir_ls_kaiser_57_4000_48000[HDSP_FIR_LS_KAISER_57_4000_48000_LEN];
+extern double hdsp_fir_ls_75_8000_48000[HDSP_FIR_LS_KAISER_75_8000_48000_LEN];
+extern double hdsp_fir_ls_kaiser_75_8000_48000[HDSP_FIR_LS_KAISER_75_8000_48000_LEN];
+
+/**
+ * Plan multistage resampling fs_in_hz -> fs_out_hz, ratio must be an integer (upsampling or downsampling).
+ * All ordered factorizations of the ratio into at most HDSP_MULTISTAGE_STAGES_MAX stages are evaluated,
+ * for each stage a Kaiser filter is designed (filter length estimated), and plan with the lowest number
+ * of multiply-adds per output sample is chosen.
+ *      fs_in_hz - (in) input sampling rate
+ *      fs_out_hz - (in) output sampling rate
+ *      factors - (out) factors of the stages, in order of processing (may be NULL), space for
+ *      HDSP_MULTISTAGE_STAGES_MAX elements
+ *      n_stages - (out) number of stages (may be NULL)
+ * Returns multiply-adds per output sample of the plan, or 0 on error (ratio isn't an integer or is 1).
+ */
+double hdsp_multistage_plan(uint32_t fs_in_hz, uint32_t fs_out_hz, int *factors, int *n_stages);
+
+/**
+ * Returns multiply-adds per output sample of a given plan (e.g. factors = {6}, n_stages = 1 for a single stage
+ * 48000 -> 8000), or 0 if plan is invalid.
+ */
+double hdsp_multistage_cost(uint32_t fs_in_hz, uint32_t fs_out_hz, int *factors, int n_stages);
+
+/**
+ * Initializes multistage resampler with plan from hdsp_multistage_plan.
+ *      max_frame_len - (in) maximum number of input samples passed to a single hdsp_multistage_resample call
+ * Memory is allocated, release it with hdsp_multistage_deinit.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_multistage_init(hdsp_multistage_t *ms, uint32_t fs_in_hz, uint32_t fs_out_hz, size_t max_frame_len);
+
+/**
+ * Releases memory allocated by hdsp_multistage_init.
+ */
+void hdsp_multistage_deinit(hdsp_multistage_t *ms);
+
+/**
+ * Returns the number of output samples next call to hdsp_multistage_resample with x_len input samples will produce.
+ */
+size_t hdsp_multistage_output_len(hdsp_multistage_t *ms, size_t x_len);
+
+/**
+ * Returns delay of the output in relation to the input, in output samples.
+ */
+double hdsp_multistage_delay(hdsp_multistage_t *ms);
+
+/**
+ * Resample data x through all stages. State is kept in ms, frames of a stream can be passed one by one.
+ * Parameters as in hdsp_resample, x_len must not exceed max_frame_len.
+ */
+hdsp_status_t hdsp_multistage_resample(int16_t *x, size_t x_len, hdsp_multistage_t *ms, double *y, size_t y_len,
+                                       size_t *y_written);
+
+/**
+ * Initializes asynchronous sample-rate converter, with ratio fs_out_hz / fs_in_hz.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_asrc_init(hdsp_asrc_t *asrc, uint32_t fs_in_hz, uint32_t fs_out_hz);
+
+/**
+ * Set ratio (fs_out / fs_in) used from next output sample on. Small changes (e.g. tens of ppm) are inaudible
+ * and may be applied every frame. Kernel cutoff is fixed at init, so ratio should stay close to the nominal one.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_asrc_set_ratio(hdsp_asrc_t *asrc, double ratio);
+
+/**
+ * Returns current ratio.
+ */
+double hdsp_asrc_get_ratio(hdsp_asrc_t *asrc);
+
+/**
+ * Clock-drift tracking. Adjusts ratio with a PI controller to keep the fill level of the buffer fed with
+ * the converter's output at the target level. Call once per frame.
+ *      fill - (in) current buffer fill level in samples (at output rate)
+ *      target - (in) desired fill level in samples
+ *      fs_out_hz - (in) output sampling rate
+ * Correction is limited to +/- HDSP_ASRC_DRIFT_PPM_MAX ppm of the nominal ratio.
+ * Returns current correction in ppm.
+ */
+double hdsp_asrc_track(hdsp_asrc_t *asrc, double fill, double target, uint32_t fs_out_hz);
+
+/**
+ * Returns the number of output samples next call to hdsp_asrc_process with x_len input samples will produce
+ * (with current ratio).
+ */
+size_t hdsp_asrc_output_len(hdsp_asrc_t *asrc, size_t x_len);
+
+/**
+ * Returns delay of the output in relation to the input, in output samples (at current ratio).
+ */
+double hdsp_asrc_delay(hdsp_asrc_t *asrc);
+
+/**
+ * Convert data x. State is kept in asrc, frames of a stream may be passed one by one.
+ *      x - (in) input frame
+ *      x_len - (in) input frame length in samples
+ *      asrc - (in/out) converter
+ *      y - (out) output frame, memory should be pre-allocated
+ *      y_len - (in) y's length in samples, must be at least hdsp_asrc_output_len(asrc, x_len)
+ *      y_written - (out) number of samples written to y
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+hdsp_status_t hdsp_asrc_process(int16_t *x, size_t x_len, hdsp_asrc_t *asrc, double *y, size_t y_len,
+                                size_t *y_written);
+
+/* Scheduler */
+
+#if HDSP_HAVE_SCHED
+
+/**
+ * Scheduler of per-frame DSP jobs of many streams (e.g. call legs) on a pool of worker threads.
+ * Jobs of a stream run in order of submission, one at a time (so a stream's state, e.g. resampler
+ * or FIR history, needs no locking), jobs of different streams run in parallel. Each worker has
+ * a deque of streams with pending jobs, takes work from its own deque and steals from others when idle.
+ * Scheduler is optional (built with POSIX threads, declared if HDSP_HAVE_SCHED of hdsp_config.h is set),
+ * nothing else in the library uses it.
+ */
+typedef struct hdsp_sched hdsp_sched_t;
+typedef struct hdsp_sched_stream hdsp_sched_stream_t;
+
+/**
+ * Job (or completion callback) of the scheduler, called on a worker thread with arg given to hdsp_sched_submit.
+ */
+typedef void (*hdsp_sched_fn_t)(void *arg);
+
+/**
+ * Creates scheduler and starts its worker threads.
+ *      n_threads - (in) number of worker threads, 0 for one per online CPU
+ * Returns scheduler, or NULL on error.
+ */
+hdsp_sched_t *hdsp_sched_create(size_t n_threads);
+
+/**
+ * Waits for all submitted jobs to complete, stops worker threads and releases scheduler.
+ * All streams must be destroyed before.
+ */
+void hdsp_sched_destroy(hdsp_sched_t *sched);
+
+/**
+ * Returns the number of worker threads.
+ */
+size_t hdsp_sched_threads(hdsp_sched_t *sched);
+
+/**
+ * Creates stream of jobs. Memory used to schedule the stream is allocated here, not on submit.
+ *      sched - (in) scheduler
+ *      queue_len - (in) maximum number of jobs pending in the stream (submitted, not completed)
+ * Returns stream, or NULL on error.
+ */
+hdsp_sched_stream_t *hdsp_sched_stream_create(hdsp_sched_t *sched, size_t queue_len);
+
+/**
+ * Waits for pending jobs of stream to complete and releases it.
+ */
+void hdsp_sched_stream_destroy(hdsp_sched_stream_t *stream);
+
+/**
+ * Submits job to stream: run(arg) is called after all jobs submitted to stream before, then done(arg)
+ * (completion callback, may be NULL), on a worker thread. Nothing is allocated, may be called from any thread
+ * (but jobs of a stream are ordered as submitted only if submitted by one thread at a time).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error (e.g. queue_len jobs already pending).
+ */
+hdsp_status_t hdsp_sched_submit(hdsp_sched_stream_t *stream, hdsp_sched_fn_t run, hdsp_sched_fn_t done, void *arg);
+
+/**
+ * Waits until all jobs submitted to scheduler (by now) are completed.
+ */
+void hdsp_sched_wait(hdsp_sched_t *sched);
+
+/**
+ * FIR filtering job, run by hdsp_sched_run_fir: hdsp_fir_filter_compact(x, x_len, fir, y, y_len).
+ */
+struct hdsp_sched_fir_job {
+    int16_t *x;
+    size_t x_len;
+    const hdsp_fir_t *fir;
+    double *y;
+    size_t y_len;
+    hdsp_status_t status; // (out) result
+};
+typedef struct hdsp_sched_fir_job hdsp_sched_fir_job_t;
+
+/**
+ * Runs FIR filtering job, arg is hdsp_sched_fir_job_t (pass as run to hdsp_sched_submit).
+ */
+void hdsp_sched_run_fir(void *arg);
+
+/**
+ * Resampling job, run by hdsp_sched_run_resample: hdsp_resample(x, x_len, resampler, y, y_len, &y_written).
+ * Resampler keeps state between frames, so all frames of a resampler should be submitted to the same stream.
+ */
+struct hdsp_sched_resample_job {
+    int16_t *x;
+    size_t x_len;
+    hdsp_resampler_t *resampler;
+    double *y;
+    size_t y_len;
+    size_t y_written; // (out) number of samples written to y
+    hdsp_status_t status; // (out) result
+};
+typedef struct hdsp_sched_resample_job hdsp_sched_resample_job_t;
+
+/**
+ * Runs resampling job, arg is hdsp_sched_resample_job_t (pass as run to hdsp_sched_submit).
+ */
+void hdsp_sched_run_resample(void *arg);
+
+#endif // HDSP_HAVE_SCHED
+
+/* Frame rings */
+
+#define HDSP_RING_ALIGN 64 // alignment and padding of ring indices and frame slots in bytes (cache line)
+
+/**
+ * Ring type: single producer or many producers (threads), single consumer.
+ */
+enum hdsp_ring_type {
+    HDSP_RING_SPSC,
+    HDSP_RING_MPSC
+};
+typedef enum hdsp_ring_type hdsp_ring_type_t;
+
+/**
+ * Lock-free ring of fixed-size frames (e.g. 20 ms of samples), for handing frames between threads
+ * (e.g. network receive thread and DSP workers). Producer reserves a frame slot, writes (e.g. decodes)
+ * straight into it and commits it, consumer peeks at the oldest committed frame, processes it in place
+ * and releases it, so frames are never copied. Indices of producer and consumer are on separate
+ * cache lines, frame slots are cache line aligned.
+ */
+typedef struct hdsp_ring hdsp_ring_t;
+
+/**
+ * Creates ring.
+ *      n_frames - (in) capacity in frames (rounded up to a power of 2)
+ *      frame_size - (in) maximum size of a frame in bytes
+ *      type - (in) HDSP_RING_SPSC or HDSP_RING_MPSC
+ * Returns ring, or NULL on error.
+ */
+hdsp_ring_t *hdsp_ring_create(size_t n_frames, size_t frame_size, hdsp_ring_type_t type);
+
+/**
+ * Releases ring (no producer or consumer may use it anymore).
+ */
+void hdsp_ring_destroy(hdsp_ring_t *ring);
+
+/**
+ * Returns capacity of ring in frames.
+ */
+size_t hdsp_ring_capacity(hdsp_ring_t *ring);
+
+/**
+ * Producer: reserves the next frame slot (frame_size bytes, HDSP_RING_ALIGN aligned) to be written
+ * and committed with hdsp_ring_commit. With HDSP_RING_SPSC the producer may hold one reservation at a time,
+ * with HDSP_RING_MPSC each producer may hold one (frames are consumed in order of reservation).
+ * Returns pointer to frame slot, or NULL if ring is full.
+ */
+void *hdsp_ring_reserve(hdsp_ring_t *ring);
+
+/**
+ * Producer: commits frame reserved by hdsp_ring_reserve, making it visible to consumer.
+ * Lengths of frames are in bytes in all hdsp_ring_* calls.
+ *      frame - (in) pointer returned by hdsp_ring_reserve
+ *      len - (in) length of frame in bytes written to the slot (up to frame_size), returned by hdsp_ring_peek
+ */
+void hdsp_ring_commit(hdsp_ring_t *ring, void *frame, size_t len);
+
+/**
+ * Consumer: returns pointer to the oldest committed frame (which stays in ring until hdsp_ring_release),
+ * or NULL if there is none.
+ *      len - (out) length of frame in bytes, as given to hdsp_ring_commit (may be NULL)
+ */
+void *hdsp_ring_peek(hdsp_ring_t *ring, size_t *len);
+
+/**
+ * Consumer: releases frame returned by hdsp_ring_peek, its slot can be reserved again.
+ */
+void hdsp_ring_release(hdsp_ring_t *ring);
+
+/**
+ * Producer: copies frame of len bytes (up to frame_size) to ring (reserve, copy, commit with len).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if ring is full or frame too long.
+ */
+hdsp_status_t hdsp_ring_push(hdsp_ring_t *ring, const void *frame, size_t len);
+
+/**
+ * Consumer: copies the oldest frame out of ring (peek, copy len bytes, release).
+ *      frame - (out) memory of frame_size bytes
+ *      len - (out) length of frame in bytes, as given to hdsp_ring_push or hdsp_ring_commit (may be NULL)
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if ring is empty.
+ */
+hdsp_status_t hdsp_ring_pop(hdsp_ring_t *ring, void *frame, size_t *len);
+
+/* Filter cache */
+
+#if HDSP_HAVE_FIR_CACHE
+
+#define HDSP_FIR_CACHE_BUCKETS 256 // hash buckets of hdsp_fir_cache_t (power of 2)
+#define HDSP_FIR_CACHE_CAPACITY_DEFAULT 64 // designs kept by the process-wide cache
+
+/**
+ * Reference counted cache of designed filters, so that streams (e.g. call legs) using the same design
+ * share one immutable copy of taps instead of designing (and keeping) their own.
+ * Lookup of a cached design is lock-free and writes nothing shared by other designs (but for designs
+ * hashed to the same bucket), designing a new one and eviction are serialized by a mutex.
+ * When the cache is full, the least recently used designs which aren't referenced are evicted (recency
+ * is tracked to the granularity of insertions of new designs).
+ */
+typedef struct hdsp_fir_cache hdsp_fir_cache_t;
+
+/**
+ * Creates cache.
+ *      capacity - (in) number of designs kept (more are kept while referenced)
+ * Returns cache, or NULL on error.
+ */
+hdsp_fir_cache_t *hdsp_fir_cache_create(size_t capacity);
+
+/**
+ * Releases cache and its filters, no filter of the cache may be referenced anymore.
+ */
+void hdsp_fir_cache_destroy(hdsp_fir_cache_t *cache);
+
+/**
+ * Returns filter of design, designed (hdsp_fir_filter_init_design) on first use, with its reference count
+ * incremented. Filter is shared and must not be modified, release it with hdsp_fir_cache_put.
+ *      cache - (in) cache, or NULL for the process-wide cache (HDSP_FIR_CACHE_CAPACITY_DEFAULT designs)
+ * Returns filter, or NULL on error (invalid design or out of memory).
+ */
+const hdsp_fir_t *hdsp_fir_cache_get(hdsp_fir_cache_t *cache, const hdsp_fir_design_t *design);
+
+/**
+ * Releases reference to filter returned by hdsp_fir_cache_get from the same cache (lock-free, evicted designs
+ * left for readers are freed here if the cache's mutex is free).
+ */
+void hdsp_fir_cache_put(hdsp_fir_cache_t *cache, const hdsp_fir_t *fir);
+
+/**
+ * Evicts all designs which aren't referenced.
+ * Returns number of evicted designs.
+ */
+size_t hdsp_fir_cache_trim(hdsp_fir_cache_t *cache);
+
+/**
+ * Returns number of designs in cache.
+ */
+size_t hdsp_fir_cache_size(hdsp_fir_cache_t *cache);
+
+#endif // HDSP_HAVE_FIR_CACHE
 
 /* Tests */
 
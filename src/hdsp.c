@@ -36,6 +36,7 @@
 
 
 #include "hdsp.h"
+#include "hdsp_simd.h"
 
 double hdsp_factorial[HDSP_FACTORIAL_MAX + 1] = {
     1.0,1.0,2.0,6.0,24.0,120.0,720.0,
@@ -253,6 +254,103 @@ hdsp_status_t hdsp_downsample_float(float *x, size_t x_len, int downsample_facto
     return HDSP_STATUS_OK;
 }
 
+/**
+ * Copy n frames of frame_size bytes from x, every x_step-th frame, to y, every y_step-th frame.
+ * Common frame sizes (mono/stereo/quad of 16 bit and wider samples) get fixed size copies,
+ * compiled to single loads and stores.
+ */
+static void hdsp_frames_copy(const void *x, size_t x_step, void *y, size_t y_step, size_t n, size_t frame_size)
+{
+    const uint8_t *src = x;
+    uint8_t *dst = y;
+    size_t i = 0;
+
+    x_step *= frame_size;
+    y_step *= frame_size;
+
+#define HDSP_FRAMES_COPY(size) \
+    for (i = 0; i < n; i++) { \
+        memcpy(dst + i * y_step, src + i * x_step, size); \
+    }
+
+    switch (frame_size) {
+        case 2:
+            HDSP_FRAMES_COPY(2);
+            break;
+        case 4:
+            HDSP_FRAMES_COPY(4);
+            break;
+        case 8:
+            HDSP_FRAMES_COPY(8);
+            break;
+        case 16:
+            HDSP_FRAMES_COPY(16);
+            break;
+        case 32:
+            HDSP_FRAMES_COPY(32);
+            break;
+        default:
+            HDSP_FRAMES_COPY(frame_size);
+            break;
+    }
+
+#undef HDSP_FRAMES_COPY
+}
+
+hdsp_status_t hdsp_upsample_int16_interleaved(int16_t *x, size_t n_channels, size_t x_len, int upsample_factor,
+                                              int16_t *y, size_t y_len)
+{
+    if (!x || n_channels < 1 || x_len < 1 || upsample_factor < 1 || !y || y_len < 1) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (x_len * upsample_factor != y_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(y, 0, y_len * n_channels * sizeof(int16_t));
+    hdsp_frames_copy(x, 1, y, upsample_factor, x_len, n_channels * sizeof(int16_t));
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Check arguments of hdsp_downsample_*_interleaved and take every downsample_factor-th frame.
+ */
+static hdsp_status_t hdsp_downsample_interleaved(void *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                 void *y, size_t y_len, size_t sample_size)
+{
+    if (!x || n_channels < 1 || x_len < 1 || downsample_factor < 1 || !y || y_len < 1) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (x_len / downsample_factor != y_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_frames_copy(x, downsample_factor, y, 1, y_len, n_channels * sample_size);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_downsample_int16_interleaved(int16_t *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                int16_t *y, size_t y_len)
+{
+    return hdsp_downsample_interleaved(x, n_channels, x_len, downsample_factor, y, y_len, sizeof(int16_t));
+}
+
+hdsp_status_t hdsp_downsample_double_interleaved(double *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                 double *y, size_t y_len)
+{
+    return hdsp_downsample_interleaved(x, n_channels, x_len, downsample_factor, y, y_len, sizeof(double));
+}
+
+hdsp_status_t hdsp_downsample_float_interleaved(float *x, size_t n_channels, size_t x_len, int downsample_factor,
+                                                float *y, size_t y_len)
+{
+    return hdsp_downsample_interleaved(x, n_channels, x_len, downsample_factor, y, y_len, sizeof(float));
+}
+
 void hdsp_int16_2_float(int16_t *x, size_t x_len, float *y)
 {
     size_t k = 0;
@@ -262,6 +360,42 @@ void hdsp_int16_2_float(int16_t *x, size_t x_len, float *y)
     }
 }
 
+void hdsp_int16_2_double(int16_t *x, size_t x_len, double *y)
+{
+    size_t k = 0;
+    while (k < x_len) {
+        y[k] = (double) x[k];
+        k = k + 1;
+    }
+}
+
+void hdsp_int32_2_float(int32_t *x, size_t x_len, float *y)
+{
+    size_t k = 0;
+    while (k < x_len) {
+        y[k] = (float) x[k];
+        k = k + 1;
+    }
+}
+
+void hdsp_int32_2_double(int32_t *x, size_t x_len, double *y)
+{
+    size_t k = 0;
+    while (k < x_len) {
+        y[k] = (double) x[k];
+        k = k + 1;
+    }
+}
+
+void hdsp_float_2_double(float *x, size_t x_len, double *y)
+{
+    size_t k = 0;
+    while (k < x_len) {
+        y[k] = (double) x[k];
+        k = k + 1;
+    }
+}
+
 void hdsp_double_2_int16(double *x, size_t x_len, int16_t *y)
 {
     size_t k = 0;
@@ -289,10 +423,55 @@ void hdsp_float_2_int16(float *x, size_t x_len, int16_t *y)
     }
 }
 
+void hdsp_dither_init(hdsp_dither_t *dither, uint32_t seed)
+{
+    uint32_t z = 0;
+    size_t l = 0;
+
+    // splitmix32 of consecutive seeds, lanes are decorrelated and xorshift state must not be 0
+    for (l = 0; l < HDSP_DITHER_LANES; l++) {
+        seed += 0x9e3779b9u;
+        z = seed;
+        z = (z ^ (z >> 16)) * 0x85ebca6bu;
+        z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+        z = z ^ (z >> 16);
+        dither->state[l] = z ? z : 1;
+    }
+}
+
+void hdsp_double_2_int16_sat(double *x, size_t x_len, int16_t *y, hdsp_dither_t *dither)
+{
+    hdsp_cvt_f64_i16_sat(x, x_len, y, dither ? dither->state : NULL);
+}
+
+void hdsp_float_2_int16_sat(float *x, size_t x_len, int16_t *y, hdsp_dither_t *dither)
+{
+    hdsp_cvt_f32_i16_sat(x, x_len, y, dither ? dither->state : NULL);
+}
+
+void hdsp_double_2_int32_sat(double *x, size_t x_len, int32_t *y)
+{
+    hdsp_cvt_f64_i32_sat(x, x_len, y);
+}
+
+void hdsp_float_2_int32_sat(float *x, size_t x_len, int32_t *y)
+{
+    hdsp_cvt_f32_i32_sat(x, x_len, y);
+}
+
+void hdsp_int32_2_int16_sat(int32_t *x, size_t x_len, int16_t *y)
+{
+    size_t k = 0;
+
+    for (k = 0; k < x_len; k++) {
+        y[k] = (int16_t) hdsp_max(INT16_MIN, hdsp_min(INT16_MAX, x[k]));
+    }
+}
+
 #define DEBUG 0
 uint16_t hdsp_conv_full(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y)
 {
-    uint32_t t = 0, tau = 0;
+    uint32_t t = 0;
     uint32_t c_len = x_len + h_len - 1;
     uint32_t tau_min = 0, tau_max = 0;
 
@@ -302,7 +481,6 @@ uint16_t hdsp_conv_full(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, d
 
     while (t < c_len) {
 
-        y[t] = 0.0;
         tau_min = (t < h_len - 1) ? 0 : (t - (h_len - 1));
         tau_max = (t < h_len - 1) ? hdsp_min(x_len - 1, t) : t;
 
@@ -312,20 +490,296 @@ uint16_t hdsp_conv_full(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, d
             fprintf(stderr, "t,tau_min,tau_max: %u/%u/%u\n", t, tau_min, tau_max);
         }
 
-        for (tau = tau_min; tau <= tau_max; tau++) {
-            int16_t x_v = x[tau];
-            double h_v = h[t-tau];
-            y[t] += x_v * h_v;
-            if (DEBUG) {
-                fprintf(stderr, "-> t=%u,tau_min=%u,tau_max=%u\ttau=%u: x[%u]=%d h[%u]=%f y[%u]=%f\n",
-                        t, tau_min, tau_max, tau, tau, x_v, t - tau, h_v, t, y[t]);
+        // Sum{x[tau]h[t-tau]} over tau_min..tau_max is a dot product of x[tau_min..] and reversed h[..t-tau_min]
+        y[t] = hdsp_dot_rev_i16_f64(&x[tau_min], &h[t - tau_max], tau_max - tau_min + 1);
+
+        t = t + 1;
+    }
+
+    return t;
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x and h, written to y[0], ...
+ */
+static void hdsp_conv_range(int16_t *x, size_t x_len, double *h, size_t h_len, size_t t_start, size_t t_end,
+                            double *y)
+{
+    size_t t = 0, tau_min = 0, tau_max = 0;
+
+    for (t = t_start; t < t_end; t++) {
+        tau_min = (t < h_len - 1) ? 0 : (t - (h_len - 1));
+        tau_max = hdsp_min(t, x_len - 1);
+        y[t - t_start] = hdsp_dot_rev_i16_f64(&x[tau_min], &h[t - tau_max], tau_max - tau_min + 1);
+    }
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x and h, single precision, written to y[0], ...
+ */
+static void hdsp_conv_range_float(float *x, size_t x_len, float *h, size_t h_len, size_t t_start, size_t t_end,
+                                  float *y)
+{
+    size_t t = 0, tau_min = 0, tau_max = 0;
+
+    for (t = t_start; t < t_end; t++) {
+        tau_min = (t < h_len - 1) ? 0 : (t - (h_len - 1));
+        tau_max = hdsp_min(t, x_len - 1);
+        y[t - t_start] = hdsp_dot_rev_f32(&x[tau_min], &h[t - tau_max], tau_max - tau_min + 1);
+    }
+}
+
+uint16_t hdsp_conv_full_float(float *x, uint16_t x_len, float *h, uint16_t h_len, float *y)
+{
+    if (!x || !h || !y || x_len < 1 || h_len < 1) {
+        return 0;
+    }
+
+    hdsp_conv_range_float(x, x_len, h, h_len, 0, x_len + h_len - 1, y);
+
+    return x_len + h_len - 1;
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x and h skipping zero taps, written to y[0], ...
+ */
+static void hdsp_conv_range_sparse(int16_t *x, uint32_t x_len, double *h, uint32_t h_len,
+                                   uint16_t *h_nz_idx, uint32_t h_nz_len, uint32_t t_start, uint32_t t_end, double *y)
+{
+    uint32_t t = t_start, k = 0, j = 0;
+    double acc = 0.0;
+
+    while (t < t_end) {
+        // y[t] = Sum{x[t - k]h[k]}, over non-zero taps k with 0 <= t - k < x_len, in order of ascending t - k
+        // (same order as in hdsp_conv_full, so result is the same)
+        acc = 0.0;
+        j = h_nz_len;
+        if (t + 1 >= h_len && t < x_len) {
+            // filter fully overlaps x
+            while (j > 0) {
+                k = h_nz_idx[j - 1];
+                acc += x[t - k] * h[k];
+                j = j - 1;
+            }
+        } else {
+            while (j > 0) {
+                k = h_nz_idx[j - 1];
+                if (k <= t && t - k < x_len) {
+                    acc += x[t - k] * h[k];
+                }
+                j = j - 1;
             }
         }
+        y[t - t_start] = acc;
+        t = t + 1;
+    }
+}
+
+uint16_t hdsp_conv_full_sparse(int16_t *x, uint16_t x_len, double *h, uint16_t h_len,
+                               uint16_t *h_nz_idx, uint16_t h_nz_len, double *y)
+{
+    if (!x || !h || !h_nz_idx || !y || x_len < 1 || h_len < 1 || h_nz_len > h_len) {
+        return 0;
+    }
+
+    hdsp_conv_range_sparse(x, x_len, h, h_len, h_nz_idx, h_nz_len, 0, x_len + h_len - 1, y);
+
+    return x_len + h_len - 1;
+}
 
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution with symmetric filter h, written to y[0], ...
+ * Folded: y[t] = Sum{h[k](x[t - k] + x[t - (h_len - 1 - k)])} over the first half of taps (and the centre tap once,
+ * for odd h_len).
+ *      idx - ascending indices of non-zero taps of the first half of h, including the centre tap (k <= (h_len - 1) / 2),
+ *      or NULL to use all of them
+ *      idx_len - number of elements in idx
+ */
+static void hdsp_conv_range_folded(int16_t *x, uint32_t x_len, double *h, uint32_t h_len,
+                                   uint16_t *idx, uint32_t idx_len, uint32_t t_start, uint32_t t_end, double *y)
+{
+    uint32_t t = t_start, j = 0, k = 0, m = 0, pairs = 0;
+    uint32_t centre = (h_len % 2) ? (h_len - 1) / 2 : h_len;
+    int centre_nz = 0;
+    double acc = 0.0, v = 0.0;
+
+    if (!idx) {
+        idx_len = (h_len + 1) / 2;
+        pairs = h_len / 2;
+        centre_nz = (h_len % 2);
+    } else {
+        centre_nz = (idx_len > 0 && idx[idx_len - 1] == centre);
+        pairs = centre_nz ? idx_len - 1 : idx_len;
+    }
+
+    while (t < t_end) {
+        acc = 0.0;
+        if (t + 1 >= h_len && t < x_len) {
+            // filter fully overlaps x
+            for (j = 0; j < pairs; j++) {
+                k = idx ? idx[j] : j;
+                acc += h[k] * (double) (x[t - k] + x[t - (h_len - 1 - k)]);
+            }
+            if (centre_nz) {
+                acc += h[centre] * x[t - centre];
+            }
+        } else {
+            for (j = 0; j < pairs; j++) {
+                k = idx ? idx[j] : j;
+                m = h_len - 1 - k;
+                v = 0.0;
+                if (k <= t && t - k < x_len) {
+                    v += x[t - k];
+                }
+                if (m <= t && t - m < x_len) {
+                    v += x[t - m];
+                }
+                acc += h[k] * v;
+            }
+            if (centre_nz && centre <= t && t - centre < x_len) {
+                acc += h[centre] * x[t - centre];
+            }
+        }
+        y[t - t_start] = acc;
         t = t + 1;
     }
+}
 
-    return t;
+uint16_t hdsp_conv_full_symmetric(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y)
+{
+    if (!x || !h || !y || x_len < 1 || h_len < 1) {
+        return 0;
+    }
+
+    hdsp_conv_range_folded(x, x_len, h, h_len, NULL, 0, 0, x_len + h_len - 1, y);
+
+    return x_len + h_len - 1;
+}
+
+/**
+ * Length of real FFT not less than n (even, with n/2 of 2^a 3^b 5^c).
+ */
+static size_t hdsp_fft_real_len_ceil(size_t n)
+{
+    return 2 * hdsp_fft_len_ceil((n + 1) / 2);
+}
+
+/**
+ * Multiply spectrum x by spectrum h, n complex points, interleaved.
+ */
+static void hdsp_spectrum_mul(double *x, double *h, size_t n)
+{
+    size_t k = 0;
+    double v = 0.0;
+
+    for (k = 0; k < n; k++) {
+        v = x[2 * k] * h[2 * k] - x[2 * k + 1] * h[2 * k + 1];
+        x[2 * k + 1] = x[2 * k] * h[2 * k + 1] + x[2 * k + 1] * h[2 * k];
+        x[2 * k] = v;
+    }
+}
+
+/**
+ * Spectrum of filter h for hdsp_conv_range_fft_spec: h zero padded to plan->n samples, transformed.
+ *      block - (tmp) plan->n samples
+ *      h_spec - (out) plan->n / 2 + 1 points
+ */
+static void hdsp_conv_fft_h_spec(const hdsp_fft_plan_t *plan, double *h, size_t h_len, double *block, double *h_spec)
+{
+    memset(block, 0, plan->n * sizeof(double));
+    memcpy(block, h, h_len * sizeof(double));
+    hdsp_fft_real(plan, block, h_spec);
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x and h by FFT (overlap-add), written to y[0], ...
+ * with real plan of n > h_len - 1 points and spectrum of h (hdsp_conv_fft_h_spec). Only blocks contributing
+ * to the range are transformed, nothing is allocated.
+ *      spec - (tmp) n / 2 + 1 points
+ *      block - (tmp) n samples
+ */
+static void hdsp_conv_range_fft_spec(const hdsp_fft_plan_t *plan, double *h_spec, size_t h_len, double *spec,
+                                     double *block, int16_t *x, size_t x_len, size_t t_start, size_t t_end, double *y)
+{
+    size_t n = plan->n, L = n - h_len + 1, s = 0, k = 0, m = 0;
+
+    memset(y, 0, (t_end - t_start) * sizeof(double));
+
+    // block starting at s contributes to outputs s, ..., s + n - 1
+    s = 0;
+    while (s + n <= t_start) {
+        s = s + L;
+    }
+    while (s < x_len && s < t_end) {
+        memset(block, 0, n * sizeof(double));
+        for (k = 0; k < L && s + k < x_len; k++) {
+            block[k] = x[s + k];
+        }
+        hdsp_fft_real(plan, block, spec);
+        hdsp_spectrum_mul(spec, h_spec, n / 2 + 1);
+        hdsp_ifft_real(plan, spec, block);
+
+        // overlap-add
+        m = hdsp_min(s + n, t_end);
+        for (k = hdsp_max(s, t_start); k < m; k++) {
+            y[k - t_start] += block[k - s] / n;
+        }
+        s = s + L;
+    }
+}
+
+/**
+ * FFT length for convolution of h_len taps with up to x_len samples: FFT of 4 filter lengths
+ * (or less, if whole input fits) makes blocks 3 filter lengths long at least.
+ */
+static size_t hdsp_conv_fft_len(size_t x_len, size_t h_len)
+{
+    return hdsp_fft_real_len_ceil(hdsp_min(x_len + h_len - 1, 4 * h_len));
+}
+
+/**
+ * hdsp_conv_range_fft_spec with FFT plan and blocks allocated.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE on error.
+ */
+static hdsp_status_t hdsp_conv_range_fft(int16_t *x, size_t x_len, double *h, size_t h_len,
+                                         size_t t_start, size_t t_end, double *y)
+{
+    size_t n = hdsp_conv_fft_len(x_len, h_len);
+    hdsp_fft_plan_t plan = {0};
+    double *mem = NULL, *h_spec = NULL, *spec = NULL, *block = NULL;
+
+    if (HDSP_STATUS_OK != hdsp_fft_plan_init(&plan, n, HDSP_FFT_TYPE_REAL)) {
+        return HDSP_STATUS_FALSE;
+    }
+    mem = malloc((3 * n + 4) * sizeof(double));
+    if (!mem) {
+        hdsp_fft_plan_deinit(&plan);
+        return HDSP_STATUS_FALSE;
+    }
+    h_spec = mem;
+    spec = h_spec + n + 2;
+    block = spec + n + 2;
+
+    hdsp_conv_fft_h_spec(&plan, h, h_len, block, h_spec);
+    hdsp_conv_range_fft_spec(&plan, h_spec, h_len, spec, block, x, x_len, t_start, t_end, y);
+
+    free(mem);
+    hdsp_fft_plan_deinit(&plan);
+
+    return HDSP_STATUS_OK;
+}
+
+uint16_t hdsp_conv_full_fft(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y)
+{
+    if (!x || !h || !y || x_len < 1 || h_len < 1) {
+        return 0;
+    }
+
+    if (HDSP_STATUS_OK != hdsp_conv_range_fft(x, x_len, h, h_len, 0, (size_t) x_len + h_len - 1, y)) {
+        return 0;
+    }
+
+    return x_len + h_len - 1;
 }
 
 uint16_t hdsp_conv(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, hdsp_conv_type_t type,
@@ -361,6 +815,28 @@ uint16_t hdsp_conv(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, hdsp_c
     return n;
 }
 
+uint16_t hdsp_conv_same(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y)
+{
+    if (!x || !h || !y || x_len < 1 || h_len < 1) {
+        return 0;
+    }
+
+    hdsp_conv_range(x, x_len, h, h_len, h_len / 2, h_len / 2 + x_len, y);
+
+    return x_len;
+}
+
+uint16_t hdsp_conv_valid(int16_t *x, uint16_t x_len, double *h, uint16_t h_len, double *y)
+{
+    if (!x || !h || !y || x_len < 1 || h_len < 1 || x_len < h_len) {
+        return 0;
+    }
+
+    hdsp_conv_range(x, x_len, h, h_len, h_len - 1, x_len, y);
+
+    return x_len - h_len + 1;
+}
+
 void hdsp_hamming_window(double *w, uint16_t n)
 {
     uint16_t half = 0;
@@ -410,23 +886,41 @@ double hdsp_kaiser_beta(double attenuation_db)
             * (attenuation_db >= 21.0 && attenuation_db <= 50.0 ? 1 : 0);
 }
 
-void hdsp_design_kaiser_n_beta(uint16_t passband_freq, uint16_t fs_hz, double stopband_attenuation_db, double passband_ripple_db,
-                               uint16_t *n, double *beta)
+/**
+ * Attenuation in dB a Kaiser design must achieve to meet both stopband attenuation and passband ripple.
+ */
+static double hdsp_kaiser_attenuation_db(double stopband_attenuation_db, double passband_ripple_db)
 {
-    double passband_freq_normalized = (double) passband_freq / ((double)fs_hz / 2.0);
     double stopband_attenuation_linear = HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB_TO_LINEAR(stopband_attenuation_db);
     double passband_ripple_linear = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB_TO_LINEAR(passband_ripple_db);
-    double tw_percentage = -0.98 * HDSP_KAISER_FILTER_STEEPNES + 0.99;
-    double tw = tw_percentage * (1.0 - passband_freq_normalized);
-    double stopband_freq_normalized = passband_freq_normalized + tw;
-    //double stopband_freq = stopband_freq_normalized * ((double)fs_hz / 2.0);
-
+    double delta = hdsp_min(passband_ripple_linear, stopband_attenuation_linear);
+    return -20.0 * log10(delta);
+}
+
+/**
+ * Kaiser's estimate of filter length for attenuation in dB and transition width df (relative to sampling rate).
+ */
+static double hdsp_kaiser_n(double attenuation_db, double df)
+{
+    double D = (attenuation_db - 7.95) / (2.0 * M_PI * 2.285);   // 7.95 was in Kaiser's original paper
+    return ceil(D / df + 1);
+}
+
+void hdsp_design_kaiser_n_beta(uint16_t passband_freq, uint16_t fs_hz, double stopband_attenuation_db, double passband_ripple_db,
+                               uint16_t *n, double *beta)
+{
+    double passband_freq_normalized = (double) passband_freq / ((double)fs_hz / 2.0);
+    double stopband_attenuation_linear = HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB_TO_LINEAR(stopband_attenuation_db);
+    double passband_ripple_linear = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB_TO_LINEAR(passband_ripple_db);
+    double tw_percentage = -0.98 * HDSP_KAISER_FILTER_STEEPNES + 0.99;
+    double tw = tw_percentage * (1.0 - passband_freq_normalized);
+    double stopband_freq_normalized = passband_freq_normalized + tw;
+    //double stopband_freq = stopband_freq_normalized * ((double)fs_hz / 2.0);
+
     double passband_freq_normalized_2pi = passband_freq_normalized / 2.0;
     double stopband_freq_normalized_2pi = stopband_freq_normalized / 2.0;
 
-    double delta = hdsp_min(passband_ripple_linear, stopband_attenuation_linear);
-    double attenuation_db = -20.0 * log10(delta);
-    double D = (attenuation_db - 7.95) / (2.0 * M_PI * 2.285);   // 7.95 was in Kaiser's original paper
+    double attenuation_db = hdsp_kaiser_attenuation_db(stopband_attenuation_db, passband_ripple_db);
     double df = fabs(stopband_freq_normalized_2pi - passband_freq_normalized_2pi);
 
     if (DEBUG) {
@@ -437,10 +931,9 @@ void hdsp_design_kaiser_n_beta(uint16_t passband_freq, uint16_t fs_hz, double st
 
     if (n) {
         if (DEBUG) {
-            fprintf(stderr, "->D: %f\n", D);
             fprintf(stderr, "->df: %f\n", df);
         }
-        *n = ceil(D / df + 1);
+        *n = hdsp_kaiser_n(attenuation_db, df);
     }
 
     if (beta) {
@@ -456,6 +949,74 @@ double hdsp_sinc(double x, uint16_t fs_hz) {
     return sin(M_PI * x) / (M_PI * x);
 }
 
+/**
+ * hdsp_fir_filter_analyse of b_len taps b, b_nz_idx must have room for b_len indices (or be NULL
+ * to count non-zero taps only).
+ */
+static void hdsp_fir_taps_analyse(const double *b, size_t b_len, uint16_t *b_nz_idx, size_t *b_nz_len,
+                                  hdsp_filter_symmetry_t *symmetry)
+{
+    size_t k = 0;
+    double b_max = 0.0;
+
+    while (k < b_len) {
+        b_max = hdsp_max(b_max, fabs(b[k]));
+        k = k + 1;
+    }
+
+    *symmetry = HDSP_FILTER_SYMMETRY_EVEN;
+    k = 0;
+    while (k < b_len / 2) {
+        if (fabs(b[k] - b[b_len - 1 - k]) > HDSP_FIR_ZERO_TAP_EPSILON * b_max) {
+            *symmetry = HDSP_FILTER_SYMMETRY_NONE;
+            break;
+        }
+        k = k + 1;
+    }
+    if (b_len == 0) {
+        *symmetry = HDSP_FILTER_SYMMETRY_NONE;
+    }
+
+    // negligible taps (e.g. windowed zero crossings) are skipped, but left as they are
+    *b_nz_len = 0;
+    k = 0;
+    while (k < b_len) {
+        if (fabs(b[k]) > HDSP_FIR_ZERO_TAP_EPSILON * b_max) {
+            if (b_nz_idx) {
+                b_nz_idx[*b_nz_len] = k;
+            }
+            *b_nz_len = *b_nz_len + 1;
+        }
+        k = k + 1;
+    }
+}
+
+hdsp_status_t hdsp_fir_filter_analyse(hdsp_filter_t *filter)
+{
+    if (!filter || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fir_taps_analyse(filter->b, filter->b_len, NULL, &filter->b_nz_len, &filter->symmetry);
+    filter->analysed = 1;
+
+    return HDSP_STATUS_OK;
+}
+
+size_t hdsp_fir_filter_nz_idx(const hdsp_filter_t *filter, uint16_t *b_nz_idx)
+{
+    size_t b_nz_len = 0;
+    hdsp_filter_symmetry_t symmetry = HDSP_FILTER_SYMMETRY_NONE;
+
+    if (!filter || !b_nz_idx || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return 0;
+    }
+
+    hdsp_fir_taps_analyse(filter->b, filter->b_len, b_nz_idx, &b_nz_len, &symmetry);
+
+    return b_nz_len;
+}
+
 hdsp_status_t hdsp_fir_filter_init_lowpass_by_spectrum_sampling(hdsp_filter_t *filter, size_t n,
                                                                 uint16_t fs_hz, uint16_t passband_freq_hz) {
 
@@ -469,8 +1030,13 @@ hdsp_status_t hdsp_fir_filter_init_lowpass_by_spectrum_sampling(hdsp_filter_t *f
     memset(filter, 0, sizeof(*filter));
 
     while (k < n) {
-        filter->b[k] = (2.0 * passband_freq_hz / (double)fs_hz)
-                * hdsp_sinc(2.0 * passband_freq_hz * (k - L2) / (double)fs_hz, fs_hz);
+        // zero crossings of sinc (which sin() gives as ~1e-17) are exact zeros
+        if (k != L2 && (2 * (int64_t)passband_freq_hz * (k - L2)) % fs_hz == 0) {
+            filter->b[k] = 0.0;
+        } else {
+            filter->b[k] = (2.0 * passband_freq_hz / (double)fs_hz)
+                    * hdsp_sinc(2.0 * passband_freq_hz * (k - L2) / (double)fs_hz, fs_hz);
+        }
         k = k + 1;
     }
 
@@ -479,7 +1045,7 @@ hdsp_status_t hdsp_fir_filter_init_lowpass_by_spectrum_sampling(hdsp_filter_t *f
     filter->fs_hz = fs_hz;
     filter->design_method = HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING;
 
-    return HDSP_STATUS_OK;
+    return hdsp_fir_filter_analyse(filter);
 }
 
 hdsp_status_t hdsp_fir_filter_init_lowpass_by_ls(hdsp_filter_t *filter, size_t n,
@@ -505,6 +1071,567 @@ hdsp_status_t hdsp_fir_filter_init_lowpass_by_ls(hdsp_filter_t *filter, size_t n
     filter->fs_hz = fs_hz;
     filter->design_method = HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES;
 
+    return hdsp_fir_filter_analyse(filter);
+}
+
+#define HDSP_REMEZ_GRID_DENSITY 16 // grid points per cosine of Parks-McClellan design
+#define HDSP_REMEZ_ITERATIONS_MAX 64
+#define HDSP_REMEZ_TOLERANCE 1e-6 // exchange stops when extremal errors are within this of each other
+#define HDSP_LOWPASS_MEASURE_GRID_DENSITY 8 // grid points per tap and band of hdsp_fir_filter_lowpass_measure
+
+/**
+ * Band edges of spec in radians per sample and linear passband and stopband tolerances.
+ */
+static hdsp_status_t hdsp_lowpass_spec_bands(const hdsp_lowpass_spec_t *spec, double *wp, double *ws,
+                                             double *delta_p, double *delta_s)
+{
+    if (!spec || spec->passband_freq_hz == 0 || spec->passband_freq_hz >= spec->stopband_freq_hz
+            || 2 * (uint32_t)spec->stopband_freq_hz >= spec->fs_hz
+            || !(spec->passband_ripple_db > 0.0) || !(spec->stopband_attenuation_db > 0.0)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    *wp = 2.0 * M_PI * spec->passband_freq_hz / (double)spec->fs_hz;
+    *ws = 2.0 * M_PI * spec->stopband_freq_hz / (double)spec->fs_hz;
+    *delta_p = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB_TO_LINEAR(spec->passband_ripple_db);
+    *delta_s = HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB_TO_LINEAR(spec->stopband_attenuation_db);
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Spec of hdsp_design_kaiser_n_beta defaults (transition width, ripple and attenuation) for passband_freq_hz.
+ */
+static void hdsp_lowpass_spec_kaiser_default(hdsp_lowpass_spec_t *spec, uint16_t fs_hz, uint16_t passband_freq_hz)
+{
+    double tw_percentage = -0.98 * HDSP_KAISER_FILTER_STEEPNES + 0.99;
+
+    spec->fs_hz = fs_hz;
+    spec->passband_freq_hz = passband_freq_hz;
+    spec->stopband_freq_hz = passband_freq_hz;  // invalid spec unless passband is below fs / 2
+    if (2 * (uint32_t)passband_freq_hz < fs_hz) {
+        spec->stopband_freq_hz = passband_freq_hz
+                + (uint16_t)(tw_percentage * ((double)fs_hz / 2.0 - passband_freq_hz));
+    }
+    spec->passband_ripple_db = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB;
+    spec->stopband_attenuation_db = HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB;
+}
+
+/**
+ * Initializes filter to n taps linear phase filter of amplitude A(w) = sum a[j] cos(w ((n - 1) / 2 - j)),
+ * j = 0, ..., (n + 1) / 2 - 1.
+ */
+static hdsp_status_t hdsp_fir_filter_init_linear_phase(hdsp_filter_t *filter, size_t n, const double *a,
+                                                       const hdsp_lowpass_spec_t *spec,
+                                                       hdsp_filter_design_method_t method)
+{
+    size_t j = 0;
+
+    memset(filter, 0, sizeof(*filter));
+
+    while (j < (n + 1) / 2) {
+        if (2 * j + 1 == n) {
+            filter->b[j] = a[j];
+        } else {
+            filter->b[j] = a[j] / 2.0;
+            filter->b[n - 1 - j] = a[j] / 2.0;
+        }
+        j = j + 1;
+    }
+
+    filter->b_len = n;
+    filter->passband_freq_hz = spec->passband_freq_hz;
+    filter->fs_hz = spec->fs_hz;
+    filter->design_method = method;
+
+    return hdsp_fir_filter_analyse(filter);
+}
+
+/**
+ * Integral of cos(u w) over [w1, w2].
+ */
+static double hdsp_cos_integral(double u, double w1, double w2)
+{
+    if (u == 0.0) {
+        return w2 - w1;
+    }
+    return (sin(u * w2) - sin(u * w1)) / u;
+}
+
+hdsp_status_t hdsp_fir_filter_init_lowpass_wls(hdsp_filter_t *filter, size_t n, const hdsp_lowpass_spec_t *spec)
+{
+    double wp = 0.0, ws = 0.0, delta_p = 0.0, delta_s = 0.0;
+    double stop_weight = 0.0, t_j = 0.0, t_k = 0.0, sum = 0.0;
+    double *g = NULL, *a = NULL;
+    size_t m = (n + 1) / 2, j = 0, k = 0, l = 0;
+    hdsp_status_t status = HDSP_STATUS_OK;
+
+    if (!filter || n < 3 || n > HDSP_FIR_FILTER_LEN_MAX
+            || HDSP_STATUS_OK != hdsp_lowpass_spec_bands(spec, &wp, &ws, &delta_p, &delta_s)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    g = malloc((m * m + m) * sizeof(double));
+    if (!g) {
+        return HDSP_STATUS_FALSE;
+    }
+    a = g + m * m;
+
+    // normal equations g a = r of the weighted squared error integrated in closed form, lower triangle of g,
+    // r in a (desired amplitude is 1 in passband and 0 in stopband)
+    stop_weight = (delta_p / delta_s) * (delta_p / delta_s);
+    j = 0;
+    while (j < m) {
+        t_j = (double)(n - 1) / 2.0 - j;
+        a[j] = hdsp_cos_integral(t_j, 0.0, wp);
+        k = 0;
+        while (k <= j) {
+            t_k = (double)(n - 1) / 2.0 - k;
+            g[j * m + k] = 0.5 * (hdsp_cos_integral(t_j - t_k, 0.0, wp) + hdsp_cos_integral(t_j + t_k, 0.0, wp))
+                    + 0.5 * stop_weight * (hdsp_cos_integral(t_j - t_k, ws, M_PI)
+                                           + hdsp_cos_integral(t_j + t_k, ws, M_PI));
+            k = k + 1;
+        }
+        j = j + 1;
+    }
+
+    // Cholesky factorization g = L L^T in place
+    j = 0;
+    while (j < m && status == HDSP_STATUS_OK) {
+        sum = g[j * m + j];
+        l = 0;
+        while (l < j) {
+            sum = sum - g[j * m + l] * g[j * m + l];
+            l = l + 1;
+        }
+        if (!(sum > 0.0)) {
+            status = HDSP_STATUS_FALSE;
+            break;
+        }
+        g[j * m + j] = sqrt(sum);
+        k = j + 1;
+        while (k < m) {
+            sum = g[k * m + j];
+            l = 0;
+            while (l < j) {
+                sum = sum - g[k * m + l] * g[j * m + l];
+                l = l + 1;
+            }
+            g[k * m + j] = sum / g[j * m + j];
+            k = k + 1;
+        }
+        j = j + 1;
+    }
+
+    if (status == HDSP_STATUS_OK) {
+        // L y = r, L^T a = y
+        j = 0;
+        while (j < m) {
+            sum = a[j];
+            l = 0;
+            while (l < j) {
+                sum = sum - g[j * m + l] * a[l];
+                l = l + 1;
+            }
+            a[j] = sum / g[j * m + j];
+            j = j + 1;
+        }
+        j = m;
+        while (j > 0) {
+            j = j - 1;
+            sum = a[j];
+            l = j + 1;
+            while (l < m) {
+                sum = sum - g[l * m + j] * a[l];
+                l = l + 1;
+            }
+            a[j] = sum / g[j * m + j];
+        }
+        status = hdsp_fir_filter_init_linear_phase(filter, n, a, spec, HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES);
+    }
+
+    free(g);
+    return status;
+}
+
+/**
+ * 2 (cos(a) - cos(b)) from sines and cosines of a / 2 and b / 2, which (unlike the difference of cosines)
+ * keeps its precision for close a and b near 0 and pi.
+ */
+static double hdsp_remez_cos_diff(double sa, double ca, double sb, double cb)
+{
+    return -4.0 * (sa * cb + ca * sb) * (sa * cb - ca * sb);
+}
+
+/**
+ * Barycentric Lagrange interpolation at cos(w) of values c at m nodes cos(w_i) with weights d, nodes
+ * and w are given by sines and cosines of their halves.
+ */
+static double hdsp_remez_interpolate(double s, double co, const double *es, const double *ec,
+                                     const double *d, const double *c, size_t m)
+{
+    double num = 0.0, den = 0.0, t = 0.0;
+    size_t i = 0;
+
+    while (i < m) {
+        t = hdsp_remez_cos_diff(s, co, es[i], ec[i]);
+        if (t == 0.0) {
+            return c[i];
+        }
+        t = d[i] / t;
+        num = num + t * c[i];
+        den = den + t;
+        i = i + 1;
+    }
+    return num / den;
+}
+
+hdsp_status_t hdsp_fir_filter_init_lowpass_remez(hdsp_filter_t *filter, size_t n, const hdsp_lowpass_spec_t *spec)
+{
+    double wp = 0.0, ws = 0.0, w_end = M_PI, delta_p = 0.0, delta_s = 0.0;
+    double step = 0.0, w = 0.0, q = 0.0, sign = 0.0, num = 0.0, den = 0.0;
+    double delta = 0.0, e = 0.0, e_max = 0.0, sum = 0.0;
+    double *mem = NULL, *gs = NULL, *gc = NULL, *gd = NULL, *gw = NULL, *err = NULL;
+    double *es = NULL, *ec = NULL, *b = NULL, *d = NULL, *c = NULL;
+    size_t *ext = NULL, *cand = NULL;
+    size_t m = (n + 1) / 2, pass_len = 0, stop_len = 0, grid_len = 0;
+    size_t i = 0, j = 0, iter = 0, cand_first = 0, cand_len = 0;
+    int even = (n % 2 == 0), exp_j = 0, exp_sum = 0, exp_max = 0;
+    hdsp_status_t status = HDSP_STATUS_OK;
+
+    if (!filter || n < 3 || n > HDSP_FIR_FILTER_LEN_MAX
+            || HDSP_STATUS_OK != hdsp_lowpass_spec_bands(spec, &wp, &ws, &delta_p, &delta_s)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // dense grid over both bands, for even n A(w) = cos(w / 2) P(w) with P a sum of m cosines,
+    // which is approximated instead with desired response and weight scaled, pi (where A is 0) is left out
+    step = (wp + M_PI - ws) / (double)(HDSP_REMEZ_GRID_DENSITY * m);
+    if (even) {
+        w_end = M_PI - step;
+        ws = hdsp_min(ws, w_end);
+    }
+    pass_len = (size_t)ceil(wp / step) + 1;
+    stop_len = (size_t)ceil((w_end - ws) / step) + 1;
+    grid_len = pass_len + stop_len;
+
+    mem = malloc((5 * grid_len + 5 * (m + 1)) * sizeof(double));
+    ext = malloc((grid_len + m + 1) * sizeof(size_t));
+    if (!mem || !ext) {
+        free(mem);
+        free(ext);
+        return HDSP_STATUS_FALSE;
+    }
+    gs = mem;
+    gc = gs + grid_len;
+    gd = gc + grid_len;
+    gw = gd + grid_len;
+    err = gw + grid_len;
+    es = err + grid_len;
+    ec = es + m + 1;
+    b = ec + m + 1;
+    d = b + m + 1;
+    c = d + m + 1;
+    cand = ext + m + 1;
+
+    i = 0;
+    while (i < grid_len) {
+        if (i < pass_len) {
+            w = wp * i / (double)(pass_len - 1);
+        } else if (stop_len > 1) {
+            w = ws + (w_end - ws) * (i - pass_len) / (double)(stop_len - 1);
+        } else {
+            w = ws;
+        }
+        gs[i] = sin(w / 2.0);
+        gc[i] = cos(w / 2.0);
+        q = even ? gc[i] : 1.0;
+        gd[i] = (i < pass_len ? 1.0 : 0.0) / q;
+        gw[i] = (i < pass_len ? 1.0 : delta_p / delta_s) * q;
+        i = i + 1;
+    }
+
+    // m + 1 extremal frequencies spread evenly over the grid
+    i = 0;
+    while (i <= m) {
+        ext[i] = i * (grid_len - 1) / m;
+        i = i + 1;
+    }
+
+    iter = 0;
+    while (iter < HDSP_REMEZ_ITERATIONS_MAX) {
+        // barycentric weights of m + 1 extremals, products of 2 (cos(w_i) - cos(w_j)) over- or underflow
+        // for long filters, so exponents are kept apart (in c) and all weights scaled by the largest one.
+        // Sums of logarithms instead lose too much precision to converge for long filters
+        i = 0;
+        while (i <= m) {
+            es[i] = gs[ext[i]];
+            ec[i] = gc[ext[i]];
+            i = i + 1;
+        }
+        i = 0;
+        while (i <= m) {
+            q = 1.0;
+            exp_sum = 0;
+            j = 0;
+            while (j <= m) {
+                if (j != i) {
+                    q = frexp(q * hdsp_remez_cos_diff(es[i], ec[i], es[j], ec[j]), &exp_j);
+                    exp_sum = exp_sum + exp_j;
+                }
+                j = j + 1;
+            }
+            b[i] = 1.0 / q;
+            c[i] = -exp_sum;
+            exp_max = (i == 0) ? -exp_sum : hdsp_max(exp_max, -exp_sum);
+            i = i + 1;
+        }
+        num = 0.0;
+        den = 0.0;
+        i = 0;
+        while (i <= m) {
+            b[i] = ldexp(b[i], (int)c[i] - exp_max);
+            sign = (i % 2) ? -1.0 : 1.0;
+            num = num + b[i] * gd[ext[i]];
+            den = den + sign * b[i] / gw[ext[i]];
+            i = i + 1;
+        }
+        delta = num / den;
+
+        // A interpolates desired response -+ delta / weight at first m extremals
+        i = 0;
+        while (i < m) {
+            sign = (i % 2) ? -1.0 : 1.0;
+            c[i] = gd[ext[i]] - sign * delta / gw[ext[i]];
+            d[i] = b[i] * hdsp_remez_cos_diff(es[i], ec[i], es[m], ec[m]);
+            i = i + 1;
+        }
+
+        i = 0;
+        while (i < grid_len) {
+            err[i] = gw[i] * (gd[i] - hdsp_remez_interpolate(gs[i], gc[i], es, ec, d, c, m));
+            i = i + 1;
+        }
+
+        // local extrema of error alternating in sign (larger of adjacent extrema of same sign is kept),
+        // surplus extrema are removed from the ends. Extrema below |delta| aren't skipped, delta of the
+        // first iterations of long filters is in the noise of interpolation
+        cand_len = 0;
+        i = 0;
+        while (i < grid_len) {
+            e = err[i];
+            if (e == 0.0
+                    || (i != 0 && i != pass_len && ((e > 0.0 && err[i - 1] > e) || (e < 0.0 && err[i - 1] < e)))
+                    || (i + 1 != pass_len && i + 1 != grid_len
+                        && ((e > 0.0 && err[i + 1] >= e) || (e < 0.0 && err[i + 1] <= e)))) {
+                i = i + 1;
+                continue;
+            }
+            if (cand_len > 0 && (e > 0.0) == (err[cand[cand_len - 1]] > 0.0)) {
+                if (fabs(e) > fabs(err[cand[cand_len - 1]])) {
+                    cand[cand_len - 1] = i;
+                }
+            } else {
+                cand[cand_len] = i;
+                cand_len = cand_len + 1;
+            }
+            i = i + 1;
+        }
+        cand_first = 0;
+        while (cand_len > m + 1) {
+            if (fabs(err[cand[cand_first]]) < fabs(err[cand[cand_first + cand_len - 1]])) {
+                cand_first = cand_first + 1;
+            }
+            cand_len = cand_len - 1;
+        }
+        if (cand_len < m + 1) {
+            break;
+        }
+
+        e_max = 0.0;
+        i = 0;
+        while (i <= m) {
+            ext[i] = cand[cand_first + i];
+            e_max = hdsp_max(e_max, fabs(err[ext[i]]));
+            i = i + 1;
+        }
+        if (e_max - fabs(delta) <= HDSP_REMEZ_TOLERANCE * e_max) {
+            break;
+        }
+        iter = iter + 1;
+    }
+
+    if (!isfinite(delta)) {
+        status = HDSP_STATUS_FALSE;
+    }
+
+    if (status == HDSP_STATUS_OK) {
+        // taps by frequency sampling of A at 2 pi k / n, amplitude coefficients go to b
+        i = 0;
+        while (i <= (n - 1) / 2) {
+            w = 2.0 * M_PI * i / (double)n;
+            q = even ? cos(w / 2.0) : 1.0;
+            err[i] = q * hdsp_remez_interpolate(sin(w / 2.0), cos(w / 2.0), es, ec, d, c, m);
+            i = i + 1;
+        }
+        j = 0;
+        while (j < m) {
+            sum = err[0];
+            i = 1;
+            while (i <= (n - 1) / 2) {
+                sum = sum + 2.0 * err[i] * cos(2.0 * M_PI * i / (double)n * ((double)j - (double)(n - 1) / 2.0));
+                i = i + 1;
+            }
+            b[j] = (2 * j + 1 == n ? 1.0 : 2.0) * sum / (double)n;
+            j = j + 1;
+        }
+        status = hdsp_fir_filter_init_linear_phase(filter, n, b, spec, HDSP_FILTER_DESIGN_METHOD_REMEZ);
+    }
+
+    free(mem);
+    free(ext);
+    return status;
+}
+
+/**
+ * Magnitude of frequency response of filter at w (radians per sample).
+ */
+static double hdsp_fir_filter_magnitude(const hdsp_filter_t *filter, double w)
+{
+    double re = 0.0, im = 0.0, z_re = cos(w), z_im = -sin(w), p_re = 1.0, p_im = 0.0, t = 0.0;
+    size_t k = 0;
+
+    // e^(-jwk) by rotation rather than sin/cos per tap
+    while (k < filter->b_len) {
+        re = re + filter->b[k] * p_re;
+        im = im + filter->b[k] * p_im;
+        t = p_re * z_re - p_im * z_im;
+        p_im = p_re * z_im + p_im * z_re;
+        p_re = t;
+        k = k + 1;
+    }
+    return sqrt(re * re + im * im);
+}
+
+hdsp_status_t hdsp_fir_filter_lowpass_measure(const hdsp_filter_t *filter, const hdsp_lowpass_spec_t *spec,
+                                              double *passband_ripple_db, double *stopband_attenuation_db)
+{
+    double wp = 0.0, ws = 0.0, delta_p = 0.0, delta_s = 0.0, h = 0.0;
+    double pass_min = INFINITY, pass_max = 0.0, stop_max = 0.0;
+    size_t k = 0, len = 0;
+
+    if (!filter || !passband_ripple_db || !stopband_attenuation_db || filter->b_len == 0
+            || HDSP_STATUS_OK != hdsp_lowpass_spec_bands(spec, &wp, &ws, &delta_p, &delta_s)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    len = HDSP_LOWPASS_MEASURE_GRID_DENSITY * filter->b_len + 64;
+    while (k <= len) {
+        h = hdsp_fir_filter_magnitude(filter, wp * k / (double)len);
+        pass_min = hdsp_min(pass_min, h);
+        pass_max = hdsp_max(pass_max, h);
+        h = hdsp_fir_filter_magnitude(filter, ws + (M_PI - ws) * k / (double)len);
+        stop_max = hdsp_max(stop_max, h);
+        k = k + 1;
+    }
+
+    *passband_ripple_db = 20.0 * log10(pass_max / pass_min);
+    *stopband_attenuation_db = -20.0 * log10(stop_max);
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Designs n taps filter for spec by method, returns 1 if it meets the spec. Windowed sinc has odd length
+ * (n is rounded up).
+ */
+static int hdsp_fir_filter_design_lowpass_n(hdsp_filter_t *filter, size_t n, const hdsp_lowpass_spec_t *spec,
+                                            hdsp_filter_design_method_t method)
+{
+    double passband_ripple_db = 0.0, stopband_attenuation_db = 0.0, beta = 0.0;
+    double *w = NULL;
+    hdsp_status_t status = HDSP_STATUS_FALSE;
+
+    switch (method) {
+        case HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING:
+            n = hdsp_min(n | 1, HDSP_FIR_FILTER_LEN_MAX - 1);
+            w = malloc(n * sizeof(double));
+            if (!w) {
+                return 0;
+            }
+            // cutoff in the middle of transition band
+            beta = hdsp_kaiser_beta(hdsp_kaiser_attenuation_db(spec->stopband_attenuation_db,
+                                                               spec->passband_ripple_db));
+            hdsp_kaiser_window(w, n, beta);
+            status = hdsp_fir_filter_init_lowpass_by_spectrum_sampling(filter, n, spec->fs_hz,
+                                                    (spec->passband_freq_hz + spec->stopband_freq_hz) / 2);
+            if (status == HDSP_STATUS_OK) {
+                status = hdsp_fir_filter_shape(filter, w, n);
+            }
+            free(w);
+            break;
+        case HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES:
+            status = hdsp_fir_filter_init_lowpass_wls(filter, n, spec);
+            break;
+        case HDSP_FILTER_DESIGN_METHOD_REMEZ:
+            status = hdsp_fir_filter_init_lowpass_remez(filter, n, spec);
+            break;
+        default:
+            break;
+    }
+
+    if (status != HDSP_STATUS_OK
+            || HDSP_STATUS_OK != hdsp_fir_filter_lowpass_measure(filter, spec, &passband_ripple_db,
+                                                                  &stopband_attenuation_db)) {
+        return 0;
+    }
+    return passband_ripple_db <= spec->passband_ripple_db && stopband_attenuation_db >= spec->stopband_attenuation_db;
+}
+
+hdsp_status_t hdsp_fir_filter_design_lowpass(hdsp_filter_t *filter, const hdsp_lowpass_spec_t *spec,
+                                             hdsp_filter_design_method_t method)
+{
+    double wp = 0.0, ws = 0.0, delta_p = 0.0, delta_s = 0.0, df = 0.0, estimate = 0.0;
+    size_t n_max = (HDSP_FIR_FILTER_LEN_MAX - 1) | 1; // longest odd length
+    size_t n = 0, lo = 1, hi = 0, mid = 0; // odd lengths, lo doesn't meet the spec, hi does
+
+    if (!filter || HDSP_STATUS_OK != hdsp_lowpass_spec_bands(spec, &wp, &ws, &delta_p, &delta_s)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    df = (ws - wp) / (2.0 * M_PI);
+    if (method == HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING) {
+        estimate = hdsp_kaiser_n(hdsp_kaiser_attenuation_db(spec->stopband_attenuation_db, spec->passband_ripple_db),
+                                 df);
+    } else {
+        estimate = ceil((-20.0 * log10(sqrt(delta_p * delta_s)) - 13.0) / (14.6 * df) + 1.0);
+    }
+    n = (size_t)hdsp_max(3.0, hdsp_min(estimate, (double)n_max)) | 1;
+
+    // odd lengths only (type I filters, integer delay of (n - 1) / 2 samples): grow the estimate until spec
+    // is met, then bisect. Odd length n + 2 can do all n can (with zero end taps), so optimal (Remez) designs
+    // meeting the spec at n meet it at all longer odd lengths, for least squares and windowed sinc this holds
+    // nearly always, and the filter returned is checked against the spec anyway
+    while (hi == 0) {
+        if (hdsp_fir_filter_design_lowpass_n(filter, n, spec, method)) {
+            hi = n;
+        } else if (n == n_max) {
+            return HDSP_STATUS_FALSE;
+        } else {
+            lo = n;
+            n = hdsp_min((n + n / 4 + 1) | 1, n_max);
+        }
+    }
+    while (lo + 2 < hi) {
+        mid = lo + 2 * ((hi - lo) / 4);
+        if (hdsp_fir_filter_design_lowpass_n(filter, mid, spec, method)) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+
+    if (!hdsp_fir_filter_design_lowpass_n(filter, hi, spec, method)) {
+        return HDSP_STATUS_FALSE;
+    }
     return HDSP_STATUS_OK;
 }
 
@@ -512,9 +1639,14 @@ hdsp_status_t hdsp_fir_filter_init_lowpass(hdsp_filter_t *filter, size_t n,
                                            uint16_t fs_hz, uint16_t passband_freq_hz,
                                            hdsp_filter_design_method_t method)
 {
+    hdsp_lowpass_spec_t spec;
+
     switch (method) {
         case HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES:
             return hdsp_fir_filter_init_lowpass_by_ls(filter, n, fs_hz, passband_freq_hz);
+        case HDSP_FILTER_DESIGN_METHOD_REMEZ:
+            hdsp_lowpass_spec_kaiser_default(&spec, fs_hz, passband_freq_hz);
+            return hdsp_fir_filter_init_lowpass_remez(filter, n, &spec);
         case HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING:
         default:
             return hdsp_fir_filter_init_lowpass_by_spectrum_sampling(filter, n, fs_hz, passband_freq_hz);
@@ -533,80 +1665,2474 @@ hdsp_status_t hdsp_fir_filter_shape(hdsp_filter_t *filter, double *w, uint16_t w
         filter->b[k] *= w[k];
         k = k + 1;
     }
-    return HDSP_STATUS_OK;
+    return hdsp_fir_filter_analyse(filter);
 }
 
-hdsp_status_t hdsp_fir_filter_init_lowpass_kaiser_opt(hdsp_filter_t *filter, uint16_t fs_hz, uint16_t passband_freq_hz)
+hdsp_status_t hdsp_fir_design_kaiser_opt(hdsp_fir_design_t *design, uint16_t fs_hz, uint16_t passband_freq_hz)
 {
     uint16_t n = 0;
     double beta = 0.0;
-    double w[HDSP_FIR_LS_KAISER_57_4000_48000_LEN + HDSP_FIR_LS_KAISER_75_8000_48000_LEN] = {0};
 
-    if (!filter || (passband_freq_hz > fs_hz)) {
+    if (!design || (passband_freq_hz > fs_hz)) {
         return HDSP_STATUS_FALSE;
     }
 
-    memset(filter, 0, sizeof(*filter));
-
     if (fs_hz == 48000 && passband_freq_hz == 4000) {
-        hdsp_design_kaiser_n_beta(4000, 48000, HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB, HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB, &n, &beta);
         n = HDSP_FIR_LS_KAISER_57_4000_48000_LEN;
-        hdsp_kaiser_window(w, n, beta);
     } else if (fs_hz == 48000 && passband_freq_hz == 8000) {
-        hdsp_design_kaiser_n_beta(8000, 48000, HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB, HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB, &n, &beta);
         n = HDSP_FIR_LS_KAISER_75_8000_48000_LEN;
-        hdsp_kaiser_window(w, n, beta);
     } else {
         return HDSP_STATUS_FALSE;
     }
+    hdsp_design_kaiser_n_beta(passband_freq_hz, fs_hz, HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB,
+                              HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB, NULL, &beta);
 
-    hdsp_kaiser_window(w, n, beta);
-    if (HDSP_STATUS_OK != hdsp_fir_filter_init_lowpass_by_ls(filter, n, fs_hz, passband_freq_hz)) {
+    memset(design, 0, sizeof(*design));
+    design->fs_hz = fs_hz;
+    design->passband_freq_hz = passband_freq_hz;
+    design->n = n;
+    design->method = HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES;
+    design->window = HDSP_WINDOW_KAISER;
+    design->beta = beta;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_filter_init_design(hdsp_filter_t *filter, const hdsp_fir_design_t *design)
+{
+    double *w = NULL;
+    hdsp_status_t status = HDSP_STATUS_OK;
+
+    if (!filter || !design || design->n == 0 || design->n > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (HDSP_STATUS_OK != hdsp_fir_filter_init_lowpass(filter, design->n, design->fs_hz, design->passband_freq_hz,
+                                                       design->method)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    switch (design->window) {
+        case HDSP_WINDOW_NONE:
+            return HDSP_STATUS_OK;
+        case HDSP_WINDOW_HAMMING:
+        case HDSP_WINDOW_KAISER:
+            break;
+        default:
+            return HDSP_STATUS_FALSE;
+    }
+
+    w = malloc(design->n * sizeof(double));
+    if (!w) {
+        return HDSP_STATUS_FALSE;
+    }
+    if (design->window == HDSP_WINDOW_HAMMING) {
+        hdsp_hamming_window(w, design->n);
+    } else {
+        hdsp_kaiser_window(w, design->n, design->beta);
+    }
+    status = hdsp_fir_filter_shape(filter, w, design->n);
+    free(w);
+
+    return status;
+}
+
+hdsp_status_t hdsp_fir_filter_init_lowpass_kaiser_opt(hdsp_filter_t *filter, uint16_t fs_hz, uint16_t passband_freq_hz)
+{
+    hdsp_fir_design_t design;
+
+    if (!filter || HDSP_STATUS_OK != hdsp_fir_design_kaiser_opt(&design, fs_hz, passband_freq_hz)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    return hdsp_fir_filter_init_design(filter, &design);
+}
+
+#define HDSP_FIR_TAPS_BLOCK_LEN 256 // outputs accumulated together by hdsp_conv_range_taps (stay in L1)
+
+/**
+ * y[t - t_start] += a * x[t - k] for outputs lo <= t < hi (nothing if hi <= lo).
+ */
+static void hdsp_conv_block_tap(int16_t *x, double a, size_t k, size_t lo, size_t hi, size_t t_start, double *y)
+{
+    if (lo < hi) {
+        hdsp_axpy_i16_f64(&y[lo - t_start], a, &x[lo - k], hi - lo);
+    }
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x with fir, written to y[0], ..., tap by tap:
+ * for a block of outputs each non-zero tap (or pair of mirrored taps of symmetric filter, inputs added first)
+ * is multiplied by a vector of inputs with SIMD kernels, so zero taps are skipped and symmetric taps folded
+ * with vector instructions too. Result is the same as of hdsp_conv_range, up to rounding.
+ *      half_nz_len - number of non-zero taps of the first half (symmetric filters, see hdsp_fir_filter_macs)
+ */
+static void hdsp_conv_range_taps(int16_t *x, size_t x_len, const hdsp_fir_t *fir, size_t half_nz_len,
+                                 size_t t_start, size_t t_end, double *y)
+{
+    size_t t0 = 0, t1 = 0, j = 0, j_len = 0, k = 0, m = 0, lo_a = 0, hi_a = 0, lo_b = 0, hi_b = 0;
+    int folded = (fir->symmetry == HDSP_FILTER_SYMMETRY_EVEN);
+
+    if (folded) {
+        j_len = fir->b_nz_idx ? half_nz_len : (fir->b_len + 1) / 2;
+    } else {
+        j_len = fir->b_nz_idx ? fir->b_nz_len : fir->b_len;
+    }
+
+    for (t0 = t_start; t0 < t_end; t0 = t1) {
+        t1 = hdsp_min(t0 + HDSP_FIR_TAPS_BLOCK_LEN, t_end);
+        memset(&y[t0 - t_start], 0, (t1 - t0) * sizeof(double));
+        for (j = 0; j < j_len; j++) {
+            k = fir->b_nz_idx ? fir->b_nz_idx[j] : j;
+            m = folded ? fir->b_len - 1 - k : k;
+
+            // outputs t of the block with 0 <= t - k < x_len (and 0 <= t - m < x_len for the mirrored tap)
+            lo_a = hdsp_max(t0, k);
+            hi_a = hdsp_min(t1, x_len + k);
+            if (m == k) {
+                hdsp_conv_block_tap(x, fir->b[k], k, lo_a, hi_a, t_start, y);
+                continue;
+            }
+            lo_b = hdsp_max(t0, m);
+            hi_b = hdsp_min(t1, x_len + m);
+
+            // m > k: mirrored tap covers later outputs, both cover lo_b <= t < hi_a
+            hdsp_conv_block_tap(x, fir->b[k], k, lo_a, hdsp_min(hi_a, lo_b), t_start, y);
+            if (lo_b < hi_a) {
+                hdsp_axpy2_i16_f64(&y[lo_b - t_start], fir->b[k], &x[lo_b - k], &x[lo_b - m], hi_a - lo_b);
+            }
+            hdsp_conv_block_tap(x, fir->b[k], m, hdsp_max(lo_b, hi_a), hi_b, t_start, y);
+        }
+    }
+}
+
+/**
+ * Multiplies per output sample of direct convolution with filter: zero taps are skipped and mirrored taps
+ * of symmetric filters folded, by scalar kernels or (with SIMD) by hdsp_conv_range_taps.
+ *      half_nz_len - (out) number of non-zero taps of the first half (symmetric filters)
+ */
+static size_t hdsp_fir_filter_macs(const hdsp_fir_t *filter, size_t *half_nz_len)
+{
+    size_t n = 0, macs = filter->b_nz_len;
+
+    if (filter->symmetry == HDSP_FILTER_SYMMETRY_EVEN) {
+        // non-zero taps of the first half are a prefix of b_nz_idx
+        n = (filter->b_len + 1) / 2;
+        if (filter->b_nz_idx) {
+            n = 0;
+            while (n < filter->b_nz_len && filter->b_nz_idx[n] <= (filter->b_len - 1) / 2) {
+                n = n + 1;
+            }
+        }
+        macs = n;
+    }
+    *half_nz_len = n;
+    return macs;
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x with filter, by direct convolution,
+ * written to y[0], ...
+ */
+static void hdsp_fir_filter_direct(int16_t *x, size_t x_len, const hdsp_fir_t *filter, size_t half_nz_len,
+                                   size_t t_start, size_t t_end, double *y)
+{
+    int scalar = (hdsp_simd_get() == HDSP_SIMD_NONE);
+
+    if (!scalar && (filter->symmetry == HDSP_FILTER_SYMMETRY_EVEN || filter->b_nz_len < filter->b_len)) {
+        // fold or skip taps with vector kernels
+        hdsp_conv_range_taps(x, x_len, filter, half_nz_len, t_start, t_end, y);
+    } else if (filter->symmetry == HDSP_FILTER_SYMMETRY_EVEN) {
+        // fold mirrored taps
+        hdsp_conv_range_folded(x, x_len, filter->b, filter->b_len,
+                               filter->b_nz_len < filter->b_len ? filter->b_nz_idx : NULL, half_nz_len,
+                               t_start, t_end, y);
+    } else if (filter->b_nz_len < filter->b_len) {
+        // skip zero taps
+        hdsp_conv_range_sparse(x, x_len, filter->b, filter->b_len, filter->b_nz_idx, filter->b_nz_len,
+                               t_start, t_end, y);
+    } else {
+        hdsp_conv_range(x, x_len, filter->b, filter->b_len, t_start, t_end, y);
+    }
+}
+
+/**
+ * Zero-phase filter x with taps of fir (hdsp_fir_filter).
+ */
+static hdsp_status_t hdsp_fir_filter_taps(int16_t *x, size_t x_len, const hdsp_fir_t *fir, double *y, size_t y_len)
+{
+    size_t half_nz_len = 0, t_start = 0, t_end = 0;
+
+    if (!x || x_len == 0 || !fir || fir->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // 'same' part of the full-length convolution, computed directly into y (FFT only with a context)
+    t_start = fir->b_len / 2;
+    t_end = t_start + x_len;
+
+    hdsp_fir_filter_macs(fir, &half_nz_len);
+    hdsp_fir_filter_direct(x, x_len, fir, half_nz_len, t_start, t_end, y);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_filter(int16_t *x, size_t x_len, hdsp_filter_t *filter, double *y, size_t y_len)
+{
+    hdsp_fir_t fir = {0};
+
+    if (!filter || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // taps of filter may have changed since it was analysed, symmetry is found again
+    fir = hdsp_fir_view(filter);
+    return hdsp_fir_filter_taps(x, x_len, &fir, y, y_len);
+}
+
+hdsp_fir_t hdsp_fir_view(hdsp_filter_t *filter)
+{
+    hdsp_fir_t fir = {0};
+    size_t b_nz_len = 0;
+
+    if (!filter || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return fir;
+    }
+
+    // symmetry of the taps as they are now (not cached fields of filter), all taps are used
+    fir.b = filter->b;
+    fir.b_len = filter->b_len;
+    fir.b_nz_len = filter->b_len;
+    hdsp_fir_taps_analyse(filter->b, filter->b_len, NULL, &b_nz_len, &fir.symmetry);
+    fir.passband_freq_hz = filter->passband_freq_hz;
+    fir.fs_hz = filter->fs_hz;
+
+    return fir;
+}
+
+hdsp_status_t hdsp_fir_init(hdsp_fir_t *fir, double *b, size_t b_len, uint16_t fs_hz, uint16_t passband_freq_hz)
+{
+    size_t b_size = 0, idx_size = 0;
+    void *mem = NULL;
+
+    if (!fir || !b || b_len == 0 || b_len > HDSP_FIR_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // taps, then indices of non-zero taps, in one block
+    b_size = (b_len * sizeof(double) + HDSP_FIR_ALIGN - 1) / HDSP_FIR_ALIGN * HDSP_FIR_ALIGN;
+    idx_size = (b_len * sizeof(uint16_t) + HDSP_FIR_ALIGN - 1) / HDSP_FIR_ALIGN * HDSP_FIR_ALIGN;
+    if (posix_memalign(&mem, HDSP_FIR_ALIGN, b_size + idx_size) != 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(fir, 0, sizeof(*fir));
+    fir->mem = mem;
+    fir->b = mem;
+    fir->b_nz_idx = (uint16_t *) ((char *) mem + b_size);
+    memcpy(fir->b, b, b_len * sizeof(double));
+    fir->b_len = b_len;
+    fir->fs_hz = fs_hz;
+    fir->passband_freq_hz = passband_freq_hz;
+    hdsp_fir_taps_analyse(fir->b, fir->b_len, fir->b_nz_idx, &fir->b_nz_len, &fir->symmetry);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_init_from_filter(hdsp_fir_t *fir, hdsp_filter_t *filter)
+{
+    if (!filter) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    return hdsp_fir_init(fir, filter->b, filter->b_len, filter->fs_hz, filter->passband_freq_hz);
+}
+
+void hdsp_fir_deinit(hdsp_fir_t *fir)
+{
+    if (!fir) {
+        return;
+    }
+    free(fir->mem);
+    memset(fir, 0, sizeof(*fir));
+}
+
+hdsp_status_t hdsp_fir_filter_compact(int16_t *x, size_t x_len, const hdsp_fir_t *fir, double *y, size_t y_len)
+{
+    return hdsp_fir_filter_taps(x, x_len, fir, y, y_len);
+}
+
+static size_t hdsp_sample_size(hdsp_sample_type_t type)
+{
+    switch (type) {
+        case HDSP_SAMPLE_INT16:
+            return sizeof(int16_t);
+        case HDSP_SAMPLE_INT32:
+            return sizeof(int32_t);
+        case HDSP_SAMPLE_FLOAT:
+            return sizeof(float);
+        case HDSP_SAMPLE_DOUBLE:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Address of sample i of view.
+ */
+static inline void *hdsp_view_at(const hdsp_view_t *view, size_t i)
+{
+    return (char *) view->data + i * view->stride * hdsp_sample_size(view->type);
+}
+
+/**
+ * Returns 1 if views x and y share any sample memory, 0 otherwise. Different channels of the same
+ * interleaved frames (same distance between samples in bytes, samples at different offsets in frame)
+ * don't overlap. Otherwise views are taken to overlap if their address ranges do.
+ */
+static int hdsp_views_overlap(const hdsp_view_t *x, const hdsp_view_t *y)
+{
+    size_t x_size = hdsp_sample_size(x->type), y_size = hdsp_sample_size(y->type);
+    uintptr_t x_begin = (uintptr_t) x->data, y_begin = (uintptr_t) y->data;
+    uintptr_t x_end = 0, y_end = 0, step = x->stride * x_size, offset = 0;
+
+    if (x->len == 0 || y->len == 0) {
+        return 0;
+    }
+    x_end = x_begin + (x->len - 1) * x->stride * x_size + x_size;
+    y_end = y_begin + (y->len - 1) * y->stride * y_size + y_size;
+    if (x_end <= y_begin || y_end <= x_begin) {
+        return 0;
+    }
+    if (step != y->stride * y_size) {
+        return 1;
+    }
+    // offset of y's samples from the start of x's sample before them
+    offset = (y_begin >= x_begin) ? (y_begin - x_begin) % step : (step - (x_begin - y_begin) % step) % step;
+    return !(offset >= x_size && step - offset >= y_size);
+}
+
+hdsp_view_t hdsp_view(void *data, size_t len, hdsp_sample_type_t type)
+{
+    hdsp_view_t view = {0};
+
+    if (!data || hdsp_sample_size(type) == 0) {
+        return view;
+    }
+
+    view.data = data;
+    view.len = len;
+    view.stride = 1;
+    view.type = type;
+
+    return view;
+}
+
+hdsp_view_t hdsp_view_channel(void *data, size_t n_channels, size_t len, size_t channel, hdsp_sample_type_t type)
+{
+    hdsp_view_t view = {0};
+
+    if (!data || hdsp_sample_size(type) == 0 || channel >= n_channels) {
+        return view;
+    }
+
+    view.data = (char *) data + channel * hdsp_sample_size(type);
+    view.len = len;
+    view.stride = n_channels;
+    view.type = type;
+
+    return view;
+}
+
+hdsp_view_t hdsp_view_slice(hdsp_view_t view, size_t start, size_t len)
+{
+    hdsp_view_t slice = {0};
+
+    if (!view.data || start > view.len || len > view.len - start) {
+        return slice;
+    }
+
+    slice = view;
+    slice.data = hdsp_view_at(&view, start);
+    slice.len = len;
+
+    return slice;
+}
+
+hdsp_view_t hdsp_view_decimate(hdsp_view_t view, size_t factor)
+{
+    hdsp_view_t decimated = {0};
+
+    if (!view.data || factor < 1) {
+        return decimated;
+    }
+
+    decimated = view;
+    decimated.len = view.len / factor;
+    decimated.stride = view.stride * factor;
+
+    return decimated;
+}
+
+/**
+ * Convert n contiguous samples x of type x_type to y of type y_type (see hdsp_convert_view).
+ */
+static void hdsp_convert_contiguous(void *x, hdsp_sample_type_t x_type, void *y, hdsp_sample_type_t y_type,
+                                   size_t n, uint32_t *dither)
+{
+    size_t k = 0;
+
+    if (x_type == y_type) {
+        memmove(y, x, n * hdsp_sample_size(x_type));
+        return;
+    }
+
+    switch (y_type) {
+        case HDSP_SAMPLE_INT16:
+            if (x_type == HDSP_SAMPLE_DOUBLE) {
+                hdsp_cvt_f64_i16_sat(x, n, y, dither);
+            } else if (x_type == HDSP_SAMPLE_FLOAT) {
+                hdsp_cvt_f32_i16_sat(x, n, y, dither);
+            } else {
+                hdsp_int32_2_int16_sat(x, n, y);
+            }
+            break;
+        case HDSP_SAMPLE_INT32:
+            if (x_type == HDSP_SAMPLE_DOUBLE) {
+                hdsp_cvt_f64_i32_sat(x, n, y);
+            } else if (x_type == HDSP_SAMPLE_FLOAT) {
+                hdsp_cvt_f32_i32_sat(x, n, y);
+            } else {
+                for (k = 0; k < n; k++) {
+                    ((int32_t *) y)[k] = ((int16_t *) x)[k];
+                }
+            }
+            break;
+        case HDSP_SAMPLE_FLOAT:
+            if (x_type == HDSP_SAMPLE_DOUBLE) {
+                hdsp_double_2_float(x, n, y);
+            } else if (x_type == HDSP_SAMPLE_INT32) {
+                hdsp_int32_2_float(x, n, y);
+            } else {
+                hdsp_int16_2_float(x, n, y);
+            }
+            break;
+        case HDSP_SAMPLE_DOUBLE:
+        default:
+            if (x_type == HDSP_SAMPLE_FLOAT) {
+                hdsp_float_2_double(x, n, y);
+            } else if (x_type == HDSP_SAMPLE_INT32) {
+                hdsp_int32_2_double(x, n, y);
+            } else {
+                hdsp_int16_2_double(x, n, y);
+            }
+            break;
+    }
+}
+
+hdsp_status_t hdsp_convert_view(hdsp_view_t x, hdsp_view_t y, hdsp_dither_t *dither)
+{
+    // blocks of double hold samples of any type
+    double x_block[HDSP_VIEW_BLOCK_LEN], y_block[HDSP_VIEW_BLOCK_LEN];
+    uint32_t *state = dither ? dither->state : NULL;
+    size_t i = 0, n = 0;
+    void *xp = NULL, *yp = NULL;
+
+    if (!x.data || !y.data || y.len < x.len) {
+        return HDSP_STATUS_FALSE;
+    }
+    // conversion in place is sample by sample, so only the same samples of the same type may be shared
+    if ((x.data != y.data || x.stride != y.stride || x.type != y.type) && hdsp_views_overlap(&x, &y)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (x.stride == 1 && y.stride == 1) {
+        hdsp_convert_contiguous(x.data, x.type, y.data, y.type, x.len, state);
+        return HDSP_STATUS_OK;
+    }
+
+    for (i = 0; i < x.len; i += n) {
+        n = hdsp_min(HDSP_VIEW_BLOCK_LEN, x.len - i);
+        xp = hdsp_view_at(&x, i);
+        yp = hdsp_view_at(&y, i);
+        if (x.stride != 1) {
+            hdsp_frames_copy(xp, x.stride, x_block, 1, n, hdsp_sample_size(x.type));
+            xp = x_block;
+        }
+        hdsp_convert_contiguous(xp, x.type, (y.stride == 1) ? yp : y_block, y.type, n, state);
+        if (y.stride != 1) {
+            hdsp_frames_copy(y_block, 1, yp, y.stride, n, hdsp_sample_size(y.type));
+        }
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of view x (int16) with fir, by direct
+ * convolution, written to view y from its first sample. Strided input is gathered and output scattered
+ * in blocks of HDSP_VIEW_BLOCK_LEN outputs, fir->b_len must be at most HDSP_FIR_FILTER_LEN_MAX.
+ */
+static void hdsp_fir_filter_view_range(const hdsp_view_t *x, const hdsp_fir_t *fir, size_t half_nz_len,
+                                       size_t t_start, size_t t_end, const hdsp_view_t *y)
+{
+    int16_t x_block[HDSP_VIEW_BLOCK_LEN + HDSP_FIR_FILTER_LEN_MAX - 1];
+    double y_block[HDSP_VIEW_BLOCK_LEN];
+    int y_direct = (y->stride == 1 && y->type == HDSP_SAMPLE_DOUBLE);
+    size_t t = 0, t_next = 0, tau_min = 0, tau_max = 0;
+    double *yp = NULL;
+
+    for (t = t_start; t < t_end; t = t_next) {
+        t_next = hdsp_min(t + HDSP_VIEW_BLOCK_LEN, t_end);
+        yp = y_direct ? (double *) hdsp_view_at(y, t - t_start) : y_block;
+        if (x->stride == 1) {
+            hdsp_fir_filter_direct(x->data, x->len, fir, half_nz_len, t, t_next, yp);
+        } else {
+            // input samples the block depends on, convolved as a shorter signal starting at tau_min
+            tau_min = (t < fir->b_len - 1) ? 0 : t - (fir->b_len - 1);
+            tau_max = hdsp_min(t_next - 1, x->len - 1);
+            hdsp_frames_copy(hdsp_view_at(x, tau_min), x->stride, x_block, 1, tau_max - tau_min + 1,
+                             sizeof(int16_t));
+            hdsp_fir_filter_direct(x_block, tau_max - tau_min + 1, fir, half_nz_len, t - tau_min,
+                                   t_next - tau_min, yp);
+        }
+        if (!y_direct) {
+            hdsp_convert_view(hdsp_view(y_block, t_next - t, HDSP_SAMPLE_DOUBLE),
+                              hdsp_view_slice(*y, t - t_start, t_next - t), NULL);
+        }
+    }
+}
+
+hdsp_status_t hdsp_fir_filter_view(hdsp_view_t x, const hdsp_fir_t *fir, hdsp_view_t y)
+{
+    size_t half_nz_len = 0;
+
+    if (!x.data || x.len == 0 || x.type != HDSP_SAMPLE_INT16 || !fir || fir->b_len == 0 || !y.data
+        || y.len < x.len || hdsp_views_overlap(&x, &y)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (x.stride == 1 && y.stride == 1 && y.type == HDSP_SAMPLE_DOUBLE) {
+        return hdsp_fir_filter_taps(x.data, x.len, fir, y.data, y.len);
+    }
+    if (fir->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fir_filter_macs(fir, &half_nz_len);
+    hdsp_fir_filter_view_range(&x, fir, half_nz_len, fir->b_len / 2, fir->b_len / 2 + x.len, &y);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_conv_view(hdsp_view_t x, double *h, size_t h_len, hdsp_conv_type_t type, hdsp_view_t y,
+                             size_t *y_written)
+{
+    hdsp_fir_t fir = {0};
+    size_t t_start = 0, t_end = 0;
+
+    if (!x.data || x.len == 0 || x.type != HDSP_SAMPLE_INT16 || !h || h_len == 0 || !y.data || !y_written
+        || hdsp_views_overlap(&x, &y)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    switch (type) {
+        case HDSP_CONV_TYPE_SAME:
+            t_start = h_len / 2;
+            t_end = t_start + x.len;
+            break;
+        case HDSP_CONV_TYPE_VALID:
+            if (x.len < h_len) {
+                return HDSP_STATUS_FALSE;
+            }
+            t_start = h_len - 1;
+            t_end = x.len;
+            break;
+        case HDSP_CONV_TYPE_FULL:
+        default:
+            t_start = 0;
+            t_end = x.len + h_len - 1;
+            break;
+    }
+    if (y.len < t_end - t_start) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (x.stride == 1 && y.stride == 1 && y.type == HDSP_SAMPLE_DOUBLE) {
+        hdsp_conv_range(x.data, x.len, h, h_len, t_start, t_end, y.data);
+    } else {
+        if (h_len > HDSP_FIR_FILTER_LEN_MAX) {
+            return HDSP_STATUS_FALSE;
+        }
+        // plain taps (no zero taps skipped, no folding)
+        fir.b = h;
+        fir.b_len = h_len;
+        fir.b_nz_len = h_len;
+        hdsp_fir_filter_view_range(&x, &fir, 0, t_start, t_end, &y);
+    }
+    *y_written = t_end - t_start;
+
+    return HDSP_STATUS_OK;
+}
+
+// channels filtered together at the edges of frames by hdsp_fir_filter_batch_interleaved, rows of outputs
+// and inputs stay in L1
+#define HDSP_FIR_BATCH_CHANNELS 256
+
+hdsp_status_t hdsp_fir_filter_batch(int16_t **x, size_t n_channels, size_t x_len, const hdsp_fir_t *fir,
+                                    double **y, size_t y_len)
+{
+    size_t c = 0, n = 0, half_nz_len = 0, macs = 0, t_start = 0, t_end = 0;
+    hdsp_fft_plan_t plan = {0};
+    double *mem = NULL, *h_spec = NULL, *spec = NULL, *block = NULL;
+
+    if (!x || n_channels == 0 || x_len == 0 || !fir || fir->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+    for (c = 0; c < n_channels; c++) {
+        if (!x[c] || !y[c]) {
+            return HDSP_STATUS_FALSE;
+        }
+    }
+
+    t_start = fir->b_len / 2;
+    t_end = t_start + x_len;
+
+    // long filter: plan and spectrum of filter made once for all channels
+    macs = hdsp_fir_filter_macs(fir, &half_nz_len);
+    if (macs >= hdsp_conv_fft_taps_min && x_len >= hdsp_conv_fft_taps_min) {
+        n = hdsp_conv_fft_len(x_len, fir->b_len);
+        if (HDSP_STATUS_OK == hdsp_fft_plan_init(&plan, n, HDSP_FFT_TYPE_REAL)) {
+            mem = malloc((3 * n + 4) * sizeof(double));
+        }
+        if (mem) {
+            h_spec = mem;
+            spec = h_spec + n + 2;
+            block = spec + n + 2;
+            hdsp_conv_fft_h_spec(&plan, fir->b, fir->b_len, block, h_spec);
+            for (c = 0; c < n_channels; c++) {
+                hdsp_conv_range_fft_spec(&plan, h_spec, fir->b_len, spec, block, x[c], x_len, t_start, t_end, y[c]);
+            }
+            free(mem);
+            hdsp_fft_plan_deinit(&plan);
+            return HDSP_STATUS_OK;
+        }
+        hdsp_fft_plan_deinit(&plan);
+    }
+
+    for (c = 0; c < n_channels; c++) {
+        hdsp_fir_filter_direct(x[c], x_len, fir, half_nz_len, t_start, t_end, y[c]);
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Frames t_start, ..., t_end - 1 of hdsp_fir_filter_batch_interleaved tap by tap: each tap is broadcast, multiplied
+ * by a row of channels and added to the output row, taps outside of input are skipped (frames at the edges).
+ */
+static void hdsp_fir_filter_batch_rows(int16_t *x, size_t n_channels, size_t x_len, const hdsp_fir_t *fir,
+                                       size_t t_start, size_t t_end, double *y)
+{
+    size_t c = 0, c_len = 0, t = 0, t_full = 0, j = 0, j_len = 0, k = 0, k_min = 0, k_max = 0;
+    double *row = NULL;
+
+    j_len = fir->b_nz_idx ? fir->b_nz_len : fir->b_len;
+    for (c = 0; c < n_channels; c += HDSP_FIR_BATCH_CHANNELS) {
+        c_len = hdsp_min(HDSP_FIR_BATCH_CHANNELS, n_channels - c);
+        for (t = t_start; t < t_end; t++) {
+            t_full = t + fir->b_len / 2;
+            k_min = (t_full < x_len) ? 0 : t_full - (x_len - 1);
+            k_max = hdsp_min(t_full, fir->b_len - 1);
+            row = &y[t * n_channels + c];
+            memset(row, 0, c_len * sizeof(double));
+            for (j = 0; j < j_len; j++) {
+                k = fir->b_nz_idx ? fir->b_nz_idx[j] : j;
+                if (k < k_min) {
+                    continue;
+                }
+                if (k > k_max) {
+                    break;
+                }
+                hdsp_axpy_i16_f64(row, fir->b[k], &x[(t_full - k) * n_channels + c], c_len);
+            }
+        }
+    }
+}
+
+hdsp_status_t hdsp_fir_filter_batch_interleaved(int16_t *x, size_t n_channels, size_t x_len, const hdsp_fir_t *fir,
+                                                double *y, size_t y_len)
+{
+    size_t t = 0, t_lo = 0, t_hi = 0, j = 0, n = 0, half_nz_len = 0, k = 0, m = 0;
+    ptrdiff_t *o1 = NULL, *o2 = NULL;
+    double *a = NULL;
+    int folded = 0;
+
+    if (!x || n_channels == 0 || x_len == 0 || !fir || fir->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // frames t_lo <= t < t_hi use all taps (input frame t + b_len/2 - k exists for each k)
+    if (x_len < fir->b_len) {
+        hdsp_fir_filter_batch_rows(x, n_channels, x_len, fir, 0, x_len, y);
+        return HDSP_STATUS_OK;
+    }
+
+    t_lo = fir->b_len - 1 - fir->b_len / 2;
+    t_hi = x_len - fir->b_len / 2;
+
+    // taps (pairs of mirrored taps for symmetric filters) with offsets of their input frames
+    n = hdsp_fir_filter_macs(fir, &half_nz_len);
+    folded = (fir->symmetry == HDSP_FILTER_SYMMETRY_EVEN);
+    if (!folded) {
+        n = fir->b_nz_idx ? fir->b_nz_len : fir->b_len;
+    }
+    a = malloc(n * (sizeof(double) + 2 * sizeof(ptrdiff_t)));
+    if (!a) {
+        return HDSP_STATUS_FALSE;
+    }
+    o1 = (ptrdiff_t *) (a + n);
+    o2 = folded ? o1 + n : NULL;
+    for (j = 0; j < n; j++) {
+        k = fir->b_nz_idx ? fir->b_nz_idx[j] : j;
+        m = fir->b_len - 1 - k;
+        a[j] = fir->b[k];
+        o1[j] = -(ptrdiff_t) (k * n_channels);
+        if (folded) {
+            // middle tap of odd length is added twice at half weight (halving is exact)
+            a[j] = (m == k) ? fir->b[k] / 2 : fir->b[k];
+            o2[j] = -(ptrdiff_t) (m * n_channels);
+        }
+    }
+
+    // y[t] = Sum{b[k]x[t + b_len/2 - k]}, accumulators of a block of channels stay in registers across all taps
+    // and each output frame is written once (frames are read along all channels, which prefetches best)
+    hdsp_fir_filter_batch_rows(x, n_channels, x_len, fir, 0, t_lo, y);
+    for (t = t_lo; t < t_hi; t++) {
+        hdsp_dot_cols_i16_f64(&y[t * n_channels], a, &x[(t + fir->b_len / 2) * n_channels], o1, o2, n, n_channels);
+    }
+    hdsp_fir_filter_batch_rows(x, n_channels, x_len, fir, t_hi, x_len, y);
+    free(a);
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * FFT length of context, 0 if frames are always filtered directly.
+ */
+static size_t hdsp_fir_ctx_fft_len(size_t frame_len_max, size_t b_len_max)
+{
+    // no instruction set switches to FFT below HDSP_CONV_FFT_TAPS_MIN
+    if (b_len_max < HDSP_CONV_FFT_TAPS_MIN || frame_len_max < HDSP_CONV_FFT_TAPS_MIN) {
+        return 0;
+    }
+    return hdsp_conv_fft_len(frame_len_max, b_len_max);
+}
+
+size_t hdsp_fir_ctx_workspace_size(size_t frame_len_max, size_t b_len_max)
+{
+    size_t n = hdsp_fir_ctx_fft_len(frame_len_max, b_len_max);
+
+    if (n == 0) {
+        return 0;
+    }
+    // b_spec, spec (n / 2 + 1 complex points each), block (n samples), then FFT tables
+    return (3 * n + 4) * sizeof(double) + hdsp_fft_plan_mem_size(n, HDSP_FFT_TYPE_REAL);
+}
+
+hdsp_status_t hdsp_fir_ctx_init(hdsp_fir_ctx_t *ctx, size_t frame_len_max, size_t b_len_max,
+                                void *workspace, size_t workspace_size)
+{
+    size_t n = 0, size = 0;
+    double *mem = NULL;
+
+    if (!ctx || frame_len_max == 0 || b_len_max == 0 || b_len_max > HDSP_FIR_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->frame_len_max = frame_len_max;
+    ctx->b_len_max = b_len_max;
+
+    n = hdsp_fir_ctx_fft_len(frame_len_max, b_len_max);
+    size = hdsp_fir_ctx_workspace_size(frame_len_max, b_len_max);
+    if (n == 0) {
+        return HDSP_STATUS_OK;
+    }
+
+    if (workspace) {
+        if (workspace_size < size || ((uintptr_t) workspace % sizeof(double))) {
+            return HDSP_STATUS_FALSE;
+        }
+        mem = workspace;
+    } else {
+        mem = malloc(size);
+        if (!mem) {
+            return HDSP_STATUS_FALSE;
+        }
+        ctx->workspace_owned = 1;
+    }
+    ctx->workspace = mem;
+
+    ctx->b_spec = mem;
+    ctx->spec = ctx->b_spec + n + 2;
+    ctx->block = ctx->spec + n + 2;
+    if (HDSP_STATUS_OK != hdsp_fft_plan_init_mem(&ctx->plan, n, HDSP_FFT_TYPE_REAL, ctx->block + n,
+                                                 hdsp_fft_plan_mem_size(n, HDSP_FFT_TYPE_REAL))) {
+        hdsp_fir_ctx_deinit(ctx);
+        return HDSP_STATUS_FALSE;
+    }
+    ctx->fft_len = n;
+
+    return HDSP_STATUS_OK;
+}
+
+void hdsp_fir_ctx_deinit(hdsp_fir_ctx_t *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+    hdsp_fft_plan_deinit(&ctx->plan);
+    if (ctx->workspace_owned) {
+        free(ctx->workspace);
+    }
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+hdsp_status_t hdsp_fir_ctx_set_filter(hdsp_fir_ctx_t *ctx, hdsp_filter_t *filter)
+{
+    if (!ctx || !filter || filter->b_len == 0 || filter->b_len > ctx->b_len_max) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    ctx->filter = filter;
+    ctx->fir = hdsp_fir_view(filter);
+    if (ctx->fft_len > 0) {
+        hdsp_conv_fft_h_spec(&ctx->plan, filter->b, filter->b_len, ctx->block, ctx->b_spec);
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_ctx_set_fir(hdsp_fir_ctx_t *ctx, const hdsp_fir_t *fir)
+{
+    if (!ctx || !fir || fir->b_len == 0 || fir->b_len > ctx->b_len_max) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // taps are borrowed, not owned by the context
+    ctx->filter = NULL;
+    ctx->fir = *fir;
+    ctx->fir.mem = NULL;
+    if (ctx->fft_len > 0) {
+        hdsp_conv_fft_h_spec(&ctx->plan, fir->b, fir->b_len, ctx->block, ctx->b_spec);
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_filter_ctx(hdsp_fir_ctx_t *ctx, int16_t *x, size_t x_len, double *y, size_t y_len)
+{
+    hdsp_fir_t fir = {0};
+    const hdsp_fir_t *filter = NULL;
+    size_t half_nz_len = 0, macs = 0, t_start = 0, t_end = 0;
+
+    if (!ctx || ctx->fir.b_len == 0 || !x || x_len == 0 || x_len > ctx->frame_len_max || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    filter = &ctx->fir;
+    if (ctx->filter) {
+        fir = hdsp_fir_view(ctx->filter);
+        filter = &fir;
+    }
+    t_start = filter->b_len / 2;
+    t_end = t_start + x_len;
+
+    // same choice of kernel as hdsp_fir_filter, FFT with plan and spectrum of the context
+    macs = hdsp_fir_filter_macs(filter, &half_nz_len);
+    if (ctx->fft_len > 0 && macs >= hdsp_conv_fft_taps_min && x_len >= hdsp_conv_fft_taps_min) {
+        hdsp_conv_range_fft_spec(&ctx->plan, ctx->b_spec, filter->b_len, ctx->spec, ctx->block, x, x_len,
+                                 t_start, t_end, y);
+        return HDSP_STATUS_OK;
+    }
+    hdsp_fir_filter_direct(x, x_len, filter, half_nz_len, t_start, t_end, y);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_filter_float_init(hdsp_filter_float_t *filter_float, hdsp_filter_t *filter)
+{
+    size_t k = 0;
+
+    if (!filter_float || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(filter_float, 0, sizeof(*filter_float));
+    while (k < filter->b_len) {
+        filter_float->b[k] = (float) filter->b[k];
+        k = k + 1;
+    }
+    filter_float->b_len = filter->b_len;
+    filter_float->passband_freq_hz = filter->passband_freq_hz;
+    filter_float->fs_hz = filter->fs_hz;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_filter_float(float *x, size_t x_len, hdsp_filter_float_t *filter, float *y, size_t y_len)
+{
+    if (!x || x_len == 0 || !filter || filter->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // 'same' part of the full-length convolution, computed directly into y
+    hdsp_conv_range_float(x, x_len, filter->b, filter->b_len, filter->b_len / 2, filter->b_len / 2 + x_len, y);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_filter_q15_init(hdsp_filter_q15_t *filter_q15, hdsp_filter_t *filter)
+{
+    size_t k = 0;
+    int shift = 0;
+    double b_abs_max = 0.0;
+    int64_t b_q = 0, b_q_abs_max = 0, b_q_abs_sum = 0;
+
+    if (!filter_q15 || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    for (k = 0; k < filter->b_len; k++) {
+        b_abs_max = hdsp_max(b_abs_max, fabs(filter->b[k]));
+    }
+    if (b_abs_max == 0.0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // largest shift such that taps fit in int16 and |Sum{x[j]b_q[j]}| + rounding term < 2^31 for any int16 x
+    for (shift = 30; shift >= 0; shift--) {
+        b_q_abs_max = 0;
+        b_q_abs_sum = 0;
+        for (k = 0; k < filter->b_len; k++) {
+            b_q = llround(ldexp(filter->b[k], shift));
+            b_q = b_q < 0 ? -b_q : b_q;
+            b_q_abs_max = hdsp_max(b_q_abs_max, b_q);
+            b_q_abs_sum += b_q;
+        }
+        if (b_q_abs_max <= INT16_MAX
+                && b_q_abs_sum * 32768 + (shift > 0 ? (INT64_C(1) << (shift - 1)) : 0) <= INT32_MAX) {
+            break;
+        }
+    }
+    if (shift < 0 || b_q_abs_max == 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(filter_q15, 0, sizeof(*filter_q15));
+    for (k = 0; k < filter->b_len; k++) {
+        filter_q15->b_rev[filter->b_len - 1 - k] = (int16_t) llround(ldexp(filter->b[k], shift));
+    }
+    filter_q15->b_len = filter->b_len;
+    filter_q15->shift = shift;
+    filter_q15->passband_freq_hz = filter->passband_freq_hz;
+    filter_q15->fs_hz = filter->fs_hz;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Elements t_start, ..., t_end - 1 of full-length convolution of x with fixed-point filter, written to y[0], ...
+ */
+static void hdsp_conv_range_q15(int16_t *x, size_t x_len, hdsp_filter_q15_t *filter, size_t t_start, size_t t_end,
+                                int16_t *y)
+{
+    size_t t = 0, tau_min = 0, tau_max = 0, h_len = filter->b_len;
+    int32_t acc = 0, round = filter->shift > 0 ? (INT32_C(1) << (filter->shift - 1)) : 0;
+
+    for (t = t_start; t < t_end; t++) {
+        tau_min = (t < h_len - 1) ? 0 : (t - (h_len - 1));
+        tau_max = hdsp_min(t, x_len - 1);
+        // h[t - tau] = b_rev[h_len - 1 - t + tau], plain dot product with reversed taps
+        acc = hdsp_dot_i16_i32(&x[tau_min], &filter->b_rev[h_len - 1 - t + tau_min], tau_max - tau_min + 1);
+        acc = (acc + round) >> filter->shift;
+        y[t - t_start] = (int16_t) hdsp_max(INT16_MIN, hdsp_min(INT16_MAX, acc));
+    }
+}
+
+uint16_t hdsp_conv_full_q15(int16_t *x, uint16_t x_len, hdsp_filter_q15_t *filter, int16_t *y)
+{
+    if (!x || !filter || !y || x_len < 1 || filter->b_len < 1 || (size_t) x_len + filter->b_len - 1 > UINT16_MAX) {
+        return 0;
+    }
+
+    hdsp_conv_range_q15(x, x_len, filter, 0, x_len + filter->b_len - 1, y);
+
+    return x_len + filter->b_len - 1;
+}
+
+hdsp_status_t hdsp_fir_filter_q15(int16_t *x, size_t x_len, hdsp_filter_q15_t *filter, int16_t *y, size_t y_len)
+{
+    if (!x || x_len == 0 || !filter || filter->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_conv_range_q15(x, x_len, filter, filter->b_len / 2, filter->b_len / 2 + x_len, y);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_filter_q15_snr(hdsp_filter_q15_t *filter_q15, hdsp_filter_t *filter, int16_t *x, size_t x_len,
+                                      double *snr_db)
+{
+    double *y_ref = NULL, signal = 0.0, noise = 0.0, e = 0.0;
+    int16_t *y_q15 = NULL;
+    size_t k = 0;
+
+    if (!filter_q15 || !filter || !x || x_len == 0 || !snr_db || filter_q15->b_len != filter->b_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    y_ref = malloc(x_len * sizeof(double));
+    y_q15 = malloc(x_len * sizeof(int16_t));
+    if (!y_ref || !y_q15) {
+        goto fail;
+    }
+
+    if (hdsp_fir_filter(x, x_len, filter, y_ref, x_len) != HDSP_STATUS_OK) {
+        goto fail;
+    }
+    if (hdsp_fir_filter_q15(x, x_len, filter_q15, y_q15, x_len) != HDSP_STATUS_OK) {
+        goto fail;
+    }
+
+    for (k = 0; k < x_len; k++) {
+        e = y_q15[k] - y_ref[k];
+        signal += y_ref[k] * y_ref[k];
+        noise += e * e;
+    }
+    *snr_db = noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+
+    free(y_ref);
+    free(y_q15);
+    return HDSP_STATUS_OK;
+
+fail:
+    if (y_ref) {
+        free(y_ref);
+        y_ref = NULL;
+    }
+    if (y_q15) {
+        free(y_q15);
+        y_q15 = NULL;
+    }
+    return HDSP_STATUS_FALSE;
+}
+
+hdsp_status_t hdsp_interp_init(hdsp_interp_t *interp, hdsp_filter_t *filter, int upsample_factor)
+{
+    int p = 0;
+    size_t k = 0, n = 0;
+
+    if (!interp || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX
+            || upsample_factor < 1 || upsample_factor > HDSP_INTERP_FACTOR_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(interp, 0, sizeof(*interp));
+
+    while (p < upsample_factor) {
+        interp->phase_offset[p] = n;
+        k = p;
+        while (k < filter->b_len) {
+            interp->h[n] = filter->b[k];
+            n = n + 1;
+            k = k + upsample_factor;
+        }
+        p = p + 1;
+    }
+    interp->phase_offset[upsample_factor] = n;
+
+    interp->b_len = filter->b_len;
+    interp->upsample_factor = upsample_factor;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_interpolate(int16_t *x, size_t x_len, hdsp_interp_t *interp, double *y, size_t y_len)
+{
+    size_t L = 0, n = 0, t = 0, p = 0, q = 0, i = 0, i_min = 0, i_max = 0, phase_len = 0;
+    double *h = NULL;
+    double acc = 0.0;
+
+    if (!x || x_len == 0 || !interp || interp->b_len == 0 || !y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    L = interp->upsample_factor;
+    if (y_len != x_len * L) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // Output n is element t = n + b_len/2 of the full-length convolution of upsampled x with b ('same' part).
+    // Only upsampled samples at multiples of L are non-zero, so y[n] = Sum{x[i]h[t - L*i]} and all taps used
+    // belong to the sub-filter p = t mod L: h[t - L*i] = h_p[t/L - i].
+    n = 0;
+    while (n < y_len) {
+        t = n + interp->b_len / 2;
+        p = t % L;
+        q = t / L;
+        h = &interp->h[interp->phase_offset[p]];
+        phase_len = interp->phase_offset[p + 1] - interp->phase_offset[p];
+
+        acc = 0.0;
+        if (phase_len > 0) {
+            i_min = (q + 1 > phase_len) ? q + 1 - phase_len : 0;
+            i_max = hdsp_min(q, x_len - 1);
+            for (i = i_min; i <= i_max; i++) {
+                acc += x[i] * h[q - i];
+            }
+        }
+        y[n] = acc;
+
+        n = n + 1;
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_interp_float_init(hdsp_interp_float_t *interp, hdsp_filter_float_t *filter, int upsample_factor)
+{
+    int p = 0;
+    size_t k = 0, n = 0;
+
+    if (!interp || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX
+            || upsample_factor < 1 || upsample_factor > HDSP_INTERP_FACTOR_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(interp, 0, sizeof(*interp));
+
+    while (p < upsample_factor) {
+        interp->phase_offset[p] = n;
+        k = p;
+        while (k < filter->b_len) {
+            interp->h[n] = filter->b[k];
+            n = n + 1;
+            k = k + upsample_factor;
+        }
+        p = p + 1;
+    }
+    interp->phase_offset[upsample_factor] = n;
+
+    interp->b_len = filter->b_len;
+    interp->upsample_factor = upsample_factor;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_interpolate_float(float *x, size_t x_len, hdsp_interp_float_t *interp, float *y, size_t y_len)
+{
+    size_t L = 0, n = 0, t = 0, p = 0, q = 0, i_min = 0, i_max = 0, phase_len = 0;
+    float *h = NULL;
+
+    if (!x || x_len == 0 || !interp || interp->b_len == 0 || !y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    L = interp->upsample_factor;
+    if (y_len != x_len * L) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // as in hdsp_interpolate, y[n] = Sum{x[i]h_p[t/L - i]}
+    n = 0;
+    while (n < y_len) {
+        t = n + interp->b_len / 2;
+        p = t % L;
+        q = t / L;
+        h = &interp->h[interp->phase_offset[p]];
+        phase_len = interp->phase_offset[p + 1] - interp->phase_offset[p];
+
+        y[n] = 0.0f;
+        if (phase_len > 0) {
+            i_min = (q + 1 > phase_len) ? q + 1 - phase_len : 0;
+            i_max = hdsp_min(q, x_len - 1);
+            if (i_min <= i_max) {
+                y[n] = hdsp_dot_rev_f32(&x[i_min], &h[q - i_max], i_max - i_min + 1);
+            }
+        }
+
+        n = n + 1;
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_decim_init(hdsp_decim_t *decim, hdsp_filter_t *filter, int downsample_factor)
+{
+    if (!decim || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX
+            || downsample_factor < 1) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(decim, 0, sizeof(*decim));
+    memcpy(decim->b, filter->b, filter->b_len * sizeof(filter->b[0]));
+    decim->b_len = filter->b_len;
+    decim->downsample_factor = downsample_factor;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Keep last n samples of the stream made of history (n samples) followed by x.
+ */
+static void hdsp_history_update(int16_t *history, size_t n, int16_t *x, size_t x_len)
+{
+    if (n == 0) {
+        return;
+    }
+
+    if (x_len >= n) {
+        memcpy(history, &x[x_len - n], n * sizeof(history[0]));
+    } else {
+        memmove(history, &history[x_len], (n - x_len) * sizeof(history[0]));
+        memcpy(&history[n - x_len], x, x_len * sizeof(history[0]));
+    }
+}
+
+/**
+ * Filter the stream made of history (b_len - 1 samples) followed by x with causal FIR filter b,
+ * evaluating output only at x[0], x[step], x[2 * step], ... y_len outputs are written to y.
+ * y[j] = Sum{b[k]s[j * step - k]}, where s is the stream.
+ */
+static void hdsp_fir_history_filter(double *b, size_t b_len, int16_t *history, int16_t *x, size_t step,
+                                    double *y, size_t y_len)
+{
+    size_t H = b_len - 1, j = 0, n = 0, k = 0, k_x = 0;
+    double acc = 0.0;
+
+    j = 0;
+    while (j < y_len) {
+        n = j * step;
+        acc = 0.0;
+
+        // taps falling onto x
+        k_x = hdsp_min(n, H);
+        for (k = 0; k <= k_x; k++) {
+            acc += b[k] * x[n - k];
+        }
+
+        // taps falling onto history
+        for (k = n + 1; k <= H; k++) {
+            acc += b[k] * history[H - (k - n)];
+        }
+
+        y[j] = acc;
+        j = j + 1;
+    }
+}
+
+hdsp_status_t hdsp_decimate(int16_t *x, size_t x_len, hdsp_decim_t *decim, double *y, size_t y_len)
+{
+    size_t M = 0;
+
+    if (!x || x_len == 0 || !decim || decim->b_len == 0 || !y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    M = decim->downsample_factor;
+    if (x_len % M != 0 || y_len != x_len / M) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fir_history_filter(decim->b, decim->b_len, decim->history, x, M, y, y_len);
+    hdsp_history_update(decim->history, decim->b_len - 1, x, x_len);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_decim_float_init(hdsp_decim_float_t *decim, hdsp_filter_float_t *filter, int downsample_factor)
+{
+    if (!decim || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX
+            || downsample_factor < 1) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(decim, 0, sizeof(*decim));
+    memcpy(decim->b, filter->b, filter->b_len * sizeof(filter->b[0]));
+    decim->b_len = filter->b_len;
+    decim->downsample_factor = downsample_factor;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Single precision hdsp_history_update.
+ */
+static void hdsp_history_update_float(float *history, size_t n, float *x, size_t x_len)
+{
+    if (n == 0) {
+        return;
+    }
+
+    if (x_len >= n) {
+        memcpy(history, &x[x_len - n], n * sizeof(history[0]));
+    } else {
+        memmove(history, &history[x_len], (n - x_len) * sizeof(history[0]));
+        memcpy(&history[n - x_len], x, x_len * sizeof(history[0]));
+    }
+}
+
+/**
+ * Single precision hdsp_fir_history_filter, taps falling onto x and onto history are two dot products.
+ */
+static void hdsp_fir_history_filter_float(float *b, size_t b_len, float *history, float *x, size_t step,
+                                          float *y, size_t y_len)
+{
+    size_t H = b_len - 1, j = 0, n = 0, k_x = 0;
+    float acc = 0.0f;
+
+    for (j = 0; j < y_len; j++) {
+        n = j * step;
+        k_x = hdsp_min(n, H);
+        acc = hdsp_dot_rev_f32(&x[n - k_x], b, k_x + 1);
+        if (n < H) {
+            acc += hdsp_dot_rev_f32(&history[n], &b[n + 1], H - n);
+        }
+        y[j] = acc;
+    }
+}
+
+hdsp_status_t hdsp_decimate_float(float *x, size_t x_len, hdsp_decim_float_t *decim, float *y, size_t y_len)
+{
+    size_t M = 0;
+
+    if (!x || x_len == 0 || !decim || decim->b_len == 0 || !y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    M = decim->downsample_factor;
+    if (x_len % M != 0 || y_len != x_len / M) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fir_history_filter_float(decim->b, decim->b_len, decim->history, x, M, y, y_len);
+    hdsp_history_update_float(decim->history, decim->b_len - 1, x, x_len);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_stream_init(hdsp_fir_stream_t *stream, hdsp_filter_t *filter)
+{
+    if (!stream || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    memcpy(stream->b, filter->b, filter->b_len * sizeof(filter->b[0]));
+    stream->b_len = filter->b_len;
+
+    return HDSP_STATUS_OK;
+}
+
+double hdsp_fir_stream_delay(hdsp_fir_stream_t *stream)
+{
+    if (!stream || stream->b_len == 0) {
+        return 0.0;
+    }
+    return ((double) stream->b_len - 1.0) / 2.0;
+}
+
+hdsp_status_t hdsp_fir_filter_stream(int16_t *x, size_t x_len, hdsp_fir_stream_t *stream, double *y, size_t y_len)
+{
+    if (!x || x_len == 0 || !stream || stream->b_len == 0 || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fir_history_filter(stream->b, stream->b_len, stream->history, x, 1, y, x_len);
+    hdsp_history_update(stream->history, stream->b_len - 1, x, x_len);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_fft_stream_init(hdsp_fir_fft_stream_t *stream, hdsp_filter_t *filter, size_t frame_len)
+{
+    size_t n = 0;
+
+    if (!stream || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX || frame_len == 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    n = hdsp_fft_real_len_ceil(frame_len + filter->b_len - 1);
+    stream->b_len = filter->b_len;
+    stream->frame_len = frame_len;
+    stream->fft_len = n;
+
+    if (HDSP_STATUS_OK != hdsp_fft_plan_init(&stream->plan, n, HDSP_FFT_TYPE_REAL)) {
+        return HDSP_STATUS_FALSE;
+    }
+    stream->b_spec = malloc((n + 2) * sizeof(double));
+    stream->spec = malloc((n + 2) * sizeof(double));
+    stream->block = calloc(n, sizeof(double));
+    if (!stream->b_spec || !stream->spec || !stream->block) {
+        hdsp_fir_fft_stream_deinit(stream);
+        return HDSP_STATUS_FALSE;
+    }
+
+    memcpy(stream->block, filter->b, filter->b_len * sizeof(filter->b[0]));
+    hdsp_fft_real(&stream->plan, stream->block, stream->b_spec);
+
+    return HDSP_STATUS_OK;
+}
+
+void hdsp_fir_fft_stream_deinit(hdsp_fir_fft_stream_t *stream)
+{
+    if (!stream) {
+        return;
+    }
+    hdsp_fft_plan_deinit(&stream->plan);
+    free(stream->b_spec);
+    free(stream->spec);
+    free(stream->block);
+    stream->b_spec = NULL;
+    stream->spec = NULL;
+    stream->block = NULL;
+    stream->b_len = 0;
+}
+
+double hdsp_fir_fft_stream_delay(hdsp_fir_fft_stream_t *stream)
+{
+    if (!stream || stream->b_len == 0) {
+        return 0.0;
+    }
+    return ((double) stream->b_len - 1.0) / 2.0;
+}
+
+hdsp_status_t hdsp_fir_filter_fft_stream(int16_t *x, size_t x_len, hdsp_fir_fft_stream_t *stream,
+                                         double *y, size_t y_len)
+{
+    size_t H = 0, n = 0, s = 0, c = 0, k = 0;
+
+    if (!x || x_len == 0 || !stream || stream->b_len == 0 || !stream->block || !y || y_len < x_len) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    H = stream->b_len - 1;
+    n = stream->fft_len;
+
+    // overlap-save: block of c samples preceded by H samples of history, first H outputs are discarded
+    s = 0;
+    while (s < x_len) {
+        c = hdsp_min(stream->frame_len, x_len - s);
+        memset(stream->block, 0, n * sizeof(double));
+        for (k = 0; k < H; k++) {
+            stream->block[k] = stream->history[k];
+        }
+        for (k = 0; k < c; k++) {
+            stream->block[H + k] = x[s + k];
+        }
+        hdsp_fft_real(&stream->plan, stream->block, stream->spec);
+        hdsp_spectrum_mul(stream->spec, stream->b_spec, n / 2 + 1);
+        hdsp_ifft_real(&stream->plan, stream->spec, stream->block);
+        for (k = 0; k < c; k++) {
+            y[s + k] = stream->block[H + k] / n;
+        }
+        hdsp_history_update(stream->history, H, &x[s], c);
+        s = s + c;
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fir_part_stream_init(hdsp_fir_part_stream_t *stream, hdsp_filter_t *filter, size_t block_len)
+{
+    size_t B = 0, P = 0, p = 0, n = 0;
+
+    if (!stream || !filter || filter->b_len == 0 || filter->b_len > HDSP_FIR_FILTER_LEN_MAX || block_len == 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    B = block_len;
+    P = (filter->b_len + B - 1) / B;
+    stream->b_len = filter->b_len;
+    stream->block_len = B;
+    stream->n_parts = P;
+
+    if (HDSP_STATUS_OK != hdsp_fft_plan_init(&stream->plan, 2 * B, HDSP_FFT_TYPE_REAL)) {
+        return HDSP_STATUS_FALSE;
+    }
+    stream->h_spec = malloc(P * (2 * B + 2) * sizeof(double));
+    stream->fdl = calloc(P * (2 * B + 2), sizeof(double));
+    stream->block = calloc(2 * B, sizeof(double));
+    stream->acc = malloc((2 * B + 2) * sizeof(double));
+    stream->out = malloc(2 * B * sizeof(double));
+    if (!stream->h_spec || !stream->fdl || !stream->block || !stream->acc || !stream->out) {
+        hdsp_fir_part_stream_deinit(stream);
+        return HDSP_STATUS_FALSE;
+    }
+
+    // partition p holds taps b[pB], ..., b[pB + B - 1], zero-padded to 2B
+    for (p = 0; p < P; p++) {
+        n = hdsp_min(B, filter->b_len - p * B);
+        memset(stream->out, 0, 2 * B * sizeof(double));
+        memcpy(stream->out, &filter->b[p * B], n * sizeof(filter->b[0]));
+        hdsp_fft_real(&stream->plan, stream->out, &stream->h_spec[p * (2 * B + 2)]);
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+void hdsp_fir_part_stream_deinit(hdsp_fir_part_stream_t *stream)
+{
+    if (!stream) {
+        return;
+    }
+    hdsp_fft_plan_deinit(&stream->plan);
+    free(stream->h_spec);
+    free(stream->fdl);
+    free(stream->block);
+    free(stream->acc);
+    free(stream->out);
+    stream->h_spec = NULL;
+    stream->fdl = NULL;
+    stream->block = NULL;
+    stream->acc = NULL;
+    stream->out = NULL;
+    stream->b_len = 0;
+}
+
+double hdsp_fir_part_stream_delay(hdsp_fir_part_stream_t *stream)
+{
+    if (!stream || stream->b_len == 0) {
+        return 0.0;
+    }
+    return ((double) stream->b_len - 1.0) / 2.0;
+}
+
+hdsp_status_t hdsp_fir_filter_part_stream(int16_t *x, size_t x_len, hdsp_fir_part_stream_t *stream,
+                                          double *y, size_t y_len)
+{
+    size_t B = 0, P = 0, S = 0, s = 0, p = 0, k = 0;
+    double *X = NULL, *H = NULL, *acc = NULL;
+
+    if (!x || x_len == 0 || !stream || stream->b_len == 0 || !stream->block || !y || y_len < x_len
+        || x_len % stream->block_len != 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    B = stream->block_len;
+    P = stream->n_parts;
+    S = 2 * B + 2; // doubles per spectrum
+    acc = stream->acc;
+
+    for (s = 0; s < x_len; s += B) {
+        // slide input by one block, transform last 2B samples into the newest slot of the delay line
+        memcpy(stream->block, &stream->block[B], B * sizeof(double));
+        for (k = 0; k < B; k++) {
+            stream->block[B + k] = x[s + k];
+        }
+        stream->fdl_pos = (stream->fdl_pos + 1) % P;
+        hdsp_fft_real(&stream->plan, stream->block, &stream->fdl[stream->fdl_pos * S]);
+
+        // Y = Sum{X[block - p]H[p]}
+        memset(acc, 0, S * sizeof(double));
+        for (p = 0; p < P; p++) {
+            X = &stream->fdl[((stream->fdl_pos + P - p) % P) * S];
+            H = &stream->h_spec[p * S];
+            for (k = 0; k < B + 1; k++) {
+                acc[2 * k] += X[2 * k] * H[2 * k] - X[2 * k + 1] * H[2 * k + 1];
+                acc[2 * k + 1] += X[2 * k] * H[2 * k + 1] + X[2 * k + 1] * H[2 * k];
+            }
+        }
+
+        // overlap-save, first half of the output is circularly aliased
+        hdsp_ifft_real(&stream->plan, acc, stream->out);
+        for (k = 0; k < B; k++) {
+            y[s + k] = stream->out[B + k] / (2 * B);
+        }
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+static uint32_t hdsp_gcd(uint32_t a, uint32_t b)
+{
+    uint32_t r = 0;
+    while (b) {
+        r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+/**
+ * Number of taps per phase of a resampler fs_in_hz -> fs_out_hz (L/M = fs_out/fs_in reduced) with Kaiser
+ * designed prototype filter, having passband and stopband edges at passband_freq_hz and stopband_freq_hz.
+ */
+static size_t hdsp_resampler_taps_per_phase(uint32_t fs_in_hz, uint32_t fs_out_hz,
+                                            double passband_freq_hz, double stopband_freq_hz)
+{
+    uint32_t L = fs_out_hz / hdsp_gcd(fs_in_hz, fs_out_hz);
+    double attenuation_db = hdsp_kaiser_attenuation_db(HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB,
+                                                       HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB);
+    double n = hdsp_kaiser_n(attenuation_db, (stopband_freq_hz - passband_freq_hz) / ((double) L * fs_in_hz));
+
+    // Round length up to a multiple of L, so all sub-filters have the same number of taps
+    return ceil(n / L);
+}
+
+/**
+ * Initializes resampler with prototype filter designed for given passband and stopband edges.
+ */
+static hdsp_status_t hdsp_resampler_init_spec(hdsp_resampler_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz,
+                                              double passband_freq_hz, double stopband_freq_hz, size_t n_channels)
+{
+    uint32_t gcd = 0, L = 0, M = 0;
+    double fs_hz = 0.0, fc = 0.0;
+    double beta = 0.0, v = 0.0;
+    double *h = NULL, *w = NULL;
+    size_t n = 0, K = 0, k = 0, j = 0, p = 0;
+
+    if (!resampler || fs_in_hz == 0 || fs_out_hz == 0 || !(passband_freq_hz < stopband_freq_hz)
+        || n_channels < 1) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(resampler, 0, sizeof(*resampler));
+
+    gcd = hdsp_gcd(fs_in_hz, fs_out_hz);
+    L = fs_out_hz / gcd;
+    M = fs_in_hz / gcd;
+
+    // Prototype lowpass runs at L * fs_in
+    fs_hz = (double) L * fs_in_hz;
+    fc = (passband_freq_hz + stopband_freq_hz) / 2.0;
+    beta = hdsp_kaiser_beta(hdsp_kaiser_attenuation_db(HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB,
+                                                       HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB));
+
+    K = hdsp_resampler_taps_per_phase(fs_in_hz, fs_out_hz, passband_freq_hz, stopband_freq_hz);
+    n = K * L;
+    if (n > HDSP_RESAMPLER_TAPS_MAX || L > INT32_MAX || M > INT32_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    h = malloc(n * sizeof(double));
+    w = malloc(n * sizeof(double));
+    resampler->bank = malloc(n * sizeof(double));
+    resampler->delay = calloc(2 * K * n_channels, sizeof(double));
+    if (!h || !w || !resampler->bank || !resampler->delay) {
+        goto fail;
+    }
+
+    // Kaiser windowed sinc, gain of L compensates for the energy lost by the zero insertion
+    hdsp_kaiser_window(w, n, beta);
+    k = 0;
+    while (k < n) {
+        v = 2.0 * fc / fs_hz * ((double) k - (double) (n - 1) / 2.0);
+        h[k] = L * (2.0 * fc / fs_hz) * (v == 0.0 ? 1.0 : sin(M_PI * v) / (M_PI * v)) * w[k];
+        k = k + 1;
+    }
+
+    // Sub-filter p holds h[p], h[p + L], h[p + 2L], ... reversed, so it is applied to the delay line
+    // ordered from the oldest to the newest sample
+    p = 0;
+    while (p < L) {
+        j = 0;
+        while (j < K) {
+            resampler->bank[p * K + j] = h[p + (K - 1 - j) * L];
+            j = j + 1;
+        }
+        p = p + 1;
+    }
+
+    free(h);
+    free(w);
+
+    resampler->fs_in_hz = fs_in_hz;
+    resampler->fs_out_hz = fs_out_hz;
+    resampler->upsample_factor = L;
+    resampler->downsample_factor = M;
+    resampler->taps_per_phase = K;
+    resampler->delay_pos = 0;
+    resampler->phase = 0;
+    resampler->n_channels = n_channels;
+
+    return HDSP_STATUS_OK;
+
+fail:
+    if (h) {
+        free(h);
+    }
+    if (w) {
+        free(w);
+    }
+    hdsp_resampler_deinit(resampler);
+    return HDSP_STATUS_FALSE;
+}
+
+hdsp_status_t hdsp_resampler_init(hdsp_resampler_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz)
+{
+    // Prototype filter must remove images of the upsampling and prevent aliasing of the downsampling,
+    // so its stopband starts at the lower of the two Nyquist frequencies
+    double stopband_freq_hz = hdsp_min(fs_in_hz, fs_out_hz) / 2.0;
+
+    return hdsp_resampler_init_spec(resampler, fs_in_hz, fs_out_hz, HDSP_RESAMPLER_PASSBAND * stopband_freq_hz,
+                                    stopband_freq_hz, 1);
+}
+
+hdsp_status_t hdsp_resampler_init_interleaved(hdsp_resampler_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz,
+                                              size_t n_channels)
+{
+    double stopband_freq_hz = hdsp_min(fs_in_hz, fs_out_hz) / 2.0;
+
+    return hdsp_resampler_init_spec(resampler, fs_in_hz, fs_out_hz, HDSP_RESAMPLER_PASSBAND * stopband_freq_hz,
+                                    stopband_freq_hz, n_channels);
+}
+
+void hdsp_resampler_deinit(hdsp_resampler_t *resampler)
+{
+    if (!resampler) {
+        return;
+    }
+    if (resampler->bank) {
+        free(resampler->bank);
+        resampler->bank = NULL;
+    }
+    if (resampler->delay) {
+        free(resampler->delay);
+        resampler->delay = NULL;
+    }
+    resampler->taps_per_phase = 0;
+}
+
+/**
+ * Number of outputs of L/M resampler at given phase for x_len inputs.
+ */
+static size_t hdsp_resampler_output_len_at(int L, int M, int phase, size_t x_len)
+{
+    uint64_t t_end = 0;
+
+    // outputs are at phase, phase + M, phase + 2M, ... on the upsampled axis, x_len inputs span x_len * L
+    t_end = (uint64_t) x_len * L;
+    if (t_end <= (uint64_t) phase) {
+        return 0;
+    }
+    return (t_end - phase + M - 1) / M;
+}
+
+/**
+ * Delay of L/M resampler with K taps per phase, in output samples.
+ */
+static double hdsp_resampler_delay_of(int L, int M, size_t K)
+{
+    // (n - 1) / 2 samples of the prototype filter rate L * fs_in = M * fs_out
+    return ((double) K * L - 1.0) / 2.0 / M;
+}
+
+size_t hdsp_resampler_output_len(hdsp_resampler_t *resampler, size_t x_len)
+{
+    if (!resampler || resampler->taps_per_phase == 0) {
+        return 0;
+    }
+    return hdsp_resampler_output_len_at(resampler->upsample_factor, resampler->downsample_factor,
+                                        resampler->phase, x_len);
+}
+
+double hdsp_resampler_delay(hdsp_resampler_t *resampler)
+{
+    if (!resampler || resampler->taps_per_phase == 0) {
+        return 0.0;
+    }
+    return hdsp_resampler_delay_of(resampler->upsample_factor, resampler->downsample_factor,
+                                   resampler->taps_per_phase);
+}
+
+/**
+ * Push one input sample into resampler, write output samples it completes to y. Returns their number.
+ */
+static inline size_t hdsp_resampler_push(hdsp_resampler_t *resampler, double v, double *y)
+{
+    size_t K = resampler->taps_per_phase, j = 0, n = 0;
+    double *h = NULL, *d = NULL;
+    double acc = 0.0;
+
+    resampler->delay[resampler->delay_pos] = v;
+    resampler->delay[resampler->delay_pos + K] = v;
+    resampler->delay_pos = resampler->delay_pos + 1;
+    if (resampler->delay_pos == K) {
+        resampler->delay_pos = 0;
+    }
+
+    // last K input samples, oldest first
+    d = &resampler->delay[resampler->delay_pos];
+
+    while (resampler->phase < resampler->upsample_factor) {
+        h = &resampler->bank[resampler->phase * K];
+        acc = 0.0;
+        for (j = 0; j < K; j++) {
+            acc += h[j] * d[j];
+        }
+        y[n] = acc;
+        n = n + 1;
+        resampler->phase = resampler->phase + resampler->downsample_factor;
+    }
+    resampler->phase = resampler->phase - resampler->upsample_factor;
+
+    return n;
+}
+
+hdsp_status_t hdsp_resample(int16_t *x, size_t x_len, hdsp_resampler_t *resampler, double *y, size_t y_len,
+                            size_t *y_written)
+{
+    size_t i = 0, n = 0;
+
+    if (!x || !resampler || resampler->taps_per_phase == 0 || resampler->n_channels != 1 || !y || !y_written) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (y_len < hdsp_resampler_output_len(resampler, x_len)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    while (i < x_len) {
+        n = n + hdsp_resampler_push(resampler, x[i], &y[n]);
+        i = i + 1;
+    }
+
+    *y_written = n;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_resample_double(double *x, size_t x_len, hdsp_resampler_t *resampler, double *y, size_t y_len,
+                                   size_t *y_written)
+{
+    size_t i = 0, n = 0;
+
+    if (!x || !resampler || resampler->taps_per_phase == 0 || resampler->n_channels != 1 || !y || !y_written) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (y_len < hdsp_resampler_output_len(resampler, x_len)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    while (i < x_len) {
+        n = n + hdsp_resampler_push(resampler, x[i], &y[n]);
+        i = i + 1;
+    }
+
+    *y_written = n;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Push one interleaved input frame into resampler, write output frames it completes to y.
+ * Returns their number.
+ */
+static inline size_t hdsp_resampler_push_frame(hdsp_resampler_t *resampler, int16_t *x, double *y)
+{
+    size_t K = resampler->taps_per_phase, C = resampler->n_channels, c = 0, n = 0;
+    double *d = NULL;
+
+    for (c = 0; c < C; c++) {
+        resampler->delay[resampler->delay_pos * C + c] = x[c];
+        resampler->delay[(resampler->delay_pos + K) * C + c] = x[c];
+    }
+    resampler->delay_pos = resampler->delay_pos + 1;
+    if (resampler->delay_pos == K) {
+        resampler->delay_pos = 0;
+    }
+
+    // last K input frames, oldest first
+    d = &resampler->delay[resampler->delay_pos * C];
+
+    while (resampler->phase < resampler->upsample_factor) {
+        hdsp_dot_cols_f64(&y[n * C], &resampler->bank[resampler->phase * K], d, K, C);
+        n = n + 1;
+        resampler->phase = resampler->phase + resampler->downsample_factor;
+    }
+    resampler->phase = resampler->phase - resampler->upsample_factor;
+
+    return n;
+}
+
+hdsp_status_t hdsp_resample_interleaved(int16_t *x, size_t x_len, hdsp_resampler_t *resampler, double *y,
+                                        size_t y_len, size_t *y_written)
+{
+    size_t i = 0, n = 0;
+
+    if (!x || !resampler || resampler->taps_per_phase == 0 || resampler->n_channels < 1 || !y || !y_written) {
         return HDSP_STATUS_FALSE;
     }
-    if (HDSP_STATUS_OK != hdsp_fir_filter_shape(filter, w, n)) {
+
+    if (y_len < hdsp_resampler_output_len(resampler, x_len)) {
         return HDSP_STATUS_FALSE;
     }
 
+    if (resampler->n_channels == 1) {
+        return hdsp_resample(x, x_len, resampler, y, y_len, y_written);
+    }
+
+    while (i < x_len) {
+        n = n + hdsp_resampler_push_frame(resampler, &x[i * resampler->n_channels], &y[n * resampler->n_channels]);
+        i = i + 1;
+    }
+
+    *y_written = n;
+
     return HDSP_STATUS_OK;
 }
 
-hdsp_status_t hdsp_fir_filter(int16_t *x, size_t x_len, hdsp_filter_t *filter, double *y, size_t y_len)
+hdsp_status_t hdsp_resampler_float_init(hdsp_resampler_float_t *resampler, uint32_t fs_in_hz, uint32_t fs_out_hz)
 {
-    int32_t idx_start = 0;
-    int32_t idx_end = 0;
-    double *y_tmp = NULL;
+    hdsp_resampler_t r = {0};
+    size_t K = 0, p = 0, j = 0;
 
-    if (!x || x_len == 0 || !filter || filter->b_len == 0 || !y || y_len < x_len) {
+    if (!resampler) {
         return HDSP_STATUS_FALSE;
     }
 
-    y_tmp = malloc(sizeof(double)*(x_len + filter->b_len - 1));
-    if (!y_tmp) {
-        goto fail;
+    memset(resampler, 0, sizeof(*resampler));
+    if (HDSP_STATUS_OK != hdsp_resampler_init(&r, fs_in_hz, fs_out_hz)) {
+        return HDSP_STATUS_FALSE;
     }
-    memset(y_tmp, 0, sizeof(double)*(x_len + filter->b_len - 1));
 
-    if (x_len + filter->b_len - 1 != hdsp_conv(x, x_len, filter->b, filter->b_len,
-                                               HDSP_CONV_TYPE_SAME, y_tmp, &idx_start, &idx_end)) {
-        goto fail;
+    K = r.taps_per_phase;
+    resampler->bank = malloc(r.upsample_factor * K * sizeof(float));
+    resampler->delay = calloc(2 * K, sizeof(float));
+    if (!resampler->bank || !resampler->delay) {
+        hdsp_resampler_deinit(&r);
+        hdsp_resampler_float_deinit(resampler);
+        return HDSP_STATUS_FALSE;
     }
 
-    memcpy(y, &y_tmp[idx_start], sizeof(y_tmp[0]) *(idx_end - idx_start));
+    // sub-filters of r are reversed for a plain dot product with the delay line,
+    // float kernel reverses taps itself, so they are stored in natural order
+    for (p = 0; p < (size_t) r.upsample_factor; p++) {
+        for (j = 0; j < K; j++) {
+            resampler->bank[p * K + j] = (float) r.bank[p * K + K - 1 - j];
+        }
+    }
+    resampler->fs_in_hz = r.fs_in_hz;
+    resampler->fs_out_hz = r.fs_out_hz;
+    resampler->upsample_factor = r.upsample_factor;
+    resampler->downsample_factor = r.downsample_factor;
+    resampler->taps_per_phase = K;
+    resampler->phase = r.phase;
 
-    free(y_tmp);
-    y_tmp = NULL;
+    hdsp_resampler_deinit(&r);
 
     return HDSP_STATUS_OK;
+}
 
-fail:
-    if (y_tmp) {
-        free(y_tmp);
-        y_tmp = NULL;
+void hdsp_resampler_float_deinit(hdsp_resampler_float_t *resampler)
+{
+    if (!resampler) {
+        return;
+    }
+    if (resampler->bank) {
+        free(resampler->bank);
+        resampler->bank = NULL;
+    }
+    if (resampler->delay) {
+        free(resampler->delay);
+        resampler->delay = NULL;
+    }
+    resampler->taps_per_phase = 0;
+}
+
+size_t hdsp_resampler_float_output_len(hdsp_resampler_float_t *resampler, size_t x_len)
+{
+    if (!resampler || resampler->taps_per_phase == 0) {
+        return 0;
+    }
+    return hdsp_resampler_output_len_at(resampler->upsample_factor, resampler->downsample_factor,
+                                        resampler->phase, x_len);
+}
+
+double hdsp_resampler_float_delay(hdsp_resampler_float_t *resampler)
+{
+    if (!resampler || resampler->taps_per_phase == 0) {
+        return 0.0;
+    }
+    return hdsp_resampler_delay_of(resampler->upsample_factor, resampler->downsample_factor,
+                                   resampler->taps_per_phase);
+}
+
+hdsp_status_t hdsp_resample_float(float *x, size_t x_len, hdsp_resampler_float_t *resampler, float *y, size_t y_len,
+                                  size_t *y_written)
+{
+    size_t K = 0, i = 0, n = 0;
+    float *d = NULL;
+
+    if (!x || !resampler || resampler->taps_per_phase == 0 || !y || !y_written) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (y_len < hdsp_resampler_float_output_len(resampler, x_len)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    K = resampler->taps_per_phase;
+    for (i = 0; i < x_len; i++) {
+        resampler->delay[resampler->delay_pos] = x[i];
+        resampler->delay[resampler->delay_pos + K] = x[i];
+        resampler->delay_pos = resampler->delay_pos + 1;
+        if (resampler->delay_pos == K) {
+            resampler->delay_pos = 0;
+        }
+
+        // last K input samples, oldest first
+        d = &resampler->delay[resampler->delay_pos];
+
+        while (resampler->phase < resampler->upsample_factor) {
+            y[n] = hdsp_dot_rev_f32(d, &resampler->bank[resampler->phase * K], K);
+            n = n + 1;
+            resampler->phase = resampler->phase + resampler->downsample_factor;
+        }
+        resampler->phase = resampler->phase - resampler->upsample_factor;
+    }
+
+    *y_written = n;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Passband and stopband edges of a multistage resampling stage fs_in_hz -> fs_out_hz (stage rates),
+ * when the final band is band_hz (lower Nyquist frequency of the whole conversion). Stage doesn't need
+ * to suppress anything which doesn't fall (alias or image) into the final band, later (or earlier) stages do it.
+ */
+static void hdsp_multistage_stage_spec(uint32_t fs_in_hz, uint32_t fs_out_hz, double band_hz,
+                                       double *passband_freq_hz, double *stopband_freq_hz)
+{
+    *passband_freq_hz = HDSP_RESAMPLER_PASSBAND * band_hz;
+    if (fs_out_hz < fs_in_hz) {
+        // decimation, components above fs_out - band alias outside of the final band
+        *stopband_freq_hz = fs_out_hz - band_hz;
+    } else {
+        // interpolation, first image of the final band starts at fs_in - band
+        *stopband_freq_hz = fs_in_hz - band_hz;
+    }
+}
+
+double hdsp_multistage_cost(uint32_t fs_in_hz, uint32_t fs_out_hz, int *factors, int n_stages)
+{
+    int i = 0;
+    uint64_t fs = fs_in_hz, fs_next = 0, ratio = 1;
+    double band_hz = hdsp_min(fs_in_hz, fs_out_hz) / 2.0, passband_freq_hz = 0.0, stopband_freq_hz = 0.0;
+    double macs = 0.0;
+
+    if (!factors || n_stages < 1 || n_stages > HDSP_MULTISTAGE_STAGES_MAX || fs_in_hz == 0 || fs_out_hz == 0) {
+        return 0.0;
+    }
+
+    while (i < n_stages) {
+        if (factors[i] < 2) {
+            return 0.0;
+        }
+        ratio = ratio * factors[i];
+        fs_next = fs_out_hz > fs_in_hz ? fs * factors[i] : fs / factors[i];
+        hdsp_multistage_stage_spec(fs, fs_next, band_hz, &passband_freq_hz, &stopband_freq_hz);
+        // taps per phase are evaluated for each output sample of the stage
+        macs += (double) hdsp_resampler_taps_per_phase(fs, fs_next, passband_freq_hz, stopband_freq_hz)
+                * fs_next / fs_out_hz;
+        fs = fs_next;
+        i = i + 1;
+    }
+
+    if (fs != fs_out_hz || ratio * hdsp_min(fs_in_hz, fs_out_hz) != hdsp_max(fs_in_hz, fs_out_hz)) {
+        return 0.0;
+    }
+
+    return macs;
+}
+
+/**
+ * Try all ordered factorizations of ratio (remaining part of it) into stages, keep the cheapest.
+ */
+static void hdsp_multistage_search(uint32_t fs_in_hz, uint32_t fs_out_hz, uint32_t ratio, int *factors, int n,
+                                   int *best_factors, int *best_n, double *best_macs)
+{
+    uint32_t d = 2;
+    double macs = 0.0;
+
+    if (ratio == 1) {
+        macs = hdsp_multistage_cost(fs_in_hz, fs_out_hz, factors, n);
+        if (macs > 0.0 && (*best_n == 0 || macs < *best_macs)) {
+            memcpy(best_factors, factors, n * sizeof(factors[0]));
+            *best_n = n;
+            *best_macs = macs;
+        }
+        return;
+    }
+
+    if (n == HDSP_MULTISTAGE_STAGES_MAX) {
+        return;
     }
+
+    while (d <= ratio) {
+        if (ratio % d == 0) {
+            factors[n] = d;
+            hdsp_multistage_search(fs_in_hz, fs_out_hz, ratio / d, factors, n + 1, best_factors, best_n, best_macs);
+        }
+        d = d + 1;
+    }
+}
+
+double hdsp_multistage_plan(uint32_t fs_in_hz, uint32_t fs_out_hz, int *factors, int *n_stages)
+{
+    uint32_t lo = hdsp_min(fs_in_hz, fs_out_hz), hi = hdsp_max(fs_in_hz, fs_out_hz);
+    int f[HDSP_MULTISTAGE_STAGES_MAX] = {0}, best_factors[HDSP_MULTISTAGE_STAGES_MAX] = {0};
+    int best_n = 0;
+    double best_macs = 0.0;
+
+    if (lo == 0 || hi == lo || hi % lo != 0) {
+        return 0.0;
+    }
+
+    hdsp_multistage_search(fs_in_hz, fs_out_hz, hi / lo, f, 0, best_factors, &best_n, &best_macs);
+    if (best_n == 0) {
+        return 0.0;
+    }
+
+    if (factors) {
+        memcpy(factors, best_factors, best_n * sizeof(best_factors[0]));
+    }
+    if (n_stages) {
+        *n_stages = best_n;
+    }
+    return best_macs;
+}
+
+hdsp_status_t hdsp_multistage_init(hdsp_multistage_t *ms, uint32_t fs_in_hz, uint32_t fs_out_hz, size_t max_frame_len)
+{
+    int i = 0;
+    uint32_t fs = fs_in_hz, fs_next = 0;
+    double band_hz = hdsp_min(fs_in_hz, fs_out_hz) / 2.0, passband_freq_hz = 0.0, stopband_freq_hz = 0.0;
+
+    if (!ms || max_frame_len == 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(ms, 0, sizeof(*ms));
+
+    if (0.0 == hdsp_multistage_plan(fs_in_hz, fs_out_hz, ms->factors, &ms->n_stages)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    while (i < ms->n_stages) {
+        fs_next = fs_out_hz > fs_in_hz ? fs * ms->factors[i] : fs / ms->factors[i];
+        hdsp_multistage_stage_spec(fs, fs_next, band_hz, &passband_freq_hz, &stopband_freq_hz);
+        if (HDSP_STATUS_OK != hdsp_resampler_init_spec(&ms->stage[i], fs, fs_next, passband_freq_hz,
+                                                       stopband_freq_hz, 1)) {
+            goto fail;
+        }
+        ms->macs_per_output += (double) ms->stage[i].taps_per_phase * fs_next / fs_out_hz;
+        fs = fs_next;
+        i = i + 1;
+    }
+
+    // Intermediate signals are never longer than the output (interpolation) or input (decimation),
+    // plus one sample per stage due to phase of each stage
+    ms->buf_len = (size_t) ceil((double) max_frame_len * hdsp_max(1.0, (double) fs_out_hz / fs_in_hz))
+            + HDSP_MULTISTAGE_STAGES_MAX;
+    ms->buf[0] = malloc(ms->buf_len * sizeof(double));
+    ms->buf[1] = malloc(ms->buf_len * sizeof(double));
+    if (!ms->buf[0] || !ms->buf[1]) {
+        goto fail;
+    }
+
+    ms->fs_in_hz = fs_in_hz;
+    ms->fs_out_hz = fs_out_hz;
+    ms->max_frame_len = max_frame_len;
+
+    return HDSP_STATUS_OK;
+
+fail:
+    hdsp_multistage_deinit(ms);
     return HDSP_STATUS_FALSE;
 }
 
+void hdsp_multistage_deinit(hdsp_multistage_t *ms)
+{
+    int i = 0;
+
+    if (!ms) {
+        return;
+    }
+    while (i < HDSP_MULTISTAGE_STAGES_MAX) {
+        hdsp_resampler_deinit(&ms->stage[i]);
+        i = i + 1;
+    }
+    if (ms->buf[0]) {
+        free(ms->buf[0]);
+        ms->buf[0] = NULL;
+    }
+    if (ms->buf[1]) {
+        free(ms->buf[1]);
+        ms->buf[1] = NULL;
+    }
+    ms->n_stages = 0;
+}
+
+size_t hdsp_multistage_output_len(hdsp_multistage_t *ms, size_t x_len)
+{
+    int i = 0;
+
+    if (!ms) {
+        return 0;
+    }
+    while (i < ms->n_stages) {
+        x_len = hdsp_resampler_output_len(&ms->stage[i], x_len);
+        i = i + 1;
+    }
+    return x_len;
+}
+
+double hdsp_multistage_delay(hdsp_multistage_t *ms)
+{
+    int i = 0;
+    double delay = 0.0;
+
+    if (!ms) {
+        return 0.0;
+    }
+    while (i < ms->n_stages) {
+        // stage delay is in samples of the stage's output rate
+        delay += hdsp_resampler_delay(&ms->stage[i]) * ms->fs_out_hz / ms->stage[i].fs_out_hz;
+        i = i + 1;
+    }
+    return delay;
+}
+
+hdsp_status_t hdsp_multistage_resample(int16_t *x, size_t x_len, hdsp_multistage_t *ms, double *y, size_t y_len,
+                                       size_t *y_written)
+{
+    int i = 0;
+    size_t n = 0;
+    double *in = NULL, *out = NULL;
+
+    if (!x || !ms || ms->n_stages < 1 || x_len > ms->max_frame_len || !y || !y_written) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (y_len < hdsp_multistage_output_len(ms, x_len)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // first stage reads x, last stage writes y, others ping-pong between intermediate buffers
+    out = ms->n_stages == 1 ? y : ms->buf[0];
+    if (HDSP_STATUS_OK != hdsp_resample(x, x_len, &ms->stage[0], out, ms->n_stages == 1 ? y_len : ms->buf_len, &n)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    i = 1;
+    while (i < ms->n_stages) {
+        in = out;
+        out = (i == ms->n_stages - 1) ? y : ms->buf[i % 2];
+        if (HDSP_STATUS_OK != hdsp_resample_double(in, n, &ms->stage[i], out,
+                                                   (i == ms->n_stages - 1) ? y_len : ms->buf_len, &n)) {
+            return HDSP_STATUS_FALSE;
+        }
+        i = i + 1;
+    }
+
+    *y_written = n;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_asrc_init(hdsp_asrc_t *asrc, uint32_t fs_in_hz, uint32_t fs_out_hz)
+{
+    double *w = NULL;
+    double attenuation_db = 0.0, v = 0.0;
+    size_t j = 0, n = 2 * (HDSP_ASRC_TABLE_LEN - 1) + 1;
+
+    if (!asrc || fs_in_hz == 0 || fs_out_hz == 0) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(asrc, 0, sizeof(*asrc));
+
+    asrc->ratio_nominal = (double) fs_out_hz / (double) fs_in_hz;
+    asrc->scale = hdsp_min(1.0, asrc->ratio_nominal);
+    asrc->half_taps = ceil(HDSP_ASRC_ZERO_CROSSINGS / asrc->scale);
+    if (2 * asrc->half_taps > HDSP_ASRC_TAPS_MAX) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // Kernel is sampled once here, at HDSP_ASRC_TABLE_OVERSAMPLING points per sample: right half of the
+    // symmetric Kaiser window spanning +/- HDSP_ASRC_ZERO_CROSSINGS samples, times sinc
+    w = malloc(n * sizeof(double));
+    if (!w) {
+        return HDSP_STATUS_FALSE;
+    }
+    attenuation_db = hdsp_kaiser_attenuation_db(HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB,
+                                                HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB);
+    hdsp_kaiser_window(w, n, hdsp_kaiser_beta(attenuation_db));
+    j = 0;
+    while (j < HDSP_ASRC_TABLE_LEN) {
+        v = HDSP_ASRC_CUTOFF * (double) j / HDSP_ASRC_TABLE_OVERSAMPLING;
+        asrc->table[j] = HDSP_ASRC_CUTOFF * (j == 0 ? 1.0 : sin(M_PI * v) / (M_PI * v)) * w[HDSP_ASRC_TABLE_LEN - 1 + j];
+        j = j + 1;
+    }
+    asrc->table[HDSP_ASRC_TABLE_LEN] = 0.0;
+    free(w);
+
+    asrc->ratio = asrc->ratio_nominal;
+    asrc->step = 1.0 / asrc->ratio;
+    asrc->t = asrc->half_taps;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_asrc_set_ratio(hdsp_asrc_t *asrc, double ratio)
+{
+    if (!asrc || asrc->half_taps == 0 || !(ratio > 0.0)) {
+        return HDSP_STATUS_FALSE;
+    }
+    asrc->ratio = ratio;
+    asrc->step = 1.0 / ratio;
+    return HDSP_STATUS_OK;
+}
+
+double hdsp_asrc_get_ratio(hdsp_asrc_t *asrc)
+{
+    if (!asrc) {
+        return 0.0;
+    }
+    return asrc->ratio;
+}
+
+double hdsp_asrc_track(hdsp_asrc_t *asrc, double fill, double target, uint32_t fs_out_hz)
+{
+    double err = 0.0, ppm = 0.0;
+
+    if (!asrc || asrc->half_taps == 0 || fs_out_hz == 0) {
+        return 0.0;
+    }
+
+    // Buffer filling up means we produce more samples than consumer takes, so ratio must go down
+    err = (fill - target) / fs_out_hz;
+    asrc->drift_integral += err;
+    ppm = -1e6 * (HDSP_ASRC_DRIFT_KP * err + HDSP_ASRC_DRIFT_KI * asrc->drift_integral);
+
+    if (ppm > HDSP_ASRC_DRIFT_PPM_MAX || ppm < -HDSP_ASRC_DRIFT_PPM_MAX) {
+        // anti-windup: don't integrate while saturated
+        asrc->drift_integral -= err;
+        ppm = ppm > 0 ? HDSP_ASRC_DRIFT_PPM_MAX : -HDSP_ASRC_DRIFT_PPM_MAX;
+    }
+
+    hdsp_asrc_set_ratio(asrc, asrc->ratio_nominal * (1.0 + ppm * 1e-6));
+    return ppm;
+}
+
+/**
+ * Number of outputs due once i input samples of a call are in the delay line: output k of the call
+ * is at t + k * step - i (t is position of the first one before the call) and is due when before half_taps.
+ * hdsp_asrc_process and hdsp_asrc_output_len both count outputs with this, so they agree exactly.
+ */
+static size_t hdsp_asrc_outputs_due(const hdsp_asrc_t *asrc, double t, size_t i)
+{
+    double n = ceil(((double) asrc->half_taps + (double) i - t) / asrc->step);
+
+    return n > 0.0 ? (size_t) n : 0;
+}
+
+size_t hdsp_asrc_output_len(hdsp_asrc_t *asrc, size_t x_len)
+{
+    if (!asrc || asrc->half_taps == 0) {
+        return 0;
+    }
+    return hdsp_asrc_outputs_due(asrc, asrc->t, x_len);
+}
+
+double hdsp_asrc_delay(hdsp_asrc_t *asrc)
+{
+    if (!asrc) {
+        return 0.0;
+    }
+    return asrc->half_taps * asrc->ratio;
+}
+
+hdsp_status_t hdsp_asrc_process(int16_t *x, size_t x_len, hdsp_asrc_t *asrc, double *y, size_t y_len,
+                                size_t *y_written)
+{
+    size_t i = 0, m = 0, n = 0, n_due = 0, N = 0, Kd = 0, idx = 0;
+    double *d = NULL;
+    double t = 0.0, f = 0.0, u = 0.0, u_step = 0.0, frac = 0.0, acc = 0.0;
+    double table_end = HDSP_ASRC_TABLE_LEN - 1;
+
+    if (!x || !asrc || asrc->half_taps == 0 || !y || !y_written) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    if (y_len < hdsp_asrc_output_len(asrc, x_len)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    Kd = asrc->half_taps;
+    N = 2 * Kd;
+    u_step = asrc->scale * HDSP_ASRC_TABLE_OVERSAMPLING;
+    t = asrc->t;
+
+    i = 0;
+    while (i < x_len) {
+        asrc->delay[asrc->delay_pos] = x[i];
+        asrc->delay[asrc->delay_pos + N] = x[i];
+        asrc->delay_pos = asrc->delay_pos + 1;
+        if (asrc->delay_pos == N) {
+            asrc->delay_pos = 0;
+        }
+        d = &asrc->delay[asrc->delay_pos];
+        n_due = hdsp_asrc_outputs_due(asrc, t, i + 1);
+
+        // output at time t + n * step - (i + 1) lies between d[Kd - 1] and d[Kd], f is its fractional part
+        while (n < n_due) {
+            f = t + n * asrc->step - (double) (i + 1) - (double) (Kd - 1);
+            f = hdsp_min(hdsp_max(f, 0.0), 1.0);
+            acc = 0.0;
+
+            // samples at and before t: distances f, f + 1, ...
+            u = f * u_step;
+            for (m = Kd; m > 0 && u < table_end; m--) {
+                idx = (size_t) u;
+                frac = u - idx;
+                acc += d[m - 1] * (asrc->table[idx] + frac * (asrc->table[idx + 1] - asrc->table[idx]));
+                u = u + u_step;
+            }
+
+            // samples after t: distances 1 - f, 2 - f, ...
+            u = (1.0 - f) * u_step;
+            for (m = Kd; m < N && u < table_end; m++) {
+                idx = (size_t) u;
+                frac = u - idx;
+                acc += d[m] * (asrc->table[idx] + frac * (asrc->table[idx + 1] - asrc->table[idx]));
+                u = u + u_step;
+            }
+
+            y[n] = acc * asrc->scale;
+            n = n + 1;
+        }
+
+        i = i + 1;
+    }
+    asrc->t = t + n * asrc->step - (double) x_len;
+
+    *y_written = n;
+
+    return HDSP_STATUS_OK;
+}
+
 double hdsp_modified_bessel_1st_kind_zero(double x)
 {
     int k = 0;
@@ -0,0 +1,417 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_fft.c - Mixed radix (4, 2, 3, 5) Fast Fourier Transform
+ */
+
+
+#include "hdsp.h"
+
+size_t hdsp_fft_len_ceil(size_t n)
+{
+    size_t m = 0, k = 0;
+
+    if (n <= 1) {
+        return 1;
+    }
+    for (m = n; ; m++) {
+        k = m;
+        while (k % 2 == 0) {
+            k = k / 2;
+        }
+        while (k % 3 == 0) {
+            k = k / 3;
+        }
+        while (k % 5 == 0) {
+            k = k / 5;
+        }
+        if (k == 1) {
+            return m;
+        }
+    }
+}
+
+/**
+ * Factor n into radices 4, 2, 3, 5 (in order of stages). Returns number of factors, 0 if n isn't 2^a 3^b 5^c.
+ */
+static size_t hdsp_fft_factorize(size_t n, size_t *factors)
+{
+    size_t k = 0;
+
+    while (n % 4 == 0 && k < HDSP_FFT_FACTORS_MAX) {
+        factors[k++] = 4;
+        n = n / 4;
+    }
+    while (n % 2 == 0 && k < HDSP_FFT_FACTORS_MAX) {
+        factors[k++] = 2;
+        n = n / 2;
+    }
+    while (n % 3 == 0 && k < HDSP_FFT_FACTORS_MAX) {
+        factors[k++] = 3;
+        n = n / 3;
+    }
+    while (n % 5 == 0 && k < HDSP_FFT_FACTORS_MAX) {
+        factors[k++] = 5;
+        n = n / 5;
+    }
+    return (n == 1) ? k : 0;
+}
+
+/**
+ * Digit reversal: perm[p] is the index of input sample which goes to position p before the first stage.
+ * Transform of length len (product of first m factors) is made of factors[m - 1] transforms of decimated input,
+ * each of length len / factors[m - 1], stored one after another.
+ */
+static void hdsp_fft_perm(size_t *perm, size_t p, size_t in_offset, size_t in_stride, size_t len,
+                          size_t *factors, size_t m)
+{
+    size_t r = 0, q = 0;
+
+    if (m == 0) {
+        perm[p] = in_offset;
+        return;
+    }
+
+    r = factors[m - 1];
+    for (q = 0; q < r; q++) {
+        hdsp_fft_perm(perm, p + q * (len / r), in_offset + q * in_stride, in_stride * r, len / r, factors, m - 1);
+    }
+}
+
+/**
+ * Sets length, type and factors of plan (tables are not set).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if length is not supported.
+ */
+static hdsp_status_t hdsp_fft_plan_factorize(hdsp_fft_plan_t *plan, size_t n, hdsp_fft_type_t type)
+{
+    size_t cn = 0;
+
+    if (!plan || n == 0 || (type == HDSP_FFT_TYPE_REAL && n % 2)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+    cn = (type == HDSP_FFT_TYPE_REAL) ? n / 2 : n;
+    if (cn > 1) {
+        plan->n_factors = hdsp_fft_factorize(cn, plan->factors);
+        if (plan->n_factors == 0) {
+            return HDSP_STATUS_FALSE;
+        }
+    }
+    plan->n = n;
+    plan->cn = cn;
+    plan->type = type;
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Fills digit reversal and twiddle tables of factorized plan.
+ */
+static void hdsp_fft_plan_tables(hdsp_fft_plan_t *plan)
+{
+    size_t k = 0, n = plan->n;
+
+    hdsp_fft_perm(plan->perm, 0, 0, 1, plan->cn, plan->factors, plan->n_factors);
+
+    k = 0;
+    while (k < n) {
+        plan->w[2 * k] = cos(2.0 * M_PI * k / n);
+        plan->w[2 * k + 1] = -sin(2.0 * M_PI * k / n);
+        k = k + 1;
+    }
+}
+
+hdsp_status_t hdsp_fft_plan_init(hdsp_fft_plan_t *plan, size_t n, hdsp_fft_type_t type)
+{
+    if (HDSP_STATUS_OK != hdsp_fft_plan_factorize(plan, n, type)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    plan->perm = malloc(plan->cn * sizeof(plan->perm[0]));
+    plan->w = malloc(2 * n * sizeof(plan->w[0]));
+    if (!plan->perm || !plan->w) {
+        hdsp_fft_plan_deinit(plan);
+        return HDSP_STATUS_FALSE;
+    }
+
+    hdsp_fft_plan_tables(plan);
+
+    return HDSP_STATUS_OK;
+}
+
+size_t hdsp_fft_plan_mem_size(size_t n, hdsp_fft_type_t type)
+{
+    size_t cn = (type == HDSP_FFT_TYPE_REAL) ? n / 2 : n;
+
+    return 2 * n * sizeof(double) + cn * sizeof(size_t);
+}
+
+hdsp_status_t hdsp_fft_plan_init_mem(hdsp_fft_plan_t *plan, size_t n, hdsp_fft_type_t type, void *mem, size_t mem_size)
+{
+    if (!mem || mem_size < hdsp_fft_plan_mem_size(n, type)
+        || HDSP_STATUS_OK != hdsp_fft_plan_factorize(plan, n, type)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // twiddles first, so perm is aligned for any mem aligned for double
+    plan->w = mem;
+    plan->perm = (size_t *) (plan->w + 2 * n);
+    plan->mem_external = 1;
+
+    hdsp_fft_plan_tables(plan);
+
+    return HDSP_STATUS_OK;
+}
+
+void hdsp_fft_plan_deinit(hdsp_fft_plan_t *plan)
+{
+    if (!plan) {
+        return;
+    }
+    if (!plan->mem_external) {
+        free(plan->perm);
+        free(plan->w);
+    }
+    plan->mem_external = 0;
+    plan->perm = NULL;
+    plan->w = NULL;
+    plan->n = 0;
+    plan->cn = 0;
+}
+
+/**
+ * Butterflies of all stages, in place on digit reversed data y (cn interleaved complex points).
+ *      sgn - -1.0 for forward, 1.0 for inverse transform
+ */
+static void hdsp_fft_stages(const hdsp_fft_plan_t *plan, double *y, double sgn)
+{
+    const double c3 = sqrt(3.0) / 2.0;
+    const double c51 = cos(2.0 * M_PI / 5.0), c52 = cos(4.0 * M_PI / 5.0);
+    const double s51 = sin(2.0 * M_PI / 5.0), s52 = sin(4.0 * M_PI / 5.0);
+    size_t cn = plan->cn, ws = plan->n / plan->cn;
+    size_t f = 0, r = 0, q = 0, j = 0, base = 0, L = 0, L_prev = 1, w_step = 0, w_idx = 0;
+    double a_re[5], a_im[5];
+    double w_re = 0.0, w_im = 0.0, u = 0.0, v = 0.0;
+    double t0_re, t0_im, t1_re, t1_im, t2_re, t2_im, t3_re, t3_im;
+    double *p = NULL;
+
+    for (f = 0; f < plan->n_factors; f++) {
+        r = plan->factors[f];
+        L = L_prev * r;
+        w_step = (cn / L) * ws;
+        for (j = 0; j < L_prev; j++) {
+            for (base = j; base < cn; base += L) {
+                p = &y[2 * base];
+
+                // twiddle
+                a_re[0] = p[0];
+                a_im[0] = p[1];
+                for (q = 1; q < r; q++) {
+                    w_idx = j * q * w_step;
+                    w_re = plan->w[2 * w_idx];
+                    w_im = -sgn * plan->w[2 * w_idx + 1];
+                    a_re[q] = p[2 * q * L_prev] * w_re - p[2 * q * L_prev + 1] * w_im;
+                    a_im[q] = p[2 * q * L_prev] * w_im + p[2 * q * L_prev + 1] * w_re;
+                }
+
+                // r-point DFT
+                switch (r) {
+                    case 4:
+                        t0_re = a_re[0] + a_re[2]; t0_im = a_im[0] + a_im[2];
+                        t1_re = a_re[0] - a_re[2]; t1_im = a_im[0] - a_im[2];
+                        t2_re = a_re[1] + a_re[3]; t2_im = a_im[1] + a_im[3];
+                        t3_re = a_re[1] - a_re[3]; t3_im = a_im[1] - a_im[3];
+                        p[0] = t0_re + t2_re;
+                        p[1] = t0_im + t2_im;
+                        p[2 * L_prev] = t1_re - sgn * t3_im;
+                        p[2 * L_prev + 1] = t1_im + sgn * t3_re;
+                        p[4 * L_prev] = t0_re - t2_re;
+                        p[4 * L_prev + 1] = t0_im - t2_im;
+                        p[6 * L_prev] = t1_re + sgn * t3_im;
+                        p[6 * L_prev + 1] = t1_im - sgn * t3_re;
+                        break;
+                    case 2:
+                        p[0] = a_re[0] + a_re[1];
+                        p[1] = a_im[0] + a_im[1];
+                        p[2 * L_prev] = a_re[0] - a_re[1];
+                        p[2 * L_prev + 1] = a_im[0] - a_im[1];
+                        break;
+                    case 3:
+                        t0_re = a_re[1] + a_re[2]; t0_im = a_im[1] + a_im[2];
+                        t1_re = c3 * (a_re[1] - a_re[2]); t1_im = c3 * (a_im[1] - a_im[2]);
+                        t2_re = a_re[0] - 0.5 * t0_re; t2_im = a_im[0] - 0.5 * t0_im;
+                        p[0] = a_re[0] + t0_re;
+                        p[1] = a_im[0] + t0_im;
+                        p[2 * L_prev] = t2_re - sgn * t1_im;
+                        p[2 * L_prev + 1] = t2_im + sgn * t1_re;
+                        p[4 * L_prev] = t2_re + sgn * t1_im;
+                        p[4 * L_prev + 1] = t2_im - sgn * t1_re;
+                        break;
+                    case 5:
+                        t0_re = a_re[1] + a_re[4]; t0_im = a_im[1] + a_im[4];
+                        t1_re = a_re[2] + a_re[3]; t1_im = a_im[2] + a_im[3];
+                        t2_re = a_re[1] - a_re[4]; t2_im = a_im[1] - a_im[4];
+                        t3_re = a_re[2] - a_re[3]; t3_im = a_im[2] - a_im[3];
+                        p[0] = a_re[0] + t0_re + t1_re;
+                        p[1] = a_im[0] + t0_im + t1_im;
+                        // X1, X4 = m1 -/+ i n1, X2, X3 = m2 -/+ i n2 (forward)
+                        v = s51 * t2_re + s52 * t3_re;
+                        u = s51 * t2_im + s52 * t3_im;
+                        p[2 * L_prev] = a_re[0] + c51 * t0_re + c52 * t1_re - sgn * u;
+                        p[2 * L_prev + 1] = a_im[0] + c51 * t0_im + c52 * t1_im + sgn * v;
+                        p[8 * L_prev] = a_re[0] + c51 * t0_re + c52 * t1_re + sgn * u;
+                        p[8 * L_prev + 1] = a_im[0] + c51 * t0_im + c52 * t1_im - sgn * v;
+                        v = s52 * t2_re - s51 * t3_re;
+                        u = s52 * t2_im - s51 * t3_im;
+                        p[4 * L_prev] = a_re[0] + c52 * t0_re + c51 * t1_re - sgn * u;
+                        p[4 * L_prev + 1] = a_im[0] + c52 * t0_im + c51 * t1_im + sgn * v;
+                        p[6 * L_prev] = a_re[0] + c52 * t0_re + c51 * t1_re + sgn * u;
+                        p[6 * L_prev + 1] = a_im[0] + c52 * t0_im + c51 * t1_im - sgn * v;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        L_prev = L;
+    }
+}
+
+static hdsp_status_t hdsp_fft_complex(const hdsp_fft_plan_t *plan, double *x, double *y, double sgn)
+{
+    size_t p = 0;
+
+    if (!plan || !plan->w || plan->type != HDSP_FFT_TYPE_COMPLEX || !x || !y || x == y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    for (p = 0; p < plan->cn; p++) {
+        y[2 * p] = x[2 * plan->perm[p]];
+        y[2 * p + 1] = x[2 * plan->perm[p] + 1];
+    }
+    hdsp_fft_stages(plan, y, sgn);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_fft(const hdsp_fft_plan_t *plan, double *x, double *y)
+{
+    return hdsp_fft_complex(plan, x, y, -1.0);
+}
+
+hdsp_status_t hdsp_ifft(const hdsp_fft_plan_t *plan, double *x, double *y)
+{
+    return hdsp_fft_complex(plan, x, y, 1.0);
+}
+
+hdsp_status_t hdsp_fft_real(const hdsp_fft_plan_t *plan, double *x, double *y)
+{
+    size_t p = 0, k = 0, cn = 0;
+    double a_re, a_im, b_re, b_im, e_re, e_im, o_re, o_im, w_re, w_im, t_re, t_im;
+
+    if (!plan || !plan->w || plan->type != HDSP_FFT_TYPE_REAL || !x || !y || x == y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // n real samples are transformed as n/2 complex points z[k] = x[2k] + i x[2k + 1]
+    cn = plan->cn;
+    for (p = 0; p < cn; p++) {
+        y[2 * p] = x[2 * plan->perm[p]];
+        y[2 * p + 1] = x[2 * plan->perm[p] + 1];
+    }
+    hdsp_fft_stages(plan, y, -1.0);
+
+    // split Z into spectra of even (E) and odd (O) samples, X[k] = E[k] + w^k O[k], X[cn - k] = conj(E[k] - w^k O[k])
+    a_re = y[0];
+    a_im = y[1];
+    y[0] = a_re + a_im;
+    y[1] = 0.0;
+    y[2 * cn] = a_re - a_im;
+    y[2 * cn + 1] = 0.0;
+    for (k = 1; k <= cn / 2; k++) {
+        a_re = y[2 * k];
+        a_im = y[2 * k + 1];
+        b_re = y[2 * (cn - k)];
+        b_im = -y[2 * (cn - k) + 1];
+        e_re = 0.5 * (a_re + b_re);
+        e_im = 0.5 * (a_im + b_im);
+        // O = -i(A - B)/2
+        o_re = 0.5 * (a_im - b_im);
+        o_im = -0.5 * (a_re - b_re);
+        w_re = plan->w[2 * k];
+        w_im = plan->w[2 * k + 1];
+        t_re = w_re * o_re - w_im * o_im;
+        t_im = w_re * o_im + w_im * o_re;
+        y[2 * k] = e_re + t_re;
+        y[2 * k + 1] = e_im + t_im;
+        y[2 * (cn - k)] = e_re - t_re;
+        y[2 * (cn - k) + 1] = -(e_im - t_im);
+    }
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_ifft_real(const hdsp_fft_plan_t *plan, double *x, double *y)
+{
+    size_t p = 0, m = 0, cn = 0;
+    double a_re, a_im, b_re, b_im, e_re, e_im, d_re, d_im, o_re, o_im, w_re, w_im;
+
+    if (!plan || !plan->w || plan->type != HDSP_FFT_TYPE_REAL || !x || !y || x == y) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    // Z[m] = E[m] + i O[m], E[m] = X[m] + conj(X[cn - m]), O[m] = (X[m] - conj(X[cn - m])) conj(w^m),
+    // computed while gathering into digit reversed order
+    cn = plan->cn;
+    for (p = 0; p < cn; p++) {
+        m = plan->perm[p];
+        a_re = x[2 * m];
+        a_im = x[2 * m + 1];
+        b_re = x[2 * (cn - m)];
+        b_im = -x[2 * (cn - m) + 1];
+        e_re = a_re + b_re;
+        e_im = a_im + b_im;
+        d_re = a_re - b_re;
+        d_im = a_im - b_im;
+        w_re = plan->w[2 * m];
+        w_im = -plan->w[2 * m + 1];
+        o_re = d_re * w_re - d_im * w_im;
+        o_im = d_re * w_im + d_im * w_re;
+        y[2 * p] = e_re - o_im;
+        y[2 * p + 1] = e_im + o_re;
+    }
+    hdsp_fft_stages(plan, y, 1.0);
+
+    return HDSP_STATUS_OK;
+}
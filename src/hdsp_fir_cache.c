@@ -0,0 +1,445 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_fir_cache.c - Reference counted cache of designed filters
+ */
+
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "hdsp.h"
+
+/**
+ * Designs are kept in chains of hash buckets. Readers walk chains without locking, entries are published
+ * at the head of a chain with release stores and are immutable afterwards, except for reference count
+ * and last use. Reference count is taken with compare-and-swap, an entry is evicted (under lock) by swapping
+ * count 0 for HDSP_FIR_CACHE_DEAD, so it can't be taken anymore, and unlinked from its chain (its own
+ * next pointer is kept, readers standing on it walk on). Unlinked entries are freed once no reader
+ * is in a lookup of their bucket (readers count themselves in and out of the bucket they walk, on the cache
+ * line of its chain head), until then they wait in retired list. Hits of different buckets share no
+ * cache line, nothing cache-wide is written on a hit.
+ * Cache clock ticks (under lock) at every insertion, entries are stamped with it on get and put, so the least
+ * recently used entry is found to the granularity of insertions, which is when entries are evicted.
+ */
+
+#define HDSP_FIR_CACHE_ALIGN 64 // cache line
+#define HDSP_FIR_CACHE_DEAD SIZE_MAX
+
+struct hdsp_fir_cache_entry {
+    hdsp_fir_t fir; // first member, hdsp_fir_cache_put casts filter back to entry
+    hdsp_fir_design_t design;
+    size_t hash;
+    atomic_size_t refs; // HDSP_FIR_CACHE_DEAD once evicted
+    atomic_size_t last_used; // cache clock at last hdsp_fir_cache_get or hdsp_fir_cache_put, relaxed
+    _Atomic(struct hdsp_fir_cache_entry *) next; // next entry in bucket chain
+    struct hdsp_fir_cache_entry *retired_next; // next in retired list
+};
+
+struct hdsp_fir_cache_bucket {
+    _Alignas(HDSP_FIR_CACHE_ALIGN) _Atomic(struct hdsp_fir_cache_entry *) head;
+    atomic_size_t readers; // number of threads walking the chain
+};
+
+struct hdsp_fir_cache {
+    // read-only after create
+    _Alignas(HDSP_FIR_CACHE_ALIGN) size_t capacity;
+    // writers
+    pthread_mutex_t lock; // insertion, eviction and freeing of entries
+    size_t n_entries;
+    struct hdsp_fir_cache_entry *retired; // unlinked entries, freed when there are no readers of their bucket
+    atomic_int has_retired; // retired isn't empty, read by hdsp_fir_cache_put without lock
+    // read by all, written under lock
+    _Alignas(HDSP_FIR_CACHE_ALIGN) atomic_size_t clock; // ticks at every insertion, orders last_used
+    struct hdsp_fir_cache_bucket buckets[HDSP_FIR_CACHE_BUCKETS];
+};
+
+static pthread_once_t hdsp_fir_cache_process_once = PTHREAD_ONCE_INIT;
+static hdsp_fir_cache_t *hdsp_fir_cache_process = NULL;
+
+static void hdsp_fir_cache_process_create(void)
+{
+    hdsp_fir_cache_process = hdsp_fir_cache_create(HDSP_FIR_CACHE_CAPACITY_DEFAULT);
+}
+
+/**
+ * Returns cache, or the process-wide cache if cache is NULL (created on first use).
+ */
+static hdsp_fir_cache_t *hdsp_fir_cache_or_process(hdsp_fir_cache_t *cache)
+{
+    if (cache) {
+        return cache;
+    }
+    pthread_once(&hdsp_fir_cache_process_once, hdsp_fir_cache_process_create);
+    return hdsp_fir_cache_process;
+}
+
+/**
+ * Design with beta cleared unless it's used (by Kaiser window), so equal designs have equal keys.
+ */
+static hdsp_fir_design_t hdsp_fir_cache_key(const hdsp_fir_design_t *design)
+{
+    hdsp_fir_design_t key = {0};
+
+    key.fs_hz = design->fs_hz;
+    key.passband_freq_hz = design->passband_freq_hz;
+    key.n = design->n;
+    key.method = design->method;
+    key.window = design->window;
+    key.beta = (design->window == HDSP_WINDOW_KAISER) ? design->beta : 0.0;
+    return key;
+}
+
+static int hdsp_fir_cache_key_equal(const hdsp_fir_design_t *a, const hdsp_fir_design_t *b)
+{
+    return a->fs_hz == b->fs_hz && a->passband_freq_hz == b->passband_freq_hz && a->n == b->n
+            && a->method == b->method && a->window == b->window && a->beta == b->beta;
+}
+
+/**
+ * FNV-1a hash of key fields.
+ */
+static size_t hdsp_fir_cache_hash(const hdsp_fir_design_t *key)
+{
+    uint64_t fields[6] = {key->fs_hz, key->passband_freq_hz, key->n, key->method, key->window, 0};
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char *p = (const unsigned char *) fields;
+    size_t k = 0;
+
+    memcpy(&fields[5], &key->beta, sizeof(key->beta));
+    while (k < sizeof(fields)) {
+        hash = (hash ^ p[k]) * 1099511628211ull;
+        k = k + 1;
+    }
+    return (size_t) (hash ^ (hash >> 32));
+}
+
+static inline struct hdsp_fir_cache_bucket *hdsp_fir_cache_bucket(hdsp_fir_cache_t *cache, size_t hash)
+{
+    return &cache->buckets[hash & (HDSP_FIR_CACHE_BUCKETS - 1)];
+}
+
+/**
+ * Stamps entry with cache clock, stored only if it changed, so hits between insertions only read.
+ */
+static inline void hdsp_fir_cache_touch(hdsp_fir_cache_t *cache, struct hdsp_fir_cache_entry *e)
+{
+    size_t now = atomic_load_explicit(&cache->clock, memory_order_relaxed);
+
+    if (atomic_load_explicit(&e->last_used, memory_order_relaxed) != now) {
+        atomic_store_explicit(&e->last_used, now, memory_order_relaxed);
+    }
+}
+
+/**
+ * Walks chain of hash for key and takes a reference to its entry. Lock-free, but readers must be counted in
+ * the bucket. Returns entry, or NULL if key isn't cached.
+ */
+static struct hdsp_fir_cache_entry *hdsp_fir_cache_find(hdsp_fir_cache_t *cache, const hdsp_fir_design_t *key,
+                                                        size_t hash)
+{
+    struct hdsp_fir_cache_entry *e = NULL;
+    size_t refs = 0;
+
+    e = atomic_load_explicit(&hdsp_fir_cache_bucket(cache, hash)->head, memory_order_acquire);
+    while (e) {
+        if (e->hash == hash && hdsp_fir_cache_key_equal(&e->design, key)) {
+            refs = atomic_load_explicit(&e->refs, memory_order_relaxed);
+            while (refs != HDSP_FIR_CACHE_DEAD) {
+                if (atomic_compare_exchange_weak_explicit(&e->refs, &refs, refs + 1, memory_order_acquire,
+                                                          memory_order_relaxed)) {
+                    hdsp_fir_cache_touch(cache, e);
+                    return e;
+                }
+            }
+        }
+        e = atomic_load_explicit(&e->next, memory_order_acquire);
+    }
+    return NULL;
+}
+
+static void hdsp_fir_cache_entry_free(struct hdsp_fir_cache_entry *e)
+{
+    hdsp_fir_deinit(&e->fir);
+    free(e);
+}
+
+/**
+ * Evicts entry if it isn't referenced: marks it dead, unlinks it and retires it. Called under lock.
+ * Returns 1 if entry was evicted.
+ */
+static int hdsp_fir_cache_evict(hdsp_fir_cache_t *cache, struct hdsp_fir_cache_entry *e)
+{
+    _Atomic(struct hdsp_fir_cache_entry *) *link = NULL;
+    size_t refs = 0;
+
+    if (!atomic_compare_exchange_strong_explicit(&e->refs, &refs, HDSP_FIR_CACHE_DEAD, memory_order_acquire,
+                                                 memory_order_relaxed)) {
+        return 0;
+    }
+
+    link = &hdsp_fir_cache_bucket(cache, e->hash)->head;
+    while (atomic_load_explicit(link, memory_order_relaxed) != e) {
+        link = &atomic_load_explicit(link, memory_order_relaxed)->next;
+    }
+    atomic_store_explicit(link, atomic_load_explicit(&e->next, memory_order_relaxed), memory_order_release);
+    e->retired_next = cache->retired;
+    cache->retired = e;
+    atomic_store_explicit(&cache->has_retired, 1, memory_order_relaxed);
+    cache->n_entries = cache->n_entries - 1;
+    return 1;
+}
+
+/**
+ * Frees retired entries which no reader is walking the bucket of (readers which counted themselves in later
+ * can't reach them). Called under lock.
+ */
+static void hdsp_fir_cache_reclaim(hdsp_fir_cache_t *cache)
+{
+    struct hdsp_fir_cache_entry *e = NULL, **link = &cache->retired;
+
+    // pairs with fence of readers: either reader is counted, or it walks chain after unlinking
+    atomic_thread_fence(memory_order_seq_cst);
+    while (*link) {
+        e = *link;
+        if (atomic_load_explicit(&hdsp_fir_cache_bucket(cache, e->hash)->readers, memory_order_acquire) == 0) {
+            *link = e->retired_next;
+            hdsp_fir_cache_entry_free(e);
+        } else {
+            link = &e->retired_next;
+        }
+    }
+    atomic_store_explicit(&cache->has_retired, cache->retired != NULL, memory_order_relaxed);
+}
+
+/**
+ * Evicts least recently used unreferenced entries until there is room for one more. Called under lock.
+ */
+static void hdsp_fir_cache_make_room(hdsp_fir_cache_t *cache)
+{
+    struct hdsp_fir_cache_entry *e = NULL, *lru = NULL;
+    size_t k = 0;
+
+    while (cache->n_entries >= cache->capacity) {
+        lru = NULL;
+        for (k = 0; k < HDSP_FIR_CACHE_BUCKETS; k++) {
+            e = atomic_load_explicit(&cache->buckets[k].head, memory_order_relaxed);
+            while (e) {
+                if (atomic_load_explicit(&e->refs, memory_order_relaxed) == 0
+                        && (!lru || atomic_load_explicit(&e->last_used, memory_order_relaxed)
+                                    < atomic_load_explicit(&lru->last_used, memory_order_relaxed))) {
+                    lru = e;
+                }
+                e = atomic_load_explicit(&e->next, memory_order_relaxed);
+            }
+        }
+        // all designs are referenced (cache grows over capacity) or one was just taken
+        if (!lru || !hdsp_fir_cache_evict(cache, lru)) {
+            break;
+        }
+    }
+}
+
+hdsp_fir_cache_t *hdsp_fir_cache_create(size_t capacity)
+{
+    hdsp_fir_cache_t *cache = NULL;
+    void *mem = NULL;
+    size_t k = 0;
+
+    if (capacity == 0) {
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, HDSP_FIR_CACHE_ALIGN, sizeof(*cache)) != 0) {
+        return NULL;
+    }
+    cache = mem;
+    memset(cache, 0, sizeof(*cache));
+    if (pthread_mutex_init(&cache->lock, NULL) != 0) {
+        free(cache);
+        return NULL;
+    }
+    cache->capacity = capacity;
+    cache->n_entries = 0;
+    cache->retired = NULL;
+    atomic_init(&cache->has_retired, 0);
+    atomic_init(&cache->clock, 0);
+    for (k = 0; k < HDSP_FIR_CACHE_BUCKETS; k++) {
+        atomic_init(&cache->buckets[k].head, NULL);
+        atomic_init(&cache->buckets[k].readers, 0);
+    }
+
+    return cache;
+}
+
+void hdsp_fir_cache_destroy(hdsp_fir_cache_t *cache)
+{
+    struct hdsp_fir_cache_entry *e = NULL, *next = NULL;
+    size_t k = 0;
+
+    if (!cache) {
+        return;
+    }
+    for (k = 0; k < HDSP_FIR_CACHE_BUCKETS; k++) {
+        e = atomic_load_explicit(&cache->buckets[k].head, memory_order_relaxed);
+        while (e) {
+            next = atomic_load_explicit(&e->next, memory_order_relaxed);
+            hdsp_fir_cache_entry_free(e);
+            e = next;
+        }
+    }
+    while (cache->retired) {
+        e = cache->retired;
+        cache->retired = e->retired_next;
+        hdsp_fir_cache_entry_free(e);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+const hdsp_fir_t *hdsp_fir_cache_get(hdsp_fir_cache_t *cache, const hdsp_fir_design_t *design)
+{
+    struct hdsp_fir_cache_entry *e = NULL, *found = NULL;
+    struct hdsp_fir_cache_bucket *bucket = NULL;
+    hdsp_filter_t *filter = NULL;
+    hdsp_fir_design_t key;
+    size_t hash = 0;
+
+    cache = hdsp_fir_cache_or_process(cache);
+    if (!cache || !design) {
+        return NULL;
+    }
+    key = hdsp_fir_cache_key(design);
+    hash = hdsp_fir_cache_hash(&key);
+    bucket = hdsp_fir_cache_bucket(cache, hash);
+
+    // hit
+    atomic_fetch_add_explicit(&bucket->readers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    found = hdsp_fir_cache_find(cache, &key, hash);
+    atomic_fetch_sub_explicit(&bucket->readers, 1, memory_order_release);
+    if (found) {
+        return &found->fir;
+    }
+
+    // miss: design out of lock, then insert unless another thread did meanwhile
+    filter = malloc(sizeof(*filter));
+    e = malloc(sizeof(*e));
+    if (!filter || !e || HDSP_STATUS_OK != hdsp_fir_filter_init_design(filter, &key)
+            || HDSP_STATUS_OK != hdsp_fir_init_from_filter(&e->fir, filter)) {
+        free(filter);
+        free(e);
+        return NULL;
+    }
+    free(filter);
+    e->design = key;
+    e->hash = hash;
+    e->retired_next = NULL;
+    atomic_init(&e->refs, 1);
+
+    pthread_mutex_lock(&cache->lock);
+    found = hdsp_fir_cache_find(cache, &key, hash);
+    if (found) {
+        pthread_mutex_unlock(&cache->lock);
+        hdsp_fir_cache_entry_free(e);
+        return &found->fir;
+    }
+    hdsp_fir_cache_make_room(cache);
+    atomic_init(&e->last_used, atomic_fetch_add_explicit(&cache->clock, 1, memory_order_relaxed) + 1);
+    atomic_init(&e->next, atomic_load_explicit(&bucket->head, memory_order_relaxed));
+    atomic_store_explicit(&bucket->head, e, memory_order_release);
+    cache->n_entries = cache->n_entries + 1;
+    hdsp_fir_cache_reclaim(cache);
+    pthread_mutex_unlock(&cache->lock);
+
+    return &e->fir;
+}
+
+void hdsp_fir_cache_put(hdsp_fir_cache_t *cache, const hdsp_fir_t *fir)
+{
+    struct hdsp_fir_cache_entry *e = (struct hdsp_fir_cache_entry *) fir;
+
+    cache = hdsp_fir_cache_or_process(cache);
+    if (!cache || !fir) {
+        return;
+    }
+    hdsp_fir_cache_touch(cache, e);
+    atomic_fetch_sub_explicit(&e->refs, 1, memory_order_release);
+
+    // free entries retired while readers were around, unless another thread holds the lock
+    if (atomic_load_explicit(&cache->has_retired, memory_order_relaxed) && pthread_mutex_trylock(&cache->lock) == 0) {
+        hdsp_fir_cache_reclaim(cache);
+        pthread_mutex_unlock(&cache->lock);
+    }
+}
+
+size_t hdsp_fir_cache_trim(hdsp_fir_cache_t *cache)
+{
+    struct hdsp_fir_cache_entry *e = NULL, *next = NULL;
+    size_t k = 0, n = 0;
+
+    cache = hdsp_fir_cache_or_process(cache);
+    if (!cache) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    for (k = 0; k < HDSP_FIR_CACHE_BUCKETS; k++) {
+        e = atomic_load_explicit(&cache->buckets[k].head, memory_order_relaxed);
+        while (e) {
+            next = atomic_load_explicit(&e->next, memory_order_relaxed);
+            n = n + hdsp_fir_cache_evict(cache, e);
+            e = next;
+        }
+    }
+    hdsp_fir_cache_reclaim(cache);
+    pthread_mutex_unlock(&cache->lock);
+
+    return n;
+}
+
+size_t hdsp_fir_cache_size(hdsp_fir_cache_t *cache)
+{
+    size_t n = 0;
+
+    cache = hdsp_fir_cache_or_process(cache);
+    if (!cache) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    n = cache->n_entries;
+    pthread_mutex_unlock(&cache->lock);
+
+    return n;
+}
@@ -0,0 +1,276 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_ring.c - Lock-free frame rings (single/multi producer, single consumer)
+ */
+
+
+#include <stdatomic.h>
+
+#include "hdsp.h"
+
+/**
+ * Slots are used in turns: slot k holds frames at positions k, k + n_frames, k + 2 n_frames, ...
+ * With many producers each slot has a sequence number (bounded queue of D. Vyukov): seq == pos when
+ * slot is free for position pos, seq == pos + 1 when frame at pos is committed, consumer sets it to
+ * pos + n_frames on release. Producers take positions with compare-and-swap on tail.
+ * Single producer just publishes tail after writing the frame.
+ */
+
+struct hdsp_ring_slot {
+    atomic_size_t seq; // HDSP_RING_MPSC only
+    size_t pos; // position of reserved frame, HDSP_RING_MPSC only
+    size_t len; // bytes committed
+};
+
+#define HDSP_RING_SLOT_HEADER ((sizeof(struct hdsp_ring_slot) + HDSP_RING_ALIGN - 1) / HDSP_RING_ALIGN * HDSP_RING_ALIGN)
+
+struct hdsp_ring {
+    // read-only after create
+    _Alignas(HDSP_RING_ALIGN) hdsp_ring_type_t type;
+    size_t n_frames;
+    size_t mask;
+    size_t frame_size;
+    size_t slot_size; // header and frame, multiple of HDSP_RING_ALIGN
+    unsigned char *slots;
+    // producer(s)
+    _Alignas(HDSP_RING_ALIGN) atomic_size_t tail;
+    size_t head_cache; // consumer's head as last seen by producer, HDSP_RING_SPSC only
+    // consumer
+    _Alignas(HDSP_RING_ALIGN) atomic_size_t head;
+    size_t tail_cache; // producer's tail as last seen by consumer, HDSP_RING_SPSC only
+};
+
+static inline struct hdsp_ring_slot *hdsp_ring_slot(hdsp_ring_t *ring, size_t pos)
+{
+    return (struct hdsp_ring_slot *) (ring->slots + (pos & ring->mask) * ring->slot_size);
+}
+
+static inline void *hdsp_ring_frame(struct hdsp_ring_slot *slot)
+{
+    return (unsigned char *) slot + HDSP_RING_SLOT_HEADER;
+}
+
+hdsp_ring_t *hdsp_ring_create(size_t n_frames, size_t frame_size, hdsp_ring_type_t type)
+{
+    hdsp_ring_t *ring = NULL;
+    void *mem = NULL;
+    size_t n = 1, k = 0;
+
+    if (n_frames == 0 || frame_size == 0 || (type != HDSP_RING_SPSC && type != HDSP_RING_MPSC)) {
+        return NULL;
+    }
+    while (n < n_frames) {
+        n = 2 * n;
+    }
+
+    if (posix_memalign(&mem, HDSP_RING_ALIGN, sizeof(*ring)) != 0) {
+        return NULL;
+    }
+    ring = mem;
+    memset(ring, 0, sizeof(*ring));
+    ring->type = type;
+    ring->n_frames = n;
+    ring->mask = n - 1;
+    ring->frame_size = frame_size;
+    ring->slot_size = HDSP_RING_SLOT_HEADER + (frame_size + HDSP_RING_ALIGN - 1) / HDSP_RING_ALIGN * HDSP_RING_ALIGN;
+    if (posix_memalign(&mem, HDSP_RING_ALIGN, n * ring->slot_size) != 0) {
+        free(ring);
+        return NULL;
+    }
+    ring->slots = mem;
+    for (k = 0; k < n; k++) {
+        atomic_init(&hdsp_ring_slot(ring, k)->seq, k);
+        hdsp_ring_slot(ring, k)->pos = k;
+        hdsp_ring_slot(ring, k)->len = 0;
+    }
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+
+    return ring;
+}
+
+void hdsp_ring_destroy(hdsp_ring_t *ring)
+{
+    if (!ring) {
+        return;
+    }
+    free(ring->slots);
+    free(ring);
+}
+
+size_t hdsp_ring_capacity(hdsp_ring_t *ring)
+{
+    return ring ? ring->n_frames : 0;
+}
+
+void *hdsp_ring_reserve(hdsp_ring_t *ring)
+{
+    struct hdsp_ring_slot *slot = NULL;
+    size_t pos = 0, seq = 0;
+
+    if (!ring) {
+        return NULL;
+    }
+
+    if (ring->type == HDSP_RING_SPSC) {
+        pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        if (pos - ring->head_cache == ring->n_frames) {
+            ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+            if (pos - ring->head_cache == ring->n_frames) {
+                return NULL;
+            }
+        }
+        return hdsp_ring_frame(hdsp_ring_slot(ring, pos));
+    }
+
+    pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while (1) {
+        slot = hdsp_ring_slot(ring, pos);
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == pos) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->pos = pos;
+                return hdsp_ring_frame(slot);
+            }
+            // pos was updated to current tail
+        } else if ((intptr_t) (seq - pos) < 0) {
+            // slot still holds frame from n_frames positions ago, ring is full
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+}
+
+void hdsp_ring_commit(hdsp_ring_t *ring, void *frame, size_t len)
+{
+    struct hdsp_ring_slot *slot = NULL;
+
+    if (!ring || !frame) {
+        return;
+    }
+
+    slot = (struct hdsp_ring_slot *) ((unsigned char *) frame - HDSP_RING_SLOT_HEADER);
+    slot->len = hdsp_min(len, ring->frame_size);
+    if (ring->type == HDSP_RING_SPSC) {
+        atomic_store_explicit(&ring->tail, atomic_load_explicit(&ring->tail, memory_order_relaxed) + 1,
+                              memory_order_release);
+    } else {
+        atomic_store_explicit(&slot->seq, slot->pos + 1, memory_order_release);
+    }
+}
+
+void *hdsp_ring_peek(hdsp_ring_t *ring, size_t *len)
+{
+    struct hdsp_ring_slot *slot = NULL;
+    size_t pos = 0;
+
+    if (!ring) {
+        return NULL;
+    }
+
+    pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    slot = hdsp_ring_slot(ring, pos);
+    if (ring->type == HDSP_RING_SPSC) {
+        if (pos == ring->tail_cache) {
+            ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+            if (pos == ring->tail_cache) {
+                return NULL;
+            }
+        }
+    } else if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) {
+        return NULL;
+    }
+
+    if (len) {
+        *len = slot->len;
+    }
+    return hdsp_ring_frame(slot);
+}
+
+void hdsp_ring_release(hdsp_ring_t *ring)
+{
+    size_t pos = 0;
+
+    if (!ring) {
+        return;
+    }
+
+    pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (ring->type == HDSP_RING_MPSC) {
+        atomic_store_explicit(&hdsp_ring_slot(ring, pos)->seq, pos + ring->n_frames, memory_order_release);
+    }
+    atomic_store_explicit(&ring->head, pos + 1, memory_order_release);
+}
+
+hdsp_status_t hdsp_ring_push(hdsp_ring_t *ring, const void *frame, size_t len)
+{
+    void *slot = NULL;
+
+    if (!ring || !frame || len > ring->frame_size) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    slot = hdsp_ring_reserve(ring);
+    if (!slot) {
+        return HDSP_STATUS_FALSE;
+    }
+    memcpy(slot, frame, len);
+    hdsp_ring_commit(ring, slot, len);
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_status_t hdsp_ring_pop(hdsp_ring_t *ring, void *frame, size_t *len)
+{
+    void *slot = NULL;
+    size_t n = 0;
+
+    if (!ring || !frame) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    slot = hdsp_ring_peek(ring, &n);
+    if (!slot) {
+        return HDSP_STATUS_FALSE;
+    }
+    memcpy(frame, slot, n);
+    hdsp_ring_release(ring);
+    if (len) {
+        *len = n;
+    }
+
+    return HDSP_STATUS_OK;
+}
@@ -0,0 +1,552 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_sched.c - Work-stealing scheduler of per-stream DSP jobs
+ */
+
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "hdsp.h"
+
+/**
+ * Streams are units of scheduling: stream with pending jobs is in exactly one deque (or being run),
+ * so its jobs never run concurrently and run in order. Owner takes streams from the bottom of its deque,
+ * thieves from the top. Worker runs all jobs pending in a stream when it takes it, then gives it back
+ * to the top of the deque if more were submitted meanwhile, so streams of a deque take turns and the stream's lock
+ * and shared counters are touched once per batch of jobs, not per job.
+ * Deques are bounded rings guarded by a mutex (not Chase-Lev deques): streams are pushed to a deque by
+ * submitting threads and to its top by workers, and Chase-Lev allows pushes by the owner only. Each deque
+ * has room for all streams, reserved when a stream is created, so submitting allocates nothing. The lock
+ * is held for a few stores per job, hdspbench sched reports scaling with the number of worker threads.
+ * Workers and counters updated by all workers are aligned to HDSP_RING_ALIGN (a cache line each), so that
+ * deque locks of different workers and the counters don't share cache lines.
+ */
+
+struct hdsp_sched_job {
+    hdsp_sched_fn_t run;
+    hdsp_sched_fn_t done;
+    void *arg;
+};
+
+struct hdsp_sched_stream {
+    hdsp_sched_t *sched;
+    pthread_mutex_t lock;
+    struct hdsp_sched_job *jobs; // ring of pending jobs, first one is being run if scheduled
+    size_t queue_len;
+    size_t head;
+    size_t len;
+    int scheduled; // stream is in a deque or being run
+    size_t home; // worker which deque stream is given to on submit
+    pthread_cond_t drained; // signalled when the last pending job of stream is completed
+};
+
+struct hdsp_sched_deque {
+    pthread_mutex_t lock;
+    hdsp_sched_stream_t **streams; // ring
+    size_t cap;
+    size_t top;
+    size_t len;
+};
+
+struct hdsp_sched_worker {
+    _Alignas(HDSP_RING_ALIGN) hdsp_sched_t *sched;
+    size_t id;
+    pthread_t thread;
+    struct hdsp_sched_deque deque;
+};
+
+struct hdsp_sched {
+    size_t n_threads;
+    struct hdsp_sched_worker *workers;
+    atomic_size_t next_home;
+    atomic_int running;
+    size_t n_streams; // number of streams, each deque has room for all of them, guarded by lock
+    _Alignas(HDSP_RING_ALIGN) atomic_size_t queued; // number of streams in deques
+    _Alignas(HDSP_RING_ALIGN) atomic_size_t pending; // number of submitted and not completed jobs
+    _Alignas(HDSP_RING_ALIGN) atomic_size_t sleeping; // number of workers waiting for work
+    _Alignas(HDSP_RING_ALIGN) pthread_mutex_t lock;
+    pthread_cond_t work; // signalled when stream is queued
+    pthread_cond_t idle; // broadcast when a job is completed and none is pending
+};
+
+static hdsp_status_t hdsp_sched_deque_init(struct hdsp_sched_deque *deque)
+{
+    memset(deque, 0, sizeof(*deque));
+    deque->cap = 64;
+    deque->streams = malloc(deque->cap * sizeof(deque->streams[0]));
+    if (!deque->streams) {
+        return HDSP_STATUS_FALSE;
+    }
+    if (pthread_mutex_init(&deque->lock, NULL) != 0) {
+        free(deque->streams);
+        deque->streams = NULL;
+        return HDSP_STATUS_FALSE;
+    }
+    return HDSP_STATUS_OK;
+}
+
+static void hdsp_sched_deque_deinit(struct hdsp_sched_deque *deque)
+{
+    pthread_mutex_destroy(&deque->lock);
+    free(deque->streams);
+    deque->streams = NULL;
+}
+
+/**
+ * Grows deque to have room for cap streams (called when stream is created, never on submit).
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if out of memory.
+ */
+static hdsp_status_t hdsp_sched_deque_reserve(struct hdsp_sched_deque *deque, size_t cap)
+{
+    hdsp_sched_stream_t **streams = NULL;
+    size_t k = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (cap > deque->cap) {
+        cap = hdsp_max(cap, 2 * deque->cap);
+        streams = malloc(cap * sizeof(streams[0]));
+        if (!streams) {
+            pthread_mutex_unlock(&deque->lock);
+            return HDSP_STATUS_FALSE;
+        }
+        for (k = 0; k < deque->len; k++) {
+            streams[k] = deque->streams[(deque->top + k) % deque->cap];
+        }
+        free(deque->streams);
+        deque->streams = streams;
+        deque->cap = cap;
+        deque->top = 0;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Puts stream to the bottom (or top) of deque.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if deque is full.
+ */
+static hdsp_status_t hdsp_sched_deque_push(struct hdsp_sched_deque *deque, hdsp_sched_stream_t *stream, int top)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->len == deque->cap) {
+        pthread_mutex_unlock(&deque->lock);
+        return HDSP_STATUS_FALSE;
+    }
+    if (top) {
+        deque->top = (deque->top + deque->cap - 1) % deque->cap;
+        deque->streams[deque->top] = stream;
+    } else {
+        deque->streams[(deque->top + deque->len) % deque->cap] = stream;
+    }
+    deque->len = deque->len + 1;
+    pthread_mutex_unlock(&deque->lock);
+
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Takes stream from the bottom (owner) or top (thief) of deque, NULL if deque is empty.
+ */
+static hdsp_sched_stream_t *hdsp_sched_deque_pop(struct hdsp_sched_deque *deque, int top)
+{
+    hdsp_sched_stream_t *stream = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->len > 0) {
+        if (top) {
+            stream = deque->streams[deque->top];
+            deque->top = (deque->top + 1) % deque->cap;
+        } else {
+            stream = deque->streams[(deque->top + deque->len - 1) % deque->cap];
+        }
+        deque->len = deque->len - 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return stream;
+}
+
+/**
+ * Queues stream to deque of worker and wakes up a sleeping worker.
+ * Returns HDSP_STATUS_OK on success, HDSP_STATUS_FALSE if deque is full.
+ */
+static hdsp_status_t hdsp_sched_queue(hdsp_sched_t *sched, size_t worker, hdsp_sched_stream_t *stream, int top)
+{
+    // a stream is in one deque at a time and each deque has room for all streams, so this doesn't fail
+    // unless streams are used after being destroyed
+    if (hdsp_sched_deque_push(&sched->workers[worker].deque, stream, top) != HDSP_STATUS_OK) {
+        return HDSP_STATUS_FALSE;
+    }
+    atomic_fetch_add(&sched->queued, 1);
+    if (atomic_load(&sched->sleeping) > 0) {
+        pthread_mutex_lock(&sched->lock);
+        pthread_cond_signal(&sched->work);
+        pthread_mutex_unlock(&sched->lock);
+    }
+    return HDSP_STATUS_OK;
+}
+
+/**
+ * Takes stream from own deque or steals one from other workers, NULL if there is none.
+ */
+static hdsp_sched_stream_t *hdsp_sched_take(struct hdsp_sched_worker *worker)
+{
+    hdsp_sched_t *sched = worker->sched;
+    hdsp_sched_stream_t *stream = NULL;
+    size_t k = 0;
+
+    stream = hdsp_sched_deque_pop(&worker->deque, 0);
+    for (k = 1; !stream && k < sched->n_threads; k++) {
+        stream = hdsp_sched_deque_pop(&sched->workers[(worker->id + k) % sched->n_threads].deque, 1);
+    }
+    if (stream) {
+        atomic_fetch_sub(&sched->queued, 1);
+    }
+    return stream;
+}
+
+/**
+ * Runs all pending jobs of stream, then gives stream back to the deque if more jobs were submitted meanwhile.
+ * Returns stream if it has more jobs pending and couldn't be given back (worker runs it next), NULL otherwise.
+ */
+static hdsp_sched_stream_t *hdsp_sched_run(struct hdsp_sched_worker *worker, hdsp_sched_stream_t *stream)
+{
+    hdsp_sched_t *sched = worker->sched;
+    struct hdsp_sched_job job = {0};
+    size_t k = 0, n = 0;
+    int more = 0;
+
+    // jobs up to head + n are stored already, submit only adds jobs after them
+    pthread_mutex_lock(&stream->lock);
+    n = stream->len;
+    pthread_mutex_unlock(&stream->lock);
+
+    for (k = 0; k < n; k++) {
+        job = stream->jobs[(stream->head + k) % stream->queue_len];
+        job.run(job.arg);
+        if (job.done) {
+            job.done(job.arg);
+        }
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    stream->head = (stream->head + n) % stream->queue_len;
+    stream->len = stream->len - n;
+    more = (stream->len > 0);
+    stream->scheduled = more;
+    if (!more) {
+        pthread_cond_broadcast(&stream->drained);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    if (more && hdsp_sched_queue(sched, worker->id, stream, 1) == HDSP_STATUS_OK) {
+        more = 0;
+    }
+
+    if (atomic_fetch_sub(&sched->pending, n) == n) {
+        pthread_mutex_lock(&sched->lock);
+        pthread_cond_broadcast(&sched->idle);
+        pthread_mutex_unlock(&sched->lock);
+    }
+
+    return more ? stream : NULL;
+}
+
+static void *hdsp_sched_worker(void *arg)
+{
+    struct hdsp_sched_worker *worker = arg;
+    hdsp_sched_t *sched = worker->sched;
+    hdsp_sched_stream_t *stream = NULL;
+
+    while (1) {
+        stream = hdsp_sched_take(worker);
+        if (stream) {
+            while (stream) {
+                stream = hdsp_sched_run(worker, stream);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&sched->lock);
+        atomic_fetch_add(&sched->sleeping, 1);
+        while (atomic_load(&sched->queued) == 0 && atomic_load(&sched->running)) {
+            pthread_cond_wait(&sched->work, &sched->lock);
+        }
+        atomic_fetch_sub(&sched->sleeping, 1);
+        pthread_mutex_unlock(&sched->lock);
+
+        if (!atomic_load(&sched->running) && atomic_load(&sched->queued) == 0) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+hdsp_sched_t *hdsp_sched_create(size_t n_threads)
+{
+    hdsp_sched_t *sched = NULL;
+    void *mem = NULL;
+    size_t k = 0, started = 0;
+    long n_cpu = 0;
+
+    if (n_threads == 0) {
+        n_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = n_cpu > 0 ? (size_t) n_cpu : 1;
+    }
+
+    if (n_threads > SIZE_MAX / sizeof(sched->workers[0])) {
+        return NULL;
+    }
+
+    // aligned, so that padding of workers and counters matches cache lines
+    if (posix_memalign(&mem, HDSP_RING_ALIGN, sizeof(*sched)) != 0) {
+        return NULL;
+    }
+    sched = memset(mem, 0, sizeof(*sched));
+    if (posix_memalign(&mem, HDSP_RING_ALIGN, n_threads * sizeof(sched->workers[0])) != 0) {
+        free(sched);
+        return NULL;
+    }
+    sched->workers = memset(mem, 0, n_threads * sizeof(sched->workers[0]));
+    sched->n_threads = n_threads;
+    atomic_init(&sched->queued, 0);
+    atomic_init(&sched->pending, 0);
+    atomic_init(&sched->sleeping, 0);
+    atomic_init(&sched->next_home, 0);
+    atomic_init(&sched->running, 1);
+    sched->n_streams = 0;
+    pthread_mutex_init(&sched->lock, NULL);
+    pthread_cond_init(&sched->work, NULL);
+    pthread_cond_init(&sched->idle, NULL);
+
+    for (k = 0; k < n_threads; k++) {
+        sched->workers[k].sched = sched;
+        sched->workers[k].id = k;
+        if (hdsp_sched_deque_init(&sched->workers[k].deque) != HDSP_STATUS_OK) {
+            goto fail;
+        }
+    }
+    for (started = 0; started < n_threads; started++) {
+        if (pthread_create(&sched->workers[started].thread, NULL, hdsp_sched_worker, &sched->workers[started]) != 0) {
+            goto fail;
+        }
+    }
+
+    return sched;
+
+fail:
+    pthread_mutex_lock(&sched->lock);
+    atomic_store(&sched->running, 0);
+    pthread_cond_broadcast(&sched->work);
+    pthread_mutex_unlock(&sched->lock);
+    for (k = 0; k < started; k++) {
+        pthread_join(sched->workers[k].thread, NULL);
+    }
+    for (k = 0; k < n_threads; k++) {
+        if (sched->workers[k].deque.streams) {
+            hdsp_sched_deque_deinit(&sched->workers[k].deque);
+        }
+    }
+    pthread_cond_destroy(&sched->idle);
+    pthread_cond_destroy(&sched->work);
+    pthread_mutex_destroy(&sched->lock);
+    free(sched->workers);
+    free(sched);
+    return NULL;
+}
+
+void hdsp_sched_wait(hdsp_sched_t *sched)
+{
+    if (!sched) {
+        return;
+    }
+
+    pthread_mutex_lock(&sched->lock);
+    while (atomic_load(&sched->pending) > 0) {
+        pthread_cond_wait(&sched->idle, &sched->lock);
+    }
+    pthread_mutex_unlock(&sched->lock);
+}
+
+void hdsp_sched_destroy(hdsp_sched_t *sched)
+{
+    size_t k = 0;
+
+    if (!sched) {
+        return;
+    }
+
+    hdsp_sched_wait(sched);
+
+    pthread_mutex_lock(&sched->lock);
+    atomic_store(&sched->running, 0);
+    pthread_cond_broadcast(&sched->work);
+    pthread_mutex_unlock(&sched->lock);
+
+    for (k = 0; k < sched->n_threads; k++) {
+        pthread_join(sched->workers[k].thread, NULL);
+        hdsp_sched_deque_deinit(&sched->workers[k].deque);
+    }
+    pthread_cond_destroy(&sched->idle);
+    pthread_cond_destroy(&sched->work);
+    pthread_mutex_destroy(&sched->lock);
+    free(sched->workers);
+    free(sched);
+}
+
+size_t hdsp_sched_threads(hdsp_sched_t *sched)
+{
+    return sched ? sched->n_threads : 0;
+}
+
+hdsp_sched_stream_t *hdsp_sched_stream_create(hdsp_sched_t *sched, size_t queue_len)
+{
+    hdsp_sched_stream_t *stream = NULL;
+    size_t k = 0;
+
+    if (!sched || queue_len == 0) {
+        return NULL;
+    }
+
+    stream = calloc(1, sizeof(*stream));
+    if (!stream) {
+        return NULL;
+    }
+    stream->jobs = calloc(queue_len, sizeof(stream->jobs[0]));
+    if (!stream->jobs || pthread_mutex_init(&stream->lock, NULL) != 0) {
+        free(stream->jobs);
+        free(stream);
+        return NULL;
+    }
+    if (pthread_cond_init(&stream->drained, NULL) != 0) {
+        pthread_mutex_destroy(&stream->lock);
+        free(stream->jobs);
+        free(stream);
+        return NULL;
+    }
+
+    // room for the new stream in every deque, so that it can be queued to any of them without allocating
+    pthread_mutex_lock(&sched->lock);
+    for (k = 0; k < sched->n_threads; k++) {
+        if (hdsp_sched_deque_reserve(&sched->workers[k].deque, sched->n_streams + 1) != HDSP_STATUS_OK) {
+            pthread_mutex_unlock(&sched->lock);
+            pthread_cond_destroy(&stream->drained);
+            pthread_mutex_destroy(&stream->lock);
+            free(stream->jobs);
+            free(stream);
+            return NULL;
+        }
+    }
+    sched->n_streams = sched->n_streams + 1;
+    pthread_mutex_unlock(&sched->lock);
+
+    stream->sched = sched;
+    stream->queue_len = queue_len;
+    // streams are spread over workers, a stream stays with its worker unless stolen
+    stream->home = atomic_fetch_add(&sched->next_home, 1) % sched->n_threads;
+
+    return stream;
+}
+
+void hdsp_sched_stream_destroy(hdsp_sched_stream_t *stream)
+{
+    hdsp_sched_t *sched = NULL;
+
+    if (!stream) {
+        return;
+    }
+
+    sched = stream->sched;
+    pthread_mutex_lock(&stream->lock);
+    while (stream->len > 0) {
+        pthread_cond_wait(&stream->drained, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    pthread_mutex_lock(&sched->lock);
+    sched->n_streams = sched->n_streams - 1;
+    pthread_mutex_unlock(&sched->lock);
+
+    pthread_cond_destroy(&stream->drained);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream->jobs);
+    free(stream);
+}
+
+hdsp_status_t hdsp_sched_submit(hdsp_sched_stream_t *stream, hdsp_sched_fn_t run, hdsp_sched_fn_t done, void *arg)
+{
+    hdsp_sched_t *sched = NULL;
+
+    if (!stream || !run) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    sched = stream->sched;
+    pthread_mutex_lock(&stream->lock);
+    if (stream->len == stream->queue_len) {
+        pthread_mutex_unlock(&stream->lock);
+        return HDSP_STATUS_FALSE;
+    }
+    // stream is queued with its lock held, so a worker taking it waits for the job to be stored
+    if (!stream->scheduled && hdsp_sched_queue(sched, stream->home, stream, 0) != HDSP_STATUS_OK) {
+        pthread_mutex_unlock(&stream->lock);
+        return HDSP_STATUS_FALSE;
+    }
+    stream->jobs[(stream->head + stream->len) % stream->queue_len] = (struct hdsp_sched_job) {run, done, arg};
+    stream->len = stream->len + 1;
+    stream->scheduled = 1;
+    atomic_fetch_add(&sched->pending, 1);
+    pthread_mutex_unlock(&stream->lock);
+
+    return HDSP_STATUS_OK;
+}
+
+void hdsp_sched_run_fir(void *arg)
+{
+    hdsp_sched_fir_job_t *job = arg;
+
+    job->status = hdsp_fir_filter_compact(job->x, job->x_len, job->fir, job->y, job->y_len);
+}
+
+void hdsp_sched_run_resample(void *arg)
+{
+    hdsp_sched_resample_job_t *job = arg;
+
+    job->y_written = 0;
+    job->status = hdsp_resample(job->x, job->x_len, job->resampler, job->y, job->y_len, &job->y_written);
+}
@@ -0,0 +1,1601 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_simd.c - SIMD kernels with run time selection of instruction set
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hdsp_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HDSP_SIMD_X86 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HDSP_SIMD_ARM64 1
+#endif
+
+// multiplies per sample at which FFT filtering with context (plan made once) gets faster than direct one,
+// 960 sample frames, as measured by hdspbench crossover on x86-64 (NEON value isn't measured)
+#define HDSP_CONV_FFT_TAPS_MIN_SSE2 48u
+#define HDSP_CONV_FFT_TAPS_MIN_AVX2 64u
+#define HDSP_CONV_FFT_TAPS_MIN_AVX512 160u
+#define HDSP_CONV_FFT_TAPS_MIN_NEON 64u
+
+static double hdsp_dot_rev_i16_f64_scalar(int16_t *x, double *h, size_t n)
+{
+    size_t j = 0;
+    double acc = 0.0;
+
+    for (j = 0; j < n; j++) {
+        acc += x[j] * h[n - 1 - j];
+    }
+    return acc;
+}
+
+static float hdsp_dot_rev_f32_scalar(float *x, float *h, size_t n)
+{
+    size_t j = 0;
+    float acc = 0.0f;
+
+    for (j = 0; j < n; j++) {
+        acc += x[j] * h[n - 1 - j];
+    }
+    return acc;
+}
+
+static int32_t hdsp_dot_i16_i32_scalar(int16_t *x, int16_t *h, size_t n)
+{
+    size_t j = 0;
+    int32_t acc = 0;
+
+    for (j = 0; j < n; j++) {
+        acc += (int32_t) x[j] * h[j];
+    }
+    return acc;
+}
+
+static void hdsp_axpy_i16_f64_scalar(double *y, double a, int16_t *x, size_t n)
+{
+    size_t j = 0;
+
+    for (j = 0; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+static void hdsp_axpy2_i16_f64_scalar(double *y, double a, int16_t *x1, int16_t *x2, size_t n)
+{
+    size_t j = 0;
+
+    for (j = 0; j < n; j++) {
+        y[j] += a * (x1[j] + x2[j]);
+    }
+}
+
+static void hdsp_dot_cols_f64_scalar(double *y, double *h, double *d, size_t n, size_t n_channels)
+{
+    size_t j = 0, c = 0;
+
+    for (c = 0; c < n_channels; c++) {
+        y[c] = 0.0;
+    }
+    for (j = 0; j < n; j++) {
+        for (c = 0; c < n_channels; c++) {
+            y[c] += h[j] * d[j * n_channels + c];
+        }
+    }
+}
+
+/**
+ * Columns c_start, ..., n_channels - 1 of hdsp_dot_cols_f64 (channels left over by vector kernels).
+ */
+static void hdsp_dot_cols_f64_tail(double *y, double *h, double *d, size_t n, size_t n_channels, size_t c_start)
+{
+    size_t j = 0, c = 0;
+    double acc = 0.0;
+
+    for (c = c_start; c < n_channels; c++) {
+        acc = 0.0;
+        for (j = 0; j < n; j++) {
+            acc += h[j] * d[j * n_channels + c];
+        }
+        y[c] = acc;
+    }
+}
+
+/**
+ * Channels c_start, ..., n_channels - 1 of hdsp_dot_cols_i16_f64 (channels left over by vector kernels).
+ */
+static void hdsp_dot_cols_i16_f64_tail(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                       size_t n_channels, size_t c_start)
+{
+    size_t j = 0, c = 0;
+    double acc = 0.0;
+
+    for (c = c_start; c < n_channels; c++) {
+        acc = 0.0;
+        for (j = 0; j < n; j++) {
+            acc += a[j] * (o2 ? x[o1[j] + c] + x[o2[j] + c] : x[o1[j] + c]);
+        }
+        y[c] = acc;
+    }
+}
+
+static void hdsp_dot_cols_i16_f64_scalar(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                         size_t n_channels)
+{
+    hdsp_dot_cols_i16_f64_tail(y, a, x, o1, o2, n, n_channels, 0);
+}
+
+static inline uint32_t hdsp_xorshift32(uint32_t s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+static void hdsp_dither_step(uint32_t *dither)
+{
+    size_t l = 0;
+
+    for (l = 0; l < HDSP_DITHER_LANES; l++) {
+        dither[l] = hdsp_xorshift32(dither[l]);
+    }
+}
+
+/**
+ * Sum of the two 16 bit halves of generator state s, in [0, 131070]. Scaled by 2^-16 and shifted by -1
+ * it is TPDF noise in [-1, 1) (sum of two independent uniform variates), all exact in float and double.
+ */
+static inline uint32_t hdsp_tpdf_sum(uint32_t s)
+{
+    return (s >> 16) + (s & 0xffff);
+}
+
+static void hdsp_cvt_f64_i16_sat_scalar(double *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    size_t j = 0;
+    double v = 0.0;
+
+    for (j = 0; j < n; j++) {
+        v = x[j];
+        if (dither) {
+            if (j % HDSP_DITHER_LANES == 0) {
+                hdsp_dither_step(dither);
+            }
+            v += (double) hdsp_tpdf_sum(dither[j % HDSP_DITHER_LANES]) * (1.0 / 65536) - 1.0;
+        }
+        v = (v == v) ? v : 0.0; // NaN gives 0
+        v = (v > -32768.0) ? v : -32768.0;
+        v = (v < 32767.0) ? v : 32767.0;
+        y[j] = (int16_t) lrint(v);
+    }
+}
+
+static void hdsp_cvt_f32_i16_sat_scalar(float *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    size_t j = 0;
+    float v = 0.0f;
+
+    for (j = 0; j < n; j++) {
+        v = x[j];
+        if (dither) {
+            if (j % HDSP_DITHER_LANES == 0) {
+                hdsp_dither_step(dither);
+            }
+            v += (float) hdsp_tpdf_sum(dither[j % HDSP_DITHER_LANES]) * (1.0f / 65536) - 1.0f;
+        }
+        v = (v == v) ? v : 0.0f;
+        v = (v > -32768.0f) ? v : -32768.0f;
+        v = (v < 32767.0f) ? v : 32767.0f;
+        y[j] = (int16_t) lrintf(v);
+    }
+}
+
+static void hdsp_cvt_f64_i32_sat_scalar(double *x, size_t n, int32_t *y)
+{
+    size_t j = 0;
+    double v = 0.0;
+
+    for (j = 0; j < n; j++) {
+        v = x[j];
+        v = (v == v) ? v : 0.0;
+        v = (v > -2147483648.0) ? v : -2147483648.0;
+        v = (v < 2147483647.0) ? v : 2147483647.0;
+        y[j] = (int32_t) lrint(v);
+    }
+}
+
+static void hdsp_cvt_f32_i32_sat_scalar(float *x, size_t n, int32_t *y)
+{
+    size_t j = 0;
+    float v = 0.0f;
+
+    for (j = 0; j < n; j++) {
+        v = x[j];
+        v = (v == v) ? v : 0.0f;
+        v = (v > -2147483648.0f) ? v : -2147483648.0f;
+        // INT32_MAX isn't a float, 2^31 is the first one out of range
+        y[j] = (v >= 2147483648.0f) ? INT32_MAX : (int32_t) lrintf(v);
+    }
+}
+
+#if HDSP_SIMD_X86
+
+__attribute__((target("sse2")))
+static double hdsp_dot_rev_i16_f64_sse2(int16_t *x, double *h, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd(), v = _mm_setzero_pd(), w = _mm_setzero_pd();
+    __m128i xi = _mm_setzero_si128();
+    double *hr = h + n;
+    double a[2] = {0.0};
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        // 4 samples sign extended to int32, converted to double
+        xi = _mm_loadl_epi64((__m128i *) &x[j]);
+        xi = _mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16);
+        // h[n - 1 - j], h[n - 2 - j], ...
+        v = _mm_loadu_pd(hr - j - 2);
+        w = _mm_loadu_pd(hr - j - 4);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_cvtepi32_pd(xi), _mm_shuffle_pd(v, v, 1)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(xi, _MM_SHUFFLE(1, 0, 3, 2))),
+                                           _mm_shuffle_pd(w, w, 1)));
+    }
+    _mm_storeu_pd(a, _mm_add_pd(acc0, acc1));
+    a[0] += a[1];
+    for (; j < n; j++) {
+        a[0] += x[j] * h[n - 1 - j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx2")))
+static double hdsp_dot_rev_i16_f64_avx2(int16_t *x, double *h, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), v = _mm256_setzero_pd();
+    __m256i x32 = _mm256_setzero_si256();
+    double *hr = h + n;
+    double a[4] = {0.0};
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        x32 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x[j]));
+        v = _mm256_permute4x64_pd(_mm256_loadu_pd(hr - j - 4), 0x1b);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x32)), v));
+        v = _mm256_permute4x64_pd(_mm256_loadu_pd(hr - j - 8), 0x1b);
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x32, 1)), v));
+    }
+    _mm256_storeu_pd(a, _mm256_add_pd(acc0, acc1));
+    a[0] = (a[0] + a[1]) + (a[2] + a[3]);
+    for (; j < n; j++) {
+        a[0] += x[j] * h[n - 1 - j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx512f")))
+static double hdsp_dot_rev_i16_f64_avx512(int16_t *x, double *h, size_t n)
+{
+    const __m512i rev = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd(), v = _mm512_setzero_pd();
+    __m512i x32 = _mm512_setzero_si512();
+    double *hr = h + n;
+    double a = 0.0;
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        x32 = _mm512_cvtepi16_epi32(_mm256_loadu_si256((__m256i *) &x[j]));
+        v = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(hr - j - 8));
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(x32)), v));
+        v = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(hr - j - 16));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x32, 1)), v));
+    }
+    a = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    for (; j < n; j++) {
+        a += x[j] * h[n - 1 - j];
+    }
+    return a;
+}
+
+__attribute__((target("sse2")))
+static float hdsp_dot_rev_f32_sse2(float *x, float *h, size_t n)
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), v = _mm_setzero_ps();
+    float *hr = h + n;
+    float a[4] = {0.0f};
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        v = _mm_loadu_ps(hr - j - 4);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[j]), _mm_shuffle_ps(v, v, 0x1b)));
+        v = _mm_loadu_ps(hr - j - 8);
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&x[j + 4]), _mm_shuffle_ps(v, v, 0x1b)));
+    }
+    _mm_storeu_ps(a, _mm_add_ps(acc0, acc1));
+    a[0] = (a[0] + a[1]) + (a[2] + a[3]);
+    for (; j < n; j++) {
+        a[0] += x[j] * h[n - 1 - j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx2")))
+static float hdsp_dot_rev_f32_avx2(float *x, float *h, size_t n)
+{
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    float *hr = h + n;
+    float a[8] = {0.0f};
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(&x[j]),
+                                                 _mm256_permutevar8x32_ps(_mm256_loadu_ps(hr - j - 8), rev)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(&x[j + 8]),
+                                                 _mm256_permutevar8x32_ps(_mm256_loadu_ps(hr - j - 16), rev)));
+    }
+    _mm256_storeu_ps(a, _mm256_add_ps(acc0, acc1));
+    a[0] = ((a[0] + a[1]) + (a[2] + a[3])) + ((a[4] + a[5]) + (a[6] + a[7]));
+    for (; j < n; j++) {
+        a[0] += x[j] * h[n - 1 - j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx512f")))
+static float hdsp_dot_rev_f32_avx512(float *x, float *h, size_t n)
+{
+    const __m512i rev = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    float *hr = h + n;
+    float a = 0.0f;
+    size_t j = 0;
+
+    for (j = 0; j + 32 <= n; j += 32) {
+        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(_mm512_loadu_ps(&x[j]),
+                                                 _mm512_permutexvar_ps(rev, _mm512_loadu_ps(hr - j - 16))));
+        acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(_mm512_loadu_ps(&x[j + 16]),
+                                                 _mm512_permutexvar_ps(rev, _mm512_loadu_ps(hr - j - 32))));
+    }
+    a = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    for (; j < n; j++) {
+        a += x[j] * h[n - 1 - j];
+    }
+    return a;
+}
+
+__attribute__((target("sse2")))
+static int32_t hdsp_dot_i16_i32_sse2(int16_t *x, int16_t *h, size_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    int32_t a[4] = {0};
+    size_t j = 0;
+
+    // pmaddwd: 8 products, adjacent pairs summed into 4 int32
+    for (j = 0; j + 8 <= n; j += 8) {
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((__m128i *) &x[j]),
+                                                _mm_loadu_si128((__m128i *) &h[j])));
+    }
+    _mm_storeu_si128((__m128i *) a, acc);
+    a[0] = a[0] + a[1] + a[2] + a[3];
+    for (; j < n; j++) {
+        a[0] += (int32_t) x[j] * h[j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx2")))
+static int32_t hdsp_dot_i16_i32_avx2(int16_t *x, int16_t *h, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    int32_t a[8] = {0};
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_loadu_si256((__m256i *) &x[j]),
+                                                      _mm256_loadu_si256((__m256i *) &h[j])));
+    }
+    _mm256_storeu_si256((__m256i *) a, acc);
+    a[0] = a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7];
+    for (; j < n; j++) {
+        a[0] += (int32_t) x[j] * h[j];
+    }
+    return a[0];
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static int32_t hdsp_dot_i16_i32_avx512(int16_t *x, int16_t *h, size_t n)
+{
+    __m512i acc = _mm512_setzero_si512();
+    int32_t a = 0;
+    size_t j = 0;
+
+    for (j = 0; j + 32 <= n; j += 32) {
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(_mm512_loadu_si512((void *) &x[j]),
+                                                      _mm512_loadu_si512((void *) &h[j])));
+    }
+    a = _mm512_reduce_add_epi32(acc);
+    for (; j < n; j++) {
+        a += (int32_t) x[j] * h[j];
+    }
+    return a;
+}
+
+__attribute__((target("sse2")))
+static void hdsp_axpy_i16_f64_sse2(double *y, double a, int16_t *x, size_t n)
+{
+    __m128d av = _mm_set1_pd(a);
+    __m128i xi = _mm_setzero_si128();
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        xi = _mm_loadl_epi64((__m128i *) &x[j]);
+        xi = _mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16);
+        _mm_storeu_pd(&y[j], _mm_add_pd(_mm_loadu_pd(&y[j]), _mm_mul_pd(av, _mm_cvtepi32_pd(xi))));
+        xi = _mm_shuffle_epi32(xi, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm_storeu_pd(&y[j + 2], _mm_add_pd(_mm_loadu_pd(&y[j + 2]), _mm_mul_pd(av, _mm_cvtepi32_pd(xi))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+__attribute__((target("sse2")))
+static void hdsp_axpy2_i16_f64_sse2(double *y, double a, int16_t *x1, int16_t *x2, size_t n)
+{
+    __m128d av = _mm_set1_pd(a);
+    __m128i xi = _mm_setzero_si128(), xj = _mm_setzero_si128();
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        xi = _mm_loadl_epi64((__m128i *) &x1[j]);
+        xj = _mm_loadl_epi64((__m128i *) &x2[j]);
+        xi = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16),
+                           _mm_srai_epi32(_mm_unpacklo_epi16(xj, xj), 16));
+        _mm_storeu_pd(&y[j], _mm_add_pd(_mm_loadu_pd(&y[j]), _mm_mul_pd(av, _mm_cvtepi32_pd(xi))));
+        xi = _mm_shuffle_epi32(xi, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm_storeu_pd(&y[j + 2], _mm_add_pd(_mm_loadu_pd(&y[j + 2]), _mm_mul_pd(av, _mm_cvtepi32_pd(xi))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * (x1[j] + x2[j]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void hdsp_axpy_i16_f64_avx2(double *y, double a, int16_t *x, size_t n)
+{
+    __m256d av = _mm256_set1_pd(a), v0 = _mm256_setzero_pd(), v1 = _mm256_setzero_pd();
+    __m256i x32 = _mm256_setzero_si256();
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        x32 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x[j]));
+        v0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x32));
+        v1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x32, 1));
+        _mm256_storeu_pd(&y[j], _mm256_add_pd(_mm256_loadu_pd(&y[j]), _mm256_mul_pd(av, v0)));
+        _mm256_storeu_pd(&y[j + 4], _mm256_add_pd(_mm256_loadu_pd(&y[j + 4]), _mm256_mul_pd(av, v1)));
+    }
+    for (; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+__attribute__((target("avx2")))
+static void hdsp_axpy2_i16_f64_avx2(double *y, double a, int16_t *x1, int16_t *x2, size_t n)
+{
+    __m256d av = _mm256_set1_pd(a), v0 = _mm256_setzero_pd(), v1 = _mm256_setzero_pd();
+    __m256i x32 = _mm256_setzero_si256();
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        x32 = _mm256_add_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x1[j])),
+                               _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x2[j])));
+        v0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(x32));
+        v1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(x32, 1));
+        _mm256_storeu_pd(&y[j], _mm256_add_pd(_mm256_loadu_pd(&y[j]), _mm256_mul_pd(av, v0)));
+        _mm256_storeu_pd(&y[j + 4], _mm256_add_pd(_mm256_loadu_pd(&y[j + 4]), _mm256_mul_pd(av, v1)));
+    }
+    for (; j < n; j++) {
+        y[j] += a * (x1[j] + x2[j]);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_axpy_i16_f64_avx512(double *y, double a, int16_t *x, size_t n)
+{
+    __m512d av = _mm512_set1_pd(a);
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        __m256i x32 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x[j]));
+        _mm512_storeu_pd(&y[j], _mm512_add_pd(_mm512_loadu_pd(&y[j]), _mm512_mul_pd(av, _mm512_cvtepi32_pd(x32))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_axpy2_i16_f64_avx512(double *y, double a, int16_t *x1, int16_t *x2, size_t n)
+{
+    __m512d av = _mm512_set1_pd(a);
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        __m256i x32 = _mm256_add_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x1[j])),
+                                       _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x2[j])));
+        _mm512_storeu_pd(&y[j], _mm512_add_pd(_mm512_loadu_pd(&y[j]), _mm512_mul_pd(av, _mm512_cvtepi32_pd(x32))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * (x1[j] + x2[j]);
+    }
+}
+
+__attribute__((target("sse2")))
+static inline __m128i hdsp_xorshift32_sse2(__m128i s)
+{
+    s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+    s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+    return _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+}
+
+__attribute__((target("sse2")))
+static inline __m128i hdsp_tpdf_sum_sse2(__m128i s)
+{
+    return _mm_add_epi32(_mm_srli_epi32(s, 16), _mm_and_si128(s, _mm_set1_epi32(0xffff)));
+}
+
+/**
+ * v with NaN lanes set to 0 (converters map NaN to 0, cvt instructions would give INT32_MIN).
+ */
+__attribute__((target("sse2")))
+static inline __m128d hdsp_nan_zero_pd_sse2(__m128d v)
+{
+    return _mm_and_pd(v, _mm_cmpord_pd(v, v));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 hdsp_nan_zero_ps_sse2(__m128 v)
+{
+    return _mm_and_ps(v, _mm_cmpord_ps(v, v));
+}
+
+__attribute__((target("sse2")))
+static void hdsp_cvt_f64_i16_sat_sse2(double *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m128d lo = _mm_set1_pd(-32768.0), hi = _mm_set1_pd(32767.0);
+    const __m128d scale = _mm_set1_pd(1.0 / 65536), one = _mm_set1_pd(1.0);
+    __m128i s[4], d = _mm_setzero_si128(), r[8];
+    __m128d v = _mm_setzero_pd();
+    size_t j = 0, k = 0;
+
+    for (k = 0; k < 4; k++) {
+        s[k] = dither ? _mm_loadu_si128((__m128i *) &dither[4 * k]) : _mm_setzero_si128();
+    }
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 8; k++) {
+            v = _mm_loadu_pd(&x[j + 2 * k]);
+            if (dither) {
+                // lanes 2k, 2k + 1
+                if (k % 2 == 0) {
+                    s[k / 2] = hdsp_xorshift32_sse2(s[k / 2]);
+                    d = hdsp_tpdf_sum_sse2(s[k / 2]);
+                } else {
+                    d = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+                }
+                v = _mm_add_pd(v, _mm_sub_pd(_mm_mul_pd(_mm_cvtepi32_pd(d), scale), one));
+            }
+            r[k] = _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(hdsp_nan_zero_pd_sse2(v), lo), hi));
+        }
+        _mm_storeu_si128((__m128i *) &y[j], _mm_packs_epi32(_mm_unpacklo_epi64(r[0], r[1]),
+                                                            _mm_unpacklo_epi64(r[2], r[3])));
+        _mm_storeu_si128((__m128i *) &y[j + 8], _mm_packs_epi32(_mm_unpacklo_epi64(r[4], r[5]),
+                                                                _mm_unpacklo_epi64(r[6], r[7])));
+    }
+    if (dither) {
+        for (k = 0; k < 4; k++) {
+            _mm_storeu_si128((__m128i *) &dither[4 * k], s[k]);
+        }
+    }
+    hdsp_cvt_f64_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("sse2")))
+static void hdsp_cvt_f32_i16_sat_sse2(float *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m128 lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+    const __m128 scale = _mm_set1_ps(1.0f / 65536), one = _mm_set1_ps(1.0f);
+    __m128i s[4], r[4];
+    __m128 v = _mm_setzero_ps();
+    size_t j = 0, k = 0;
+
+    for (k = 0; k < 4; k++) {
+        s[k] = dither ? _mm_loadu_si128((__m128i *) &dither[4 * k]) : _mm_setzero_si128();
+    }
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 4; k++) {
+            v = _mm_loadu_ps(&x[j + 4 * k]);
+            if (dither) {
+                s[k] = hdsp_xorshift32_sse2(s[k]);
+                v = _mm_add_ps(v, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(hdsp_tpdf_sum_sse2(s[k])), scale), one));
+            }
+            r[k] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(hdsp_nan_zero_ps_sse2(v), lo), hi));
+        }
+        _mm_storeu_si128((__m128i *) &y[j], _mm_packs_epi32(r[0], r[1]));
+        _mm_storeu_si128((__m128i *) &y[j + 8], _mm_packs_epi32(r[2], r[3]));
+    }
+    if (dither) {
+        for (k = 0; k < 4; k++) {
+            _mm_storeu_si128((__m128i *) &dither[4 * k], s[k]);
+        }
+    }
+    hdsp_cvt_f32_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("sse2")))
+static void hdsp_cvt_f64_i32_sat_sse2(double *x, size_t n, int32_t *y)
+{
+    const __m128d lo = _mm_set1_pd(-2147483648.0), hi = _mm_set1_pd(2147483647.0);
+    __m128i r0 = _mm_setzero_si128(), r1 = _mm_setzero_si128();
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        r0 = _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(hdsp_nan_zero_pd_sse2(_mm_loadu_pd(&x[j])), lo), hi));
+        r1 = _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(hdsp_nan_zero_pd_sse2(_mm_loadu_pd(&x[j + 2])), lo), hi));
+        _mm_storeu_si128((__m128i *) &y[j], _mm_unpacklo_epi64(r0, r1));
+    }
+    hdsp_cvt_f64_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("sse2")))
+static void hdsp_cvt_f32_i32_sat_sse2(float *x, size_t n, int32_t *y)
+{
+    const __m128 lo = _mm_set1_ps(-2147483648.0f), big = _mm_set1_ps(2147483648.0f);
+    __m128 v = _mm_setzero_ps();
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        v = _mm_max_ps(hdsp_nan_zero_ps_sse2(_mm_loadu_ps(&x[j])), lo);
+        // cvtps2dq gives INT32_MIN above range, flip it to INT32_MAX
+        _mm_storeu_si128((__m128i *) &y[j], _mm_xor_si128(_mm_cvtps_epi32(v), _mm_castps_si128(_mm_cmpge_ps(v, big))));
+    }
+    hdsp_cvt_f32_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hdsp_xorshift32_avx2(__m256i s)
+{
+    s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+    s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+    return _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hdsp_tpdf_sum_avx2(__m256i s)
+{
+    return _mm256_add_epi32(_mm256_srli_epi32(s, 16), _mm256_and_si256(s, _mm256_set1_epi32(0xffff)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256d hdsp_nan_zero_pd_avx2(__m256d v)
+{
+    return _mm256_and_pd(v, _mm256_cmp_pd(v, v, _CMP_ORD_Q));
+}
+
+__attribute__((target("avx2")))
+static inline __m256 hdsp_nan_zero_ps_avx2(__m256 v)
+{
+    return _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+}
+
+__attribute__((target("avx2")))
+static void hdsp_cvt_f64_i16_sat_avx2(double *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m256d lo = _mm256_set1_pd(-32768.0), hi = _mm256_set1_pd(32767.0);
+    const __m256d scale = _mm256_set1_pd(1.0 / 65536), one = _mm256_set1_pd(1.0);
+    __m256i s[2], d = _mm256_setzero_si256();
+    __m128i r[4];
+    __m256d v = _mm256_setzero_pd();
+    size_t j = 0, k = 0;
+
+    s[0] = dither ? _mm256_loadu_si256((__m256i *) &dither[0]) : _mm256_setzero_si256();
+    s[1] = dither ? _mm256_loadu_si256((__m256i *) &dither[8]) : _mm256_setzero_si256();
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 4; k++) {
+            v = _mm256_loadu_pd(&x[j + 4 * k]);
+            if (dither) {
+                if (k % 2 == 0) {
+                    s[k / 2] = hdsp_xorshift32_avx2(s[k / 2]);
+                    d = hdsp_tpdf_sum_avx2(s[k / 2]);
+                }
+                v = _mm256_add_pd(v, _mm256_sub_pd(_mm256_mul_pd(
+                        _mm256_cvtepi32_pd(k % 2 ? _mm256_extracti128_si256(d, 1) : _mm256_castsi256_si128(d)),
+                        scale), one));
+            }
+            r[k] = _mm256_cvtpd_epi32(_mm256_min_pd(_mm256_max_pd(hdsp_nan_zero_pd_avx2(v), lo), hi));
+        }
+        _mm_storeu_si128((__m128i *) &y[j], _mm_packs_epi32(r[0], r[1]));
+        _mm_storeu_si128((__m128i *) &y[j + 8], _mm_packs_epi32(r[2], r[3]));
+    }
+    if (dither) {
+        _mm256_storeu_si256((__m256i *) &dither[0], s[0]);
+        _mm256_storeu_si256((__m256i *) &dither[8], s[1]);
+    }
+    hdsp_cvt_f64_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("avx2")))
+static void hdsp_cvt_f32_i16_sat_avx2(float *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m256 lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+    const __m256 scale = _mm256_set1_ps(1.0f / 65536), one = _mm256_set1_ps(1.0f);
+    __m256i s[2], r[2];
+    __m256 v = _mm256_setzero_ps();
+    size_t j = 0, k = 0;
+
+    s[0] = dither ? _mm256_loadu_si256((__m256i *) &dither[0]) : _mm256_setzero_si256();
+    s[1] = dither ? _mm256_loadu_si256((__m256i *) &dither[8]) : _mm256_setzero_si256();
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 2; k++) {
+            v = _mm256_loadu_ps(&x[j + 8 * k]);
+            if (dither) {
+                s[k] = hdsp_xorshift32_avx2(s[k]);
+                v = _mm256_add_ps(v, _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(hdsp_tpdf_sum_avx2(s[k])), scale),
+                                                   one));
+            }
+            r[k] = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(hdsp_nan_zero_ps_avx2(v), lo), hi));
+        }
+        // packssdw works within 128 bit halves, put quadwords back in order
+        _mm256_storeu_si256((__m256i *) &y[j], _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xd8));
+    }
+    if (dither) {
+        _mm256_storeu_si256((__m256i *) &dither[0], s[0]);
+        _mm256_storeu_si256((__m256i *) &dither[8], s[1]);
+    }
+    hdsp_cvt_f32_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("avx2")))
+static void hdsp_cvt_f64_i32_sat_avx2(double *x, size_t n, int32_t *y)
+{
+    const __m256d lo = _mm256_set1_pd(-2147483648.0), hi = _mm256_set1_pd(2147483647.0);
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        _mm_storeu_si128((__m128i *) &y[j], _mm256_cvtpd_epi32(_mm256_min_pd(
+                             _mm256_max_pd(hdsp_nan_zero_pd_avx2(_mm256_loadu_pd(&x[j])), lo), hi)));
+        _mm_storeu_si128((__m128i *) &y[j + 4], _mm256_cvtpd_epi32(_mm256_min_pd(
+                             _mm256_max_pd(hdsp_nan_zero_pd_avx2(_mm256_loadu_pd(&x[j + 4])), lo), hi)));
+    }
+    hdsp_cvt_f64_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("avx2")))
+static void hdsp_cvt_f32_i32_sat_avx2(float *x, size_t n, int32_t *y)
+{
+    const __m256 lo = _mm256_set1_ps(-2147483648.0f), big = _mm256_set1_ps(2147483648.0f);
+    __m256 v = _mm256_setzero_ps();
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        v = _mm256_max_ps(hdsp_nan_zero_ps_avx2(_mm256_loadu_ps(&x[j])), lo);
+        _mm256_storeu_si256((__m256i *) &y[j], _mm256_xor_si256(_mm256_cvtps_epi32(v),
+                                                                _mm256_castps_si256(_mm256_cmp_ps(v, big, _CMP_GE_OQ))));
+    }
+    hdsp_cvt_f32_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i hdsp_xorshift32_avx512(__m512i s)
+{
+    s = _mm512_xor_si512(s, _mm512_slli_epi32(s, 13));
+    s = _mm512_xor_si512(s, _mm512_srli_epi32(s, 17));
+    return _mm512_xor_si512(s, _mm512_slli_epi32(s, 5));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i hdsp_tpdf_sum_avx512(__m512i s)
+{
+    return _mm512_add_epi32(_mm512_srli_epi32(s, 16), _mm512_and_si512(s, _mm512_set1_epi32(0xffff)));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d hdsp_nan_zero_pd_avx512(__m512d v)
+{
+    return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(v, v, _CMP_ORD_Q), v);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 hdsp_nan_zero_ps_avx512(__m512 v)
+{
+    return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(v, v, _CMP_ORD_Q), v);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_cvt_f64_i16_sat_avx512(double *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m512d lo = _mm512_set1_pd(-32768.0), hi = _mm512_set1_pd(32767.0);
+    const __m512d scale = _mm512_set1_pd(1.0 / 65536), one = _mm512_set1_pd(1.0);
+    __m512i s = dither ? _mm512_loadu_si512((void *) dither) : _mm512_setzero_si512(), d = _mm512_setzero_si512();
+    __m512d v0 = _mm512_setzero_pd(), v1 = _mm512_setzero_pd();
+    __m256i r0 = _mm256_setzero_si256(), r1 = _mm256_setzero_si256();
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        v0 = _mm512_loadu_pd(&x[j]);
+        v1 = _mm512_loadu_pd(&x[j + 8]);
+        if (dither) {
+            s = hdsp_xorshift32_avx512(s);
+            d = hdsp_tpdf_sum_avx512(s);
+            v0 = _mm512_add_pd(v0, _mm512_sub_pd(_mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(d)), scale),
+                                                 one));
+            v1 = _mm512_add_pd(v1, _mm512_sub_pd(_mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(d, 1)),
+                                                               scale), one));
+        }
+        r0 = _mm512_cvtpd_epi32(_mm512_min_pd(_mm512_max_pd(hdsp_nan_zero_pd_avx512(v0), lo), hi));
+        r1 = _mm512_cvtpd_epi32(_mm512_min_pd(_mm512_max_pd(hdsp_nan_zero_pd_avx512(v1), lo), hi));
+        _mm256_storeu_si256((__m256i *) &y[j],
+                            _mm512_cvtsepi32_epi16(_mm512_inserti64x4(_mm512_castsi256_si512(r0), r1, 1)));
+    }
+    if (dither) {
+        _mm512_storeu_si512((void *) dither, s);
+    }
+    hdsp_cvt_f64_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_cvt_f32_i16_sat_avx512(float *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const __m512 lo = _mm512_set1_ps(-32768.0f), hi = _mm512_set1_ps(32767.0f);
+    const __m512 scale = _mm512_set1_ps(1.0f / 65536), one = _mm512_set1_ps(1.0f);
+    __m512i s = dither ? _mm512_loadu_si512((void *) dither) : _mm512_setzero_si512();
+    __m512 v = _mm512_setzero_ps();
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        v = _mm512_loadu_ps(&x[j]);
+        if (dither) {
+            s = hdsp_xorshift32_avx512(s);
+            v = _mm512_add_ps(v, _mm512_sub_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(hdsp_tpdf_sum_avx512(s)), scale), one));
+        }
+        _mm256_storeu_si256((__m256i *) &y[j],
+                            _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(
+                                _mm512_min_ps(_mm512_max_ps(hdsp_nan_zero_ps_avx512(v), lo), hi))));
+    }
+    if (dither) {
+        _mm512_storeu_si512((void *) dither, s);
+    }
+    hdsp_cvt_f32_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_cvt_f64_i32_sat_avx512(double *x, size_t n, int32_t *y)
+{
+    const __m512d lo = _mm512_set1_pd(-2147483648.0), hi = _mm512_set1_pd(2147483647.0);
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        _mm256_storeu_si256((__m256i *) &y[j], _mm512_cvtpd_epi32(_mm512_min_pd(
+                                _mm512_max_pd(hdsp_nan_zero_pd_avx512(_mm512_loadu_pd(&x[j])), lo), hi)));
+    }
+    hdsp_cvt_f64_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_cvt_f32_i32_sat_avx512(float *x, size_t n, int32_t *y)
+{
+    const __m512 lo = _mm512_set1_ps(-2147483648.0f), big = _mm512_set1_ps(2147483648.0f);
+    __m512 v = _mm512_setzero_ps();
+    size_t j = 0;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        v = _mm512_max_ps(hdsp_nan_zero_ps_avx512(_mm512_loadu_ps(&x[j])), lo);
+        _mm512_storeu_si512((void *) &y[j], _mm512_mask_mov_epi32(_mm512_cvtps_epi32(v),
+                                                                  _mm512_cmp_ps_mask(v, big, _CMP_GE_OQ),
+                                                                  _mm512_set1_epi32(INT32_MAX)));
+    }
+    hdsp_cvt_f32_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+__attribute__((target("sse2")))
+static void hdsp_dot_cols_f64_sse2(double *y, double *h, double *d, size_t n, size_t n_channels)
+{
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t j = 0, c = 0;
+
+    // pairs of channels, tap broadcast to both (stereo frame is one vector)
+    for (c = 0; c + 2 <= n_channels; c += 2) {
+        acc0 = _mm_setzero_pd();
+        acc1 = _mm_setzero_pd();
+        for (j = 0; j + 2 <= n; j += 2) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_set1_pd(h[j]), _mm_loadu_pd(&d[j * n_channels + c])));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_set1_pd(h[j + 1]), _mm_loadu_pd(&d[(j + 1) * n_channels + c])));
+        }
+        for (; j < n; j++) {
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_set1_pd(h[j]), _mm_loadu_pd(&d[j * n_channels + c])));
+        }
+        _mm_storeu_pd(&y[c], _mm_add_pd(acc0, acc1));
+    }
+    hdsp_dot_cols_f64_tail(y, h, d, n, n_channels, c);
+}
+
+__attribute__((target("avx2")))
+static void hdsp_dot_cols_f64_avx2(double *y, double *h, double *d, size_t n, size_t n_channels)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), hv = _mm256_setzero_pd();
+    __m128d acc = _mm_setzero_pd();
+    size_t j = 0, c = 0;
+
+    if (n_channels == 2) {
+        // 2 stereo frames per vector against taps h[j], h[j], h[j + 1], h[j + 1]
+        for (j = 0; j + 4 <= n; j += 4) {
+            hv = _mm256_loadu_pd(&h[j]);
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_permute4x64_pd(hv, 0x50), _mm256_loadu_pd(&d[2 * j])));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_permute4x64_pd(hv, 0xfa), _mm256_loadu_pd(&d[2 * j + 4])));
+        }
+        acc0 = _mm256_add_pd(acc0, acc1);
+        acc = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+        for (; j < n; j++) {
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(h[j]), _mm_loadu_pd(&d[2 * j])));
+        }
+        _mm_storeu_pd(y, acc);
+        return;
+    }
+
+    for (c = 0; c + 4 <= n_channels; c += 4) {
+        acc0 = _mm256_setzero_pd();
+        for (j = 0; j < n; j++) {
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_set1_pd(h[j]), _mm256_loadu_pd(&d[j * n_channels + c])));
+        }
+        _mm256_storeu_pd(&y[c], acc0);
+    }
+    hdsp_dot_cols_f64_tail(y, h, d, n, n_channels, c);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_dot_cols_f64_avx512(double *y, double *h, double *d, size_t n, size_t n_channels)
+{
+    const __m512i pairs = _mm512_set_epi64(3, 3, 2, 2, 1, 1, 0, 0);
+    __m512d acc0 = _mm512_setzero_pd(), hv = _mm512_setzero_pd();
+    __m256d acc4 = _mm256_setzero_pd();
+    __m128d acc = _mm_setzero_pd();
+    size_t j = 0, c = 0;
+
+    if (n_channels == 2) {
+        // 4 stereo frames per vector against taps h[j], h[j], ..., h[j + 3], h[j + 3]
+        for (j = 0; j + 4 <= n; j += 4) {
+            hv = _mm512_permutexvar_pd(pairs, _mm512_castpd256_pd512(_mm256_loadu_pd(&h[j])));
+            acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(hv, _mm512_loadu_pd(&d[2 * j])));
+        }
+        acc4 = _mm256_add_pd(_mm512_castpd512_pd256(acc0), _mm512_extractf64x4_pd(acc0, 1));
+        acc = _mm_add_pd(_mm256_castpd256_pd128(acc4), _mm256_extractf128_pd(acc4, 1));
+        for (; j < n; j++) {
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(h[j]), _mm_loadu_pd(&d[2 * j])));
+        }
+        _mm_storeu_pd(y, acc);
+        return;
+    }
+
+    for (c = 0; c + 8 <= n_channels; c += 8) {
+        acc0 = _mm512_setzero_pd();
+        for (j = 0; j < n; j++) {
+            acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(_mm512_set1_pd(h[j]), _mm512_loadu_pd(&d[j * n_channels + c])));
+        }
+        _mm512_storeu_pd(&y[c], acc0);
+    }
+    for (; c + 4 <= n_channels; c += 4) {
+        acc4 = _mm256_setzero_pd();
+        for (j = 0; j < n; j++) {
+            acc4 = _mm256_add_pd(acc4, _mm256_mul_pd(_mm256_set1_pd(h[j]), _mm256_loadu_pd(&d[j * n_channels + c])));
+        }
+        _mm256_storeu_pd(&y[c], acc4);
+    }
+    hdsp_dot_cols_f64_tail(y, h, d, n, n_channels, c);
+}
+
+__attribute__((target("sse2")))
+static void hdsp_dot_cols_i16_f64_sse2(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                       size_t n_channels)
+{
+    __m128d av = _mm_setzero_pd(), acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd(), acc2 = _mm_setzero_pd(),
+            acc3 = _mm_setzero_pd();
+    __m128i xi = _mm_setzero_si128(), lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    size_t j = 0, c = 0;
+
+    // 8 channels in 4 accumulators, 8 samples loaded per tap (and per mirrored tap)
+    for (c = 0; c + 8 <= n_channels; c += 8) {
+        acc0 = acc1 = acc2 = acc3 = _mm_setzero_pd();
+        for (j = 0; j < n; j++) {
+            xi = _mm_loadu_si128((__m128i *) &x[o1[j] + c]);
+            lo = _mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16);
+            hi = _mm_srai_epi32(_mm_unpackhi_epi16(xi, xi), 16);
+            if (o2) {
+                xi = _mm_loadu_si128((__m128i *) &x[o2[j] + c]);
+                lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(xi, xi), 16));
+                hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(xi, xi), 16));
+            }
+            av = _mm_set1_pd(a[j]);
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(av, _mm_cvtepi32_pd(lo)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(av, _mm_cvtepi32_pd(_mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)))));
+            acc2 = _mm_add_pd(acc2, _mm_mul_pd(av, _mm_cvtepi32_pd(hi)));
+            acc3 = _mm_add_pd(acc3, _mm_mul_pd(av, _mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)))));
+        }
+        _mm_storeu_pd(&y[c], acc0);
+        _mm_storeu_pd(&y[c + 2], acc1);
+        _mm_storeu_pd(&y[c + 4], acc2);
+        _mm_storeu_pd(&y[c + 6], acc3);
+    }
+    hdsp_dot_cols_i16_f64_tail(y, a, x, o1, o2, n, n_channels, c);
+}
+
+__attribute__((target("avx2")))
+static void hdsp_dot_cols_i16_f64_avx2(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                       size_t n_channels)
+{
+    __m256d av = _mm256_setzero_pd(), acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(),
+            acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    __m256i xi = _mm256_setzero_si256(), lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+    __m128i x4 = _mm_setzero_si128();
+    size_t j = 0, c = 0;
+
+    // 16 channels in 4 accumulators, 16 samples loaded per tap (and per mirrored tap)
+    for (c = 0; c + 16 <= n_channels; c += 16) {
+        acc0 = acc1 = acc2 = acc3 = _mm256_setzero_pd();
+        for (j = 0; j < n; j++) {
+            xi = _mm256_loadu_si256((__m256i *) &x[o1[j] + c]);
+            lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(xi));
+            hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(xi, 1));
+            if (o2) {
+                xi = _mm256_loadu_si256((__m256i *) &x[o2[j] + c]);
+                lo = _mm256_add_epi32(lo, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(xi)));
+                hi = _mm256_add_epi32(hi, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(xi, 1)));
+            }
+            av = _mm256_set1_pd(a[j]);
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(av, _mm256_cvtepi32_pd(_mm256_castsi256_si128(lo))));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(av, _mm256_cvtepi32_pd(_mm256_extracti128_si256(lo, 1))));
+            acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(av, _mm256_cvtepi32_pd(_mm256_castsi256_si128(hi))));
+            acc3 = _mm256_add_pd(acc3, _mm256_mul_pd(av, _mm256_cvtepi32_pd(_mm256_extracti128_si256(hi, 1))));
+        }
+        _mm256_storeu_pd(&y[c], acc0);
+        _mm256_storeu_pd(&y[c + 4], acc1);
+        _mm256_storeu_pd(&y[c + 8], acc2);
+        _mm256_storeu_pd(&y[c + 12], acc3);
+    }
+    // 4 channels, e.g. quadraphonic frames
+    for (; c + 4 <= n_channels; c += 4) {
+        acc0 = _mm256_setzero_pd();
+        for (j = 0; j < n; j++) {
+            x4 = _mm_cvtepi16_epi32(_mm_loadl_epi64((__m128i *) &x[o1[j] + c]));
+            if (o2) {
+                x4 = _mm_add_epi32(x4, _mm_cvtepi16_epi32(_mm_loadl_epi64((__m128i *) &x[o2[j] + c])));
+            }
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_set1_pd(a[j]), _mm256_cvtepi32_pd(x4)));
+        }
+        _mm256_storeu_pd(&y[c], acc0);
+    }
+    hdsp_dot_cols_i16_f64_tail(y, a, x, o1, o2, n, n_channels, c);
+}
+
+__attribute__((target("avx512f")))
+static void hdsp_dot_cols_i16_f64_avx512(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                         size_t n_channels)
+{
+    __m512d av = _mm512_setzero_pd(), acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd(),
+            acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+    __m512i xi = _mm512_setzero_si512(), lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+    __m256i x8 = _mm256_setzero_si256();
+    size_t j = 0, c = 0;
+
+    // 32 channels in 4 accumulators, 32 samples (a cache line) loaded per tap (and per mirrored tap)
+    for (c = 0; c + 32 <= n_channels; c += 32) {
+        acc0 = acc1 = acc2 = acc3 = _mm512_setzero_pd();
+        for (j = 0; j < n; j++) {
+            xi = _mm512_loadu_si512((void *) &x[o1[j] + c]);
+            lo = _mm512_cvtepi16_epi32(_mm512_castsi512_si256(xi));
+            hi = _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(xi, 1));
+            if (o2) {
+                xi = _mm512_loadu_si512((void *) &x[o2[j] + c]);
+                lo = _mm512_add_epi32(lo, _mm512_cvtepi16_epi32(_mm512_castsi512_si256(xi)));
+                hi = _mm512_add_epi32(hi, _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(xi, 1)));
+            }
+            av = _mm512_set1_pd(a[j]);
+            acc0 = _mm512_fmadd_pd(av, _mm512_cvtepi32_pd(_mm512_castsi512_si256(lo)), acc0);
+            acc1 = _mm512_fmadd_pd(av, _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(lo, 1)), acc1);
+            acc2 = _mm512_fmadd_pd(av, _mm512_cvtepi32_pd(_mm512_castsi512_si256(hi)), acc2);
+            acc3 = _mm512_fmadd_pd(av, _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(hi, 1)), acc3);
+        }
+        _mm512_storeu_pd(&y[c], acc0);
+        _mm512_storeu_pd(&y[c + 8], acc1);
+        _mm512_storeu_pd(&y[c + 16], acc2);
+        _mm512_storeu_pd(&y[c + 24], acc3);
+    }
+    for (; c + 8 <= n_channels; c += 8) {
+        acc0 = _mm512_setzero_pd();
+        for (j = 0; j < n; j++) {
+            x8 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x[o1[j] + c]));
+            if (o2) {
+                x8 = _mm256_add_epi32(x8, _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) &x[o2[j] + c])));
+            }
+            acc0 = _mm512_fmadd_pd(_mm512_set1_pd(a[j]), _mm512_cvtepi32_pd(x8), acc0);
+        }
+        _mm512_storeu_pd(&y[c], acc0);
+    }
+    hdsp_dot_cols_i16_f64_tail(y, a, x, o1, o2, n, n_channels, c);
+}
+
+#endif // HDSP_SIMD_X86
+
+#if HDSP_SIMD_ARM64
+
+/**
+ * h[-1], h[-2] (two doubles preceding h, reversed).
+ */
+static inline float64x2_t hdsp_load_rev_f64(double *h)
+{
+    float64x2_t v = vld1q_f64(h - 2);
+    return vextq_f64(v, v, 1);
+}
+
+static double hdsp_dot_rev_i16_f64_neon(int16_t *x, double *h, size_t n)
+{
+    float64x2_t acc0 = vdupq_n_f64(0.0), acc1 = vdupq_n_f64(0.0), acc2 = vdupq_n_f64(0.0), acc3 = vdupq_n_f64(0.0);
+    int16x8_t xi;
+    int32x4_t lo, hi;
+    double *hr = h + n;
+    double a = 0.0;
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        xi = vld1q_s16(&x[j]);
+        lo = vmovl_s16(vget_low_s16(xi));
+        hi = vmovl_s16(vget_high_s16(xi));
+        acc0 = vaddq_f64(acc0, vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(lo))), hdsp_load_rev_f64(hr - j)));
+        acc1 = vaddq_f64(acc1, vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(lo))), hdsp_load_rev_f64(hr - j - 2)));
+        acc2 = vaddq_f64(acc2, vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(hi))), hdsp_load_rev_f64(hr - j - 4)));
+        acc3 = vaddq_f64(acc3, vmulq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(hi))), hdsp_load_rev_f64(hr - j - 6)));
+    }
+    a = vaddvq_f64(vaddq_f64(vaddq_f64(acc0, acc1), vaddq_f64(acc2, acc3)));
+    for (; j < n; j++) {
+        a += x[j] * h[n - 1 - j];
+    }
+    return a;
+}
+
+static float hdsp_dot_rev_f32_neon(float *x, float *h, size_t n)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f), v;
+    float *hr = h + n;
+    float a = 0.0f;
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        v = vrev64q_f32(vld1q_f32(hr - j - 4));
+        acc0 = vaddq_f32(acc0, vmulq_f32(vld1q_f32(&x[j]), vextq_f32(v, v, 2)));
+        v = vrev64q_f32(vld1q_f32(hr - j - 8));
+        acc1 = vaddq_f32(acc1, vmulq_f32(vld1q_f32(&x[j + 4]), vextq_f32(v, v, 2)));
+    }
+    a = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; j < n; j++) {
+        a += x[j] * h[n - 1 - j];
+    }
+    return a;
+}
+
+static int32_t hdsp_dot_i16_i32_neon(int16_t *x, int16_t *h, size_t n)
+{
+    int32x4_t acc0 = vdupq_n_s32(0), acc1 = vdupq_n_s32(0);
+    int16x8_t xi, hi;
+    int32_t a = 0;
+    size_t j = 0;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        xi = vld1q_s16(&x[j]);
+        hi = vld1q_s16(&h[j]);
+        acc0 = vmlal_s16(acc0, vget_low_s16(xi), vget_low_s16(hi));
+        acc1 = vmlal_s16(acc1, vget_high_s16(xi), vget_high_s16(hi));
+    }
+    a = vaddvq_s32(vaddq_s32(acc0, acc1));
+    for (; j < n; j++) {
+        a += (int32_t) x[j] * h[j];
+    }
+    return a;
+}
+
+static void hdsp_axpy_i16_f64_neon(double *y, double a, int16_t *x, size_t n)
+{
+    float64x2_t av = vdupq_n_f64(a);
+    int32x4_t x32;
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        x32 = vmovl_s16(vld1_s16(&x[j]));
+        vst1q_f64(&y[j], vfmaq_f64(vld1q_f64(&y[j]), av, vcvtq_f64_s64(vmovl_s32(vget_low_s32(x32)))));
+        vst1q_f64(&y[j + 2], vfmaq_f64(vld1q_f64(&y[j + 2]), av, vcvtq_f64_s64(vmovl_s32(vget_high_s32(x32)))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * x[j];
+    }
+}
+
+static void hdsp_axpy2_i16_f64_neon(double *y, double a, int16_t *x1, int16_t *x2, size_t n)
+{
+    float64x2_t av = vdupq_n_f64(a);
+    int32x4_t x32;
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        x32 = vaddl_s16(vld1_s16(&x1[j]), vld1_s16(&x2[j]));
+        vst1q_f64(&y[j], vfmaq_f64(vld1q_f64(&y[j]), av, vcvtq_f64_s64(vmovl_s32(vget_low_s32(x32)))));
+        vst1q_f64(&y[j + 2], vfmaq_f64(vld1q_f64(&y[j + 2]), av, vcvtq_f64_s64(vmovl_s32(vget_high_s32(x32)))));
+    }
+    for (; j < n; j++) {
+        y[j] += a * (x1[j] + x2[j]);
+    }
+}
+
+static void hdsp_dot_cols_i16_f64_neon(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                       size_t n_channels)
+{
+    float64x2_t av, acc0, acc1, acc2, acc3;
+    int16x8_t xi, xm;
+    int32x4_t lo, hi;
+    size_t j = 0, c = 0;
+
+    // 8 channels in 4 accumulators, 8 samples loaded per tap (and per mirrored tap)
+    for (c = 0; c + 8 <= n_channels; c += 8) {
+        acc0 = acc1 = acc2 = acc3 = vdupq_n_f64(0.0);
+        for (j = 0; j < n; j++) {
+            xi = vld1q_s16(&x[o1[j] + c]);
+            if (o2) {
+                xm = vld1q_s16(&x[o2[j] + c]);
+                lo = vaddl_s16(vget_low_s16(xi), vget_low_s16(xm));
+                hi = vaddl_s16(vget_high_s16(xi), vget_high_s16(xm));
+            } else {
+                lo = vmovl_s16(vget_low_s16(xi));
+                hi = vmovl_s16(vget_high_s16(xi));
+            }
+            av = vdupq_n_f64(a[j]);
+            acc0 = vfmaq_f64(acc0, av, vcvtq_f64_s64(vmovl_s32(vget_low_s32(lo))));
+            acc1 = vfmaq_f64(acc1, av, vcvtq_f64_s64(vmovl_s32(vget_high_s32(lo))));
+            acc2 = vfmaq_f64(acc2, av, vcvtq_f64_s64(vmovl_s32(vget_low_s32(hi))));
+            acc3 = vfmaq_f64(acc3, av, vcvtq_f64_s64(vmovl_s32(vget_high_s32(hi))));
+        }
+        vst1q_f64(&y[c], acc0);
+        vst1q_f64(&y[c + 2], acc1);
+        vst1q_f64(&y[c + 4], acc2);
+        vst1q_f64(&y[c + 6], acc3);
+    }
+    hdsp_dot_cols_i16_f64_tail(y, a, x, o1, o2, n, n_channels, c);
+}
+
+static inline uint32x4_t hdsp_xorshift32_neon(uint32x4_t s)
+{
+    s = veorq_u32(s, vshlq_n_u32(s, 13));
+    s = veorq_u32(s, vshrq_n_u32(s, 17));
+    return veorq_u32(s, vshlq_n_u32(s, 5));
+}
+
+static inline uint32x4_t hdsp_tpdf_sum_neon(uint32x4_t s)
+{
+    return vaddq_u32(vshrq_n_u32(s, 16), vandq_u32(s, vdupq_n_u32(0xffff)));
+}
+
+/**
+ * Two doubles rounded to nearest, saturated to [lo, hi] (vmax/vmin keep NaN, fcvtns converts it to 0).
+ */
+static inline int32x2_t hdsp_cvt_f64_i32_neon(float64x2_t v, float64x2_t lo, float64x2_t hi)
+{
+    return vmovn_s64(vcvtnq_s64_f64(vminq_f64(vmaxq_f64(v, lo), hi)));
+}
+
+static void hdsp_cvt_f64_i16_sat_neon(double *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const float64x2_t lo = vdupq_n_f64(-32768.0), hi = vdupq_n_f64(32767.0);
+    uint32x4_t s[4], d;
+    int32x4_t r[4];
+    float64x2_t v0, v1;
+    size_t j = 0, k = 0;
+
+    for (k = 0; k < 4; k++) {
+        s[k] = dither ? vld1q_u32(&dither[4 * k]) : vdupq_n_u32(0);
+    }
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 4; k++) {
+            v0 = vld1q_f64(&x[j + 4 * k]);
+            v1 = vld1q_f64(&x[j + 4 * k + 2]);
+            if (dither) {
+                s[k] = hdsp_xorshift32_neon(s[k]);
+                d = hdsp_tpdf_sum_neon(s[k]);
+                v0 = vaddq_f64(v0, vsubq_f64(vmulq_n_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(d))), 1.0 / 65536),
+                                             vdupq_n_f64(1.0)));
+                v1 = vaddq_f64(v1, vsubq_f64(vmulq_n_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(d))), 1.0 / 65536),
+                                             vdupq_n_f64(1.0)));
+            }
+            r[k] = vcombine_s32(hdsp_cvt_f64_i32_neon(v0, lo, hi), hdsp_cvt_f64_i32_neon(v1, lo, hi));
+        }
+        vst1q_s16(&y[j], vcombine_s16(vqmovn_s32(r[0]), vqmovn_s32(r[1])));
+        vst1q_s16(&y[j + 8], vcombine_s16(vqmovn_s32(r[2]), vqmovn_s32(r[3])));
+    }
+    if (dither) {
+        for (k = 0; k < 4; k++) {
+            vst1q_u32(&dither[4 * k], s[k]);
+        }
+    }
+    hdsp_cvt_f64_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+static void hdsp_cvt_f32_i16_sat_neon(float *x, size_t n, int16_t *y, uint32_t *dither)
+{
+    const float32x4_t lo = vdupq_n_f32(-32768.0f), hi = vdupq_n_f32(32767.0f);
+    uint32x4_t s[4];
+    int32x4_t r[4];
+    float32x4_t v;
+    size_t j = 0, k = 0;
+
+    for (k = 0; k < 4; k++) {
+        s[k] = dither ? vld1q_u32(&dither[4 * k]) : vdupq_n_u32(0);
+    }
+    for (j = 0; j + 16 <= n; j += 16) {
+        for (k = 0; k < 4; k++) {
+            v = vld1q_f32(&x[j + 4 * k]);
+            if (dither) {
+                s[k] = hdsp_xorshift32_neon(s[k]);
+                v = vaddq_f32(v, vsubq_f32(vmulq_n_f32(vcvtq_f32_u32(hdsp_tpdf_sum_neon(s[k])), 1.0f / 65536),
+                                           vdupq_n_f32(1.0f)));
+            }
+            r[k] = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(v, lo), hi));
+        }
+        vst1q_s16(&y[j], vcombine_s16(vqmovn_s32(r[0]), vqmovn_s32(r[1])));
+        vst1q_s16(&y[j + 8], vcombine_s16(vqmovn_s32(r[2]), vqmovn_s32(r[3])));
+    }
+    if (dither) {
+        for (k = 0; k < 4; k++) {
+            vst1q_u32(&dither[4 * k], s[k]);
+        }
+    }
+    hdsp_cvt_f32_i16_sat_scalar(&x[j], n - j, &y[j], dither);
+}
+
+static void hdsp_cvt_f64_i32_sat_neon(double *x, size_t n, int32_t *y)
+{
+    const float64x2_t lo = vdupq_n_f64(-2147483648.0), hi = vdupq_n_f64(2147483647.0);
+    size_t j = 0;
+
+    for (j = 0; j + 4 <= n; j += 4) {
+        vst1q_s32(&y[j], vcombine_s32(hdsp_cvt_f64_i32_neon(vld1q_f64(&x[j]), lo, hi),
+                                      hdsp_cvt_f64_i32_neon(vld1q_f64(&x[j + 2]), lo, hi)));
+    }
+    hdsp_cvt_f64_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+static void hdsp_cvt_f32_i32_sat_neon(float *x, size_t n, int32_t *y)
+{
+    size_t j = 0;
+
+    // fcvtns saturates and converts NaN to 0
+    for (j = 0; j + 4 <= n; j += 4) {
+        vst1q_s32(&y[j], vcvtnq_s32_f32(vld1q_f32(&x[j])));
+    }
+    hdsp_cvt_f32_i32_sat_scalar(&x[j], n - j, &y[j]);
+}
+
+static void hdsp_dot_cols_f64_neon(double *y, double *h, double *d, size_t n, size_t n_channels)
+{
+    float64x2_t acc0, acc1;
+    size_t j = 0, c = 0;
+
+    for (c = 0; c + 2 <= n_channels; c += 2) {
+        acc0 = vdupq_n_f64(0.0);
+        acc1 = vdupq_n_f64(0.0);
+        for (j = 0; j + 2 <= n; j += 2) {
+            acc0 = vfmaq_n_f64(acc0, vld1q_f64(&d[j * n_channels + c]), h[j]);
+            acc1 = vfmaq_n_f64(acc1, vld1q_f64(&d[(j + 1) * n_channels + c]), h[j + 1]);
+        }
+        for (; j < n; j++) {
+            acc0 = vfmaq_n_f64(acc0, vld1q_f64(&d[j * n_channels + c]), h[j]);
+        }
+        vst1q_f64(&y[c], vaddq_f64(acc0, acc1));
+    }
+    hdsp_dot_cols_f64_tail(y, h, d, n, n_channels, c);
+}
+
+#endif // HDSP_SIMD_ARM64
+
+double (*hdsp_dot_rev_i16_f64)(int16_t *x, double *h, size_t n) = hdsp_dot_rev_i16_f64_scalar;
+float (*hdsp_dot_rev_f32)(float *x, float *h, size_t n) = hdsp_dot_rev_f32_scalar;
+int32_t (*hdsp_dot_i16_i32)(int16_t *x, int16_t *h, size_t n) = hdsp_dot_i16_i32_scalar;
+void (*hdsp_axpy_i16_f64)(double *y, double a, int16_t *x, size_t n) = hdsp_axpy_i16_f64_scalar;
+void (*hdsp_axpy2_i16_f64)(double *y, double a, int16_t *x1, int16_t *x2, size_t n) = hdsp_axpy2_i16_f64_scalar;
+void (*hdsp_dot_cols_f64)(double *y, double *h, double *d, size_t n, size_t n_channels) = hdsp_dot_cols_f64_scalar;
+void (*hdsp_dot_cols_i16_f64)(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                              size_t n_channels) = hdsp_dot_cols_i16_f64_scalar;
+void (*hdsp_cvt_f64_i16_sat)(double *x, size_t n, int16_t *y, uint32_t *dither) = hdsp_cvt_f64_i16_sat_scalar;
+void (*hdsp_cvt_f32_i16_sat)(float *x, size_t n, int16_t *y, uint32_t *dither) = hdsp_cvt_f32_i16_sat_scalar;
+void (*hdsp_cvt_f64_i32_sat)(double *x, size_t n, int32_t *y) = hdsp_cvt_f64_i32_sat_scalar;
+void (*hdsp_cvt_f32_i32_sat)(float *x, size_t n, int32_t *y) = hdsp_cvt_f32_i32_sat_scalar;
+size_t hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN;
+static hdsp_simd_t hdsp_simd = HDSP_SIMD_NONE;
+
+static int hdsp_simd_supported(hdsp_simd_t isa)
+{
+    switch (isa) {
+        case HDSP_SIMD_NONE:
+            return 1;
+#if HDSP_SIMD_X86
+        case HDSP_SIMD_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case HDSP_SIMD_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case HDSP_SIMD_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+#if HDSP_SIMD_ARM64
+        case HDSP_SIMD_NEON:
+            return 1;
+#endif
+        default:
+            return 0;
+    }
+}
+
+hdsp_status_t hdsp_simd_set(hdsp_simd_t isa)
+{
+    if (!hdsp_simd_supported(isa)) {
+        return HDSP_STATUS_FALSE;
+    }
+
+    switch (isa) {
+#if HDSP_SIMD_X86
+        case HDSP_SIMD_SSE2:
+            hdsp_dot_rev_i16_f64 = hdsp_dot_rev_i16_f64_sse2;
+            hdsp_dot_rev_f32 = hdsp_dot_rev_f32_sse2;
+            hdsp_axpy_i16_f64 = hdsp_axpy_i16_f64_sse2;
+            hdsp_axpy2_i16_f64 = hdsp_axpy2_i16_f64_sse2;
+            hdsp_dot_i16_i32 = hdsp_dot_i16_i32_sse2;
+            hdsp_dot_cols_f64 = hdsp_dot_cols_f64_sse2;
+            hdsp_dot_cols_i16_f64 = hdsp_dot_cols_i16_f64_sse2;
+            hdsp_cvt_f64_i16_sat = hdsp_cvt_f64_i16_sat_sse2;
+            hdsp_cvt_f32_i16_sat = hdsp_cvt_f32_i16_sat_sse2;
+            hdsp_cvt_f64_i32_sat = hdsp_cvt_f64_i32_sat_sse2;
+            hdsp_cvt_f32_i32_sat = hdsp_cvt_f32_i32_sat_sse2;
+            hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN_SSE2;
+            break;
+        case HDSP_SIMD_AVX2:
+            hdsp_dot_rev_i16_f64 = hdsp_dot_rev_i16_f64_avx2;
+            hdsp_dot_rev_f32 = hdsp_dot_rev_f32_avx2;
+            hdsp_axpy_i16_f64 = hdsp_axpy_i16_f64_avx2;
+            hdsp_axpy2_i16_f64 = hdsp_axpy2_i16_f64_avx2;
+            hdsp_dot_i16_i32 = hdsp_dot_i16_i32_avx2;
+            hdsp_dot_cols_f64 = hdsp_dot_cols_f64_avx2;
+            hdsp_dot_cols_i16_f64 = hdsp_dot_cols_i16_f64_avx2;
+            hdsp_cvt_f64_i16_sat = hdsp_cvt_f64_i16_sat_avx2;
+            hdsp_cvt_f32_i16_sat = hdsp_cvt_f32_i16_sat_avx2;
+            hdsp_cvt_f64_i32_sat = hdsp_cvt_f64_i32_sat_avx2;
+            hdsp_cvt_f32_i32_sat = hdsp_cvt_f32_i32_sat_avx2;
+            hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN_AVX2;
+            break;
+        case HDSP_SIMD_AVX512:
+            hdsp_dot_rev_i16_f64 = hdsp_dot_rev_i16_f64_avx512;
+            hdsp_dot_rev_f32 = hdsp_dot_rev_f32_avx512;
+            hdsp_axpy_i16_f64 = hdsp_axpy_i16_f64_avx512;
+            hdsp_axpy2_i16_f64 = hdsp_axpy2_i16_f64_avx512;
+            // integer multiply-add of 512 bit vectors needs AVX-512BW
+            hdsp_dot_i16_i32 = __builtin_cpu_supports("avx512bw") ? hdsp_dot_i16_i32_avx512 : hdsp_dot_i16_i32_avx2;
+            hdsp_dot_cols_f64 = hdsp_dot_cols_f64_avx512;
+            hdsp_dot_cols_i16_f64 = hdsp_dot_cols_i16_f64_avx512;
+            hdsp_cvt_f64_i16_sat = hdsp_cvt_f64_i16_sat_avx512;
+            hdsp_cvt_f32_i16_sat = hdsp_cvt_f32_i16_sat_avx512;
+            hdsp_cvt_f64_i32_sat = hdsp_cvt_f64_i32_sat_avx512;
+            hdsp_cvt_f32_i32_sat = hdsp_cvt_f32_i32_sat_avx512;
+            hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN_AVX512;
+            break;
+#endif
+#if HDSP_SIMD_ARM64
+        case HDSP_SIMD_NEON:
+            hdsp_dot_rev_i16_f64 = hdsp_dot_rev_i16_f64_neon;
+            hdsp_dot_rev_f32 = hdsp_dot_rev_f32_neon;
+            hdsp_axpy_i16_f64 = hdsp_axpy_i16_f64_neon;
+            hdsp_axpy2_i16_f64 = hdsp_axpy2_i16_f64_neon;
+            hdsp_dot_i16_i32 = hdsp_dot_i16_i32_neon;
+            hdsp_dot_cols_f64 = hdsp_dot_cols_f64_neon;
+            hdsp_dot_cols_i16_f64 = hdsp_dot_cols_i16_f64_neon;
+            hdsp_cvt_f64_i16_sat = hdsp_cvt_f64_i16_sat_neon;
+            hdsp_cvt_f32_i16_sat = hdsp_cvt_f32_i16_sat_neon;
+            hdsp_cvt_f64_i32_sat = hdsp_cvt_f64_i32_sat_neon;
+            hdsp_cvt_f32_i32_sat = hdsp_cvt_f32_i32_sat_neon;
+            hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN_NEON;
+            break;
+#endif
+        case HDSP_SIMD_NONE:
+        default:
+            hdsp_dot_rev_i16_f64 = hdsp_dot_rev_i16_f64_scalar;
+            hdsp_dot_rev_f32 = hdsp_dot_rev_f32_scalar;
+            hdsp_axpy_i16_f64 = hdsp_axpy_i16_f64_scalar;
+            hdsp_axpy2_i16_f64 = hdsp_axpy2_i16_f64_scalar;
+            hdsp_dot_i16_i32 = hdsp_dot_i16_i32_scalar;
+            hdsp_dot_cols_f64 = hdsp_dot_cols_f64_scalar;
+            hdsp_dot_cols_i16_f64 = hdsp_dot_cols_i16_f64_scalar;
+            hdsp_cvt_f64_i16_sat = hdsp_cvt_f64_i16_sat_scalar;
+            hdsp_cvt_f32_i16_sat = hdsp_cvt_f32_i16_sat_scalar;
+            hdsp_cvt_f64_i32_sat = hdsp_cvt_f64_i32_sat_scalar;
+            hdsp_cvt_f32_i32_sat = hdsp_cvt_f32_i32_sat_scalar;
+            hdsp_conv_fft_taps_min = HDSP_CONV_FFT_TAPS_MIN;
+            break;
+    }
+    hdsp_simd = isa;
+
+    return HDSP_STATUS_OK;
+}
+
+hdsp_simd_t hdsp_simd_get(void)
+{
+    return hdsp_simd;
+}
+
+/**
+ * Select kernels once, when library is loaded: instruction set forced at configure time (--enable-simd=ISA)
+ * or the best one supported by the CPU.
+ */
+__attribute__((constructor))
+static void hdsp_simd_init(void)
+{
+#if HDSP_SIMD_X86
+    __builtin_cpu_init();
+#endif
+
+#ifdef HDSP_SIMD_FORCE
+    hdsp_simd_set(HDSP_SIMD_FORCE);
+#else
+    if (HDSP_STATUS_OK == hdsp_simd_set(HDSP_SIMD_AVX512)) {
+        return;
+    }
+    if (HDSP_STATUS_OK == hdsp_simd_set(HDSP_SIMD_AVX2)) {
+        return;
+    }
+    if (HDSP_STATUS_OK == hdsp_simd_set(HDSP_SIMD_SSE2)) {
+        return;
+    }
+    if (HDSP_STATUS_OK == hdsp_simd_set(HDSP_SIMD_NEON)) {
+        return;
+    }
+#endif
+}
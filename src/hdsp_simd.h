@@ -0,0 +1,108 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdsp_simd.h - SIMD kernels (internal)
+ */
+
+
+#ifndef LHDSP_SIMD_H
+#define LHDSP_SIMD_H
+
+
+#include <stddef.h>
+
+#include "hdsp.h"
+
+/**
+ * Dot product of x and reversed h: Sum{x[j]h[n - 1 - j]}, j = 0, ..., n - 1.
+ * Points to the kernel of selected instruction set (see hdsp_simd_set).
+ */
+extern double (*hdsp_dot_rev_i16_f64)(int16_t *x, double *h, size_t n);
+
+/**
+ * Single precision dot product of x and reversed h: Sum{x[j]h[n - 1 - j]}, j = 0, ..., n - 1.
+ */
+extern float (*hdsp_dot_rev_f32)(float *x, float *h, size_t n);
+
+/**
+ * Integer dot product of x and h: Sum{x[j]h[j]}, j = 0, ..., n - 1, accumulated in int32
+ * (caller makes sure it doesn't overflow).
+ */
+extern int32_t (*hdsp_dot_i16_i32)(int16_t *x, int16_t *h, size_t n);
+
+/**
+ * y[j] += a * x[j], j = 0, ..., n - 1 (one tap applied to a row of channels).
+ */
+extern void (*hdsp_axpy_i16_f64)(double *y, double a, int16_t *x, size_t n);
+
+/**
+ * y[j] += a * (x1[j] + x2[j]), j = 0, ..., n - 1 (pair of mirrored taps of symmetric filter applied to a block).
+ */
+extern void (*hdsp_axpy2_i16_f64)(double *y, double a, int16_t *x1, int16_t *x2, size_t n);
+
+/**
+ * Dot product of h with each channel of n interleaved frames d (frame j is d[j * n_channels], ...):
+ * y[c] = Sum{h[j]d[j * n_channels + c]}, j = 0, ..., n - 1, c = 0, ..., n_channels - 1.
+ */
+extern void (*hdsp_dot_cols_f64)(double *y, double *h, double *d, size_t n, size_t n_channels);
+
+/**
+ * One output frame of n_channels interleaved channels, taps a[j] applied to input frames at offsets o1[j]
+ * (and the same taps to mirrored frames at o2[j], pairs of taps of symmetric filter, unless o2 is NULL):
+ * y[c] = Sum{a[j](x[o1[j] + c] + x[o2[j] + c])}, j = 0, ..., n - 1, c = 0, ..., n_channels - 1.
+ * Accumulators of a block of channels stay in registers across all taps, y is written once.
+ */
+extern void (*hdsp_dot_cols_i16_f64)(double *y, double *a, int16_t *x, ptrdiff_t *o1, ptrdiff_t *o2, size_t n,
+                                     size_t n_channels);
+
+/**
+ * y[j] = x[j] (+ TPDF noise of dither lane j % HDSP_DITHER_LANES) rounded to nearest and saturated (NaN to 0),
+ * j = 0, ..., n - 1. Dither state (HDSP_DITHER_LANES generators) is stepped once per (started) group
+ * of HDSP_DITHER_LANES samples, dither is NULL for no dither.
+ */
+extern void (*hdsp_cvt_f64_i16_sat)(double *x, size_t n, int16_t *y, uint32_t *dither);
+extern void (*hdsp_cvt_f32_i16_sat)(float *x, size_t n, int16_t *y, uint32_t *dither);
+
+/**
+ * y[j] = x[j] rounded to nearest and saturated (NaN to 0), j = 0, ..., n - 1.
+ */
+extern void (*hdsp_cvt_f64_i32_sat)(double *x, size_t n, int32_t *y);
+extern void (*hdsp_cvt_f32_i32_sat)(float *x, size_t n, int32_t *y);
+
+/**
+ * Filter length at which FFT convolution gets faster than direct convolution with selected kernel.
+ */
+extern size_t hdsp_conv_fft_taps_min;
+
+
+#endif // LHDSP_SIMD_H
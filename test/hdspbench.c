@@ -0,0 +1,420 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * hdspbench.c - Throughput benchmarks (not run by make check, build with make hdspbench)
+ *
+ * Usage: hdspbench [benchmark ...], runs all benchmarks if none is given.
+ */
+
+
+#include <time.h>
+
+#include "hdsp.h"
+
+#define BENCH_FRAME_LEN 960 // 20 ms at 48 kHz
+#define BENCH_CHANNELS 2000
+#define BENCH_FRAMES 10
+
+static double bench_now(void)
+{
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_report(const char *name, size_t samples, double seconds)
+{
+    printf("%-40s %10.1f Msamples/s (%.3f s)\n", name, samples / seconds / 1e6, seconds);
+}
+
+/**
+ * Same 8 kHz -> 48 kHz lowpass on BENCH_CHANNELS channels of 20 ms: one hdsp_fir_filter call per channel
+ * vs batched calls (planar and interleaved).
+ */
+static int bench_fir(void)
+{
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    int16_t *x = NULL, *xi = NULL, **xp = NULL;
+    double *y = NULL, **yp = NULL, t0 = 0.0;
+    size_t c = 0, t = 0, f = 0, samples = (size_t) BENCH_CHANNELS * BENCH_FRAME_LEN * BENCH_FRAMES;
+    int res = -1;
+
+    x = malloc(BENCH_CHANNELS * BENCH_FRAME_LEN * sizeof(int16_t));
+    xi = malloc(BENCH_CHANNELS * BENCH_FRAME_LEN * sizeof(int16_t));
+    y = malloc(BENCH_CHANNELS * BENCH_FRAME_LEN * sizeof(double));
+    xp = malloc(BENCH_CHANNELS * sizeof(int16_t *));
+    yp = malloc(BENCH_CHANNELS * sizeof(double *));
+    if (!x || !xi || !y || !xp || !yp) {
+        goto end;
+    }
+    if (hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000) != HDSP_STATUS_OK
+        || hdsp_fir_init_from_filter(&fir, &filter) != HDSP_STATUS_OK) {
+        goto end;
+    }
+    for (c = 0; c < BENCH_CHANNELS; c++) {
+        for (t = 0; t < BENCH_FRAME_LEN; t++) {
+            x[c * BENCH_FRAME_LEN + t] = 8000 * sin((double) t * 2 * M_PI * (100 + c % 1000) / 48000);
+            xi[t * BENCH_CHANNELS + c] = x[c * BENCH_FRAME_LEN + t];
+        }
+        xp[c] = &x[c * BENCH_FRAME_LEN];
+        yp[c] = &y[c * BENCH_FRAME_LEN];
+    }
+
+    printf("FIR %zu taps, %u channels x %u samples x %u frames\n", filter.b_len, BENCH_CHANNELS, BENCH_FRAME_LEN,
+           BENCH_FRAMES);
+
+    t0 = bench_now();
+    for (f = 0; f < BENCH_FRAMES; f++) {
+        for (c = 0; c < BENCH_CHANNELS; c++) {
+            hdsp_fir_filter(xp[c], BENCH_FRAME_LEN, &filter, yp[c], BENCH_FRAME_LEN);
+        }
+    }
+    bench_report("hdsp_fir_filter per channel", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (f = 0; f < BENCH_FRAMES; f++) {
+        hdsp_fir_filter_batch(xp, BENCH_CHANNELS, BENCH_FRAME_LEN, &fir, yp, BENCH_FRAME_LEN);
+    }
+    bench_report("hdsp_fir_filter_batch (planar)", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (f = 0; f < BENCH_FRAMES; f++) {
+        hdsp_fir_filter_batch_interleaved(xi, BENCH_CHANNELS, BENCH_FRAME_LEN, &fir, y, BENCH_FRAME_LEN);
+    }
+    bench_report("hdsp_fir_filter_batch_interleaved", samples, bench_now() - t0);
+
+    res = 0;
+
+end:
+    hdsp_fir_deinit(&fir);
+    free(x);
+    free(xi);
+    free(y);
+    free(xp);
+    free(yp);
+    return res;
+}
+
+#if HDSP_HAVE_SCHED
+#define BENCH_STREAMS 5000
+#define BENCH_STREAM_FRAME_LEN 160 // 20 ms at 8 kHz
+
+struct bench_stream {
+    hdsp_sched_stream_t *stream;
+    int16_t x[BENCH_STREAM_FRAME_LEN];
+    double y[BENCH_STREAM_FRAME_LEN];
+    hdsp_sched_fir_job_t jobs[BENCH_FRAMES];
+};
+
+/**
+ * BENCH_STREAMS streams of 20 ms frames at 8 kHz filtered by scheduler jobs, with 1, 2, 4, ... worker threads.
+ */
+static int bench_sched(void)
+{
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    hdsp_sched_t *sched = NULL;
+    struct bench_stream *streams = NULL;
+    size_t n_threads = 0, n_cpu = 0, s = 0, f = 0, t = 0;
+    size_t samples = (size_t) BENCH_STREAMS * BENCH_STREAM_FRAME_LEN * BENCH_FRAMES;
+    double t0 = 0.0, t1 = 0.0, seconds = 0.0;
+    char name[64] = {0};
+    int res = -1;
+
+    streams = calloc(BENCH_STREAMS, sizeof(streams[0]));
+    if (!streams) {
+        return -1;
+    }
+    if (hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000) != HDSP_STATUS_OK
+        || hdsp_fir_init_from_filter(&fir, &filter) != HDSP_STATUS_OK) {
+        goto end;
+    }
+    for (s = 0; s < BENCH_STREAMS; s++) {
+        for (t = 0; t < BENCH_STREAM_FRAME_LEN; t++) {
+            streams[s].x[t] = 8000 * sin((double) t * 2 * M_PI * (100 + s % 1000) / 8000);
+        }
+        for (f = 0; f < BENCH_FRAMES; f++) {
+            streams[s].jobs[f] = (hdsp_sched_fir_job_t) {streams[s].x, BENCH_STREAM_FRAME_LEN, &fir, streams[s].y,
+                                                         BENCH_STREAM_FRAME_LEN, HDSP_STATUS_FALSE};
+        }
+    }
+
+    sched = hdsp_sched_create(0);
+    n_cpu = hdsp_sched_threads(sched);
+    hdsp_sched_destroy(sched);
+    printf("Scheduler, FIR %zu taps, %u streams x %u samples x %u frames, %zu CPUs\n", fir.b_len, BENCH_STREAMS,
+           BENCH_STREAM_FRAME_LEN, BENCH_FRAMES, n_cpu);
+
+    // same jobs run by the calling thread, cost of scheduling is the difference to 1 worker thread
+    t0 = bench_now();
+    for (f = 0; f < BENCH_FRAMES; f++) {
+        for (s = 0; s < BENCH_STREAMS; s++) {
+            hdsp_sched_run_fir(&streams[s].jobs[f]);
+        }
+    }
+    bench_report("no scheduler", samples, bench_now() - t0);
+
+    // 1, 2, 4, ..., n_cpu threads
+    for (n_threads = 1; n_threads <= n_cpu;
+         n_threads = (n_threads == n_cpu) ? n_cpu + 1 : hdsp_min(2 * n_threads, n_cpu)) {
+        sched = hdsp_sched_create(n_threads);
+        if (!sched) {
+            goto end;
+        }
+        for (s = 0; s < BENCH_STREAMS; s++) {
+            streams[s].stream = hdsp_sched_stream_create(sched, BENCH_FRAMES);
+            if (!streams[s].stream) {
+                goto end;
+            }
+        }
+        t0 = bench_now();
+        for (f = 0; f < BENCH_FRAMES; f++) {
+            for (s = 0; s < BENCH_STREAMS; s++) {
+                hdsp_sched_submit(streams[s].stream, hdsp_sched_run_fir, NULL, &streams[s].jobs[f]);
+            }
+        }
+        hdsp_sched_wait(sched);
+        t1 = bench_now() - t0;
+        if (n_threads == 1) {
+            seconds = t1;
+        }
+        snprintf(name, sizeof(name), "hdsp_sched %zu threads (x%.1f)", n_threads, seconds / t1);
+        bench_report(name, samples, t1);
+        for (s = 0; s < BENCH_STREAMS; s++) {
+            hdsp_sched_stream_destroy(streams[s].stream);
+        }
+        hdsp_sched_destroy(sched);
+        sched = NULL;
+    }
+
+    res = 0;
+
+end:
+    hdsp_sched_destroy(sched);
+    hdsp_fir_deinit(&fir);
+    free(streams);
+    return res;
+}
+#endif
+
+#define BENCH_CONV_LEN (BENCH_FRAME_LEN * 64) // 64 channels of 20 ms at 48 kHz
+#define BENCH_CONV_REPEAT 2000
+
+/**
+ * Casting loops vs saturating conversions (with and without dither), on a block that stays in L2 cache.
+ */
+static int bench_conv(void)
+{
+    double *xd = NULL, t0 = 0.0;
+    float *xf = NULL;
+    int16_t *y16 = NULL;
+    int32_t *y32 = NULL;
+    hdsp_dither_t dither = {0};
+    size_t k = 0, samples = (size_t) BENCH_CONV_LEN * BENCH_CONV_REPEAT;
+    int res = -1;
+
+    xd = malloc(BENCH_CONV_LEN * sizeof(double));
+    xf = malloc(BENCH_CONV_LEN * sizeof(float));
+    y16 = malloc(BENCH_CONV_LEN * sizeof(int16_t));
+    y32 = malloc(BENCH_CONV_LEN * sizeof(int32_t));
+    if (!xd || !xf || !y16 || !y32) {
+        goto end;
+    }
+    for (k = 0; k < BENCH_CONV_LEN; k++) {
+        xd[k] = 40000 * sin((double) k * 2 * M_PI * 1000 / 48000);
+        xf[k] = xd[k];
+    }
+    hdsp_dither_init(&dither, 1);
+
+    printf("Conversions, %u samples x %u\n", BENCH_CONV_LEN, BENCH_CONV_REPEAT);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_double_2_int16(xd, BENCH_CONV_LEN, y16);
+    }
+    bench_report("hdsp_double_2_int16 (cast)", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_double_2_int16_sat(xd, BENCH_CONV_LEN, y16, NULL);
+    }
+    bench_report("hdsp_double_2_int16_sat", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_double_2_int16_sat(xd, BENCH_CONV_LEN, y16, &dither);
+    }
+    bench_report("hdsp_double_2_int16_sat (dither)", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_float_2_int16(xf, BENCH_CONV_LEN, y16);
+    }
+    bench_report("hdsp_float_2_int16 (cast)", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_float_2_int16_sat(xf, BENCH_CONV_LEN, y16, NULL);
+    }
+    bench_report("hdsp_float_2_int16_sat", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_float_2_int16_sat(xf, BENCH_CONV_LEN, y16, &dither);
+    }
+    bench_report("hdsp_float_2_int16_sat (dither)", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_double_2_int32_sat(xd, BENCH_CONV_LEN, y32);
+    }
+    bench_report("hdsp_double_2_int32_sat", samples, bench_now() - t0);
+
+    t0 = bench_now();
+    for (k = 0; k < BENCH_CONV_REPEAT; k++) {
+        hdsp_float_2_int32_sat(xf, BENCH_CONV_LEN, y32);
+    }
+    bench_report("hdsp_float_2_int32_sat", samples, bench_now() - t0);
+
+    res = 0;
+
+end:
+    free(xd);
+    free(xf);
+    free(y16);
+    free(y32);
+    return res;
+}
+
+#define BENCH_CROSSOVER_FRAMES 200
+
+// crossover of selected kernels (src/hdsp_simd.h), overridden to time both sides of it
+extern size_t hdsp_conv_fft_taps_min;
+
+/**
+ * Direct vs FFT filtering of 20 ms frames with context (plan made once), for filters without zero
+ * or mirrored taps of increasing length, with each instruction set: the shortest filter for which FFT wins
+ * is the crossover of the instruction set (HDSP_CONV_FFT_TAPS_MIN_* in src/hdsp_simd.c).
+ */
+static int bench_crossover(void)
+{
+    const char *names[] = {"none", "sse2", "avx2", "avx512", "neon"};
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    size_t b_lens[] = {32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_fir_ctx_t ctx = {0};
+    hdsp_fir_t fir = {0};
+    int16_t x[BENCH_FRAME_LEN] = {0};
+    double y[BENCH_FRAME_LEN] = {0}, b[1024] = {0}, t0 = 0.0, t_direct = 0.0, t_fft = 0.0;
+    size_t i = 0, k = 0, f = 0, crossover = 0;
+
+    for (i = 0; i < BENCH_FRAME_LEN; i++) {
+        x[i] = 8000 * sin((double) i * 2 * M_PI * 440 / 48000);
+    }
+    for (i = 0; i < sizeof(b) / sizeof(b[0]); i++) {
+        b[i] = sin(0.05 * i + 0.2) / (1.0 + 0.1 * i);
+    }
+
+    printf("Direct vs FFT crossover, %u sample frames, us per frame\n", BENCH_FRAME_LEN);
+    for (k = 0; k < sizeof(isa) / sizeof(isa[0]); k++) {
+        if (hdsp_simd_set(isa[k]) != HDSP_STATUS_OK) {
+            continue;
+        }
+        crossover = 0;
+        for (i = 0; i < sizeof(b_lens) / sizeof(b_lens[0]); i++) {
+            if (hdsp_fir_init(&fir, b, b_lens[i], 48000, 4000) != HDSP_STATUS_OK
+                || hdsp_fir_ctx_init(&ctx, BENCH_FRAME_LEN, b_lens[i], NULL, 0) != HDSP_STATUS_OK
+                || hdsp_fir_ctx_set_fir(&ctx, &fir) != HDSP_STATUS_OK) {
+                hdsp_fir_deinit(&fir);
+                return -1;
+            }
+            hdsp_conv_fft_taps_min = SIZE_MAX;
+            t0 = bench_now();
+            for (f = 0; f < BENCH_CROSSOVER_FRAMES; f++) {
+                hdsp_fir_filter_ctx(&ctx, x, BENCH_FRAME_LEN, y, BENCH_FRAME_LEN);
+            }
+            t_direct = (bench_now() - t0) / BENCH_CROSSOVER_FRAMES;
+            hdsp_conv_fft_taps_min = 0;
+            t0 = bench_now();
+            for (f = 0; f < BENCH_CROSSOVER_FRAMES; f++) {
+                hdsp_fir_filter_ctx(&ctx, x, BENCH_FRAME_LEN, y, BENCH_FRAME_LEN);
+            }
+            t_fft = (bench_now() - t0) / BENCH_CROSSOVER_FRAMES;
+            if (crossover == 0 && t_fft < t_direct) {
+                crossover = b_lens[i];
+            }
+            printf("%-8s %5zu taps: direct %8.1f, FFT %8.1f\n", names[k], b_lens[i], t_direct * 1e6, t_fft * 1e6);
+            hdsp_fir_ctx_deinit(&ctx);
+            hdsp_fir_deinit(&fir);
+        }
+        printf("%-8s crossover: %zu taps\n", names[k], crossover);
+    }
+    hdsp_simd_set(isa_default);
+
+    return 0;
+}
+
+struct bench {
+    const char *name;
+    int (*run)(void);
+};
+
+static struct bench benches[] = {
+    {"fir", bench_fir},
+#if HDSP_HAVE_SCHED
+    {"sched", bench_sched},
+#endif
+    {"conv", bench_conv},
+    {"crossover", bench_crossover},
+};
+
+int main(int argc, char **argv) {
+
+    size_t k = 0;
+    int i = 0, found = 0;
+
+    for (k = 0; k < sizeof(benches) / sizeof(benches[0]); k++) {
+        found = (argc < 2);
+        for (i = 1; i < argc; i++) {
+            found = found || !strcmp(argv[i], benches[k].name);
+        }
+        if (found && benches[k].run() != 0) {
+            fprintf(stderr, "Benchmark %s failed\n", benches[k].name);
+            return 1;
+        }
+    }
+
+    return 0;
+}
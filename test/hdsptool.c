@@ -51,6 +51,8 @@
  * Command 'upsamplef' is similar, but accepts any sampling rate, uses filter designed by spectrum sampling
  * and let's to specify filter length.
  * Commands 'denoise' and 'denoisef' work on the same principle, but additionally perform denoising with RNNoise.
+ * Command 'resample' converts input file of any sampling rate to any output sampling rate (e.g. 44100 -> 48000)
+ * with rational resampler, output is written to PTms_FS_x_r.raw, where FS is the output sampling rate.
  */
 
 
@@ -73,10 +75,73 @@ static void usage(const char *name) {
                     "\tupsample <input file raw> <input file sample rate> <ptime ms>\n"
                     "\tupsamplef <input file raw> <input file sample rate> <ptime ms> <filter len>\n"
                     "\tdenoise <input file raw> <input file sample rate> <ptime ms>\n"
-                    "\tdenoisef <input file raw> <input file sample rate> <ptime ms> <filter len>\n\n",
+                    "\tdenoisef <input file raw> <input file sample rate> <ptime ms> <filter len>\n"
+                    "\tresample <input file raw> <input file sample rate> <ptime ms> <output sample rate>\n\n",
                     name);
 }
 
+static int resample(const char *f_in_name, int sample_rate_in, int ptime_ms, int sample_rate_out) {
+
+    FILE *f_in = NULL, *f_out = NULL;
+    char fname[BUFLEN] = {0};
+    int16_t frame_in[TARGET_SAMPLE_RATE] = {0};
+    int16_t frame_out[TARGET_SAMPLE_RATE] = {0};
+    double y[TARGET_SAMPLE_RATE] = {0};
+    size_t samples_in = ptime_ms * sample_rate_in / 1000, n = 0;
+    hdsp_resampler_t resampler = {0};
+    int k = 0;
+
+    if (samples_in < 1 || samples_in > TARGET_SAMPLE_RATE || sample_rate_out < 1 || sample_rate_out > TARGET_SAMPLE_RATE) {
+        fprintf(stderr, "Wrong ptime or sampling rate\n");
+        return -1;
+    }
+
+    if (HDSP_STATUS_OK != hdsp_resampler_init(&resampler, sample_rate_in, sample_rate_out)) {
+        fprintf(stderr, "Failed to create resampler\n");
+        return -1;
+    }
+    printf("sampling rate=%d -> %d, frame ms=%d, frame samples=%zu, L/M=%d/%d, taps per phase=%zu\n",
+           sample_rate_in, sample_rate_out, ptime_ms, samples_in, resampler.upsample_factor,
+           resampler.downsample_factor, resampler.taps_per_phase);
+
+    snprintf(fname, BUFLEN - 1, "%dms_%d_x_r.raw", ptime_ms, sample_rate_out);
+    f_in = fopen(f_in_name, "rb");
+    f_out = fopen(fname, "wb");
+    if (!f_in || !f_out) {
+        fprintf(stderr, "Cannot open files\n");
+        goto fail;
+    }
+
+    while (samples_in == fread(frame_in, sizeof(int16_t), samples_in, f_in)) {
+        if (HDSP_STATUS_OK != hdsp_resample(frame_in, samples_in, &resampler, y, TARGET_SAMPLE_RATE, &n)) {
+            fprintf(stderr, "Failed to resample\n");
+            goto fail;
+        }
+        hdsp_double_2_int16(y, n, frame_out);
+        if (n != fwrite(frame_out, sizeof(int16_t), n, f_out)) {
+            fprintf(stderr, "Failed to write\n");
+            goto fail;
+        }
+        k = k + 1;
+    }
+
+    fclose(f_in);
+    fclose(f_out);
+    hdsp_resampler_deinit(&resampler);
+    printf("Done. (frames: %d)\n", k);
+    return 0;
+
+fail:
+    if (f_in) {
+        fclose(f_in);
+    }
+    if (f_out) {
+        fclose(f_out);
+    }
+    hdsp_resampler_deinit(&resampler);
+    return -1;
+}
+
 int main(int argc, char **argv) {
 
     const char *cmd = NULL;
@@ -100,6 +165,7 @@ int main(int argc, char **argv) {
     float rnnoise_out[TARGET_SAMPLE_RATE] = {0};
     int k = 0;
     hdsp_filter_t filter = {0};
+    hdsp_interp_t interp = {0};
     int upsample_factor = 0;
     char fname_x[BUFLEN] = {0};
     char fname_x_u[BUFLEN] = {0};
@@ -118,6 +184,16 @@ int main(int argc, char **argv) {
     }
 
     cmd = argv[1];
+    if (strcmp(cmd, "resample") == 0) {
+        if (argc != 6) {
+            usage(PROGRAM_NAME);
+            exit(EXIT_FAILURE);
+        }
+        if (resample(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5])) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
     if (strcmp(cmd, "upsample") != 0 && strcmp(cmd, "upsamplef") != 0 &&
             strcmp(cmd, "denoise") != 0 && strcmp(cmd, "denoisef") != 0) {
         usage(PROGRAM_NAME);
@@ -197,6 +273,11 @@ int main(int argc, char **argv) {
                sample_rate_in, ptime_ms, samples_in, upsample_factor, filter_len);
     }
 
+    if (HDSP_STATUS_OK != hdsp_interp_init(&interp, &filter, upsample_factor)) {
+        fprintf(stderr, "Failed to create interpolator\n");
+        goto fail;
+    }
+
     if (denoising) {
         rnnoise1 = rnnoise_create(NULL);
         rnnoise2 = rnnoise_create(NULL);
@@ -266,8 +347,9 @@ int main(int argc, char **argv) {
             }
         }
 
-        if (HDSP_STATUS_OK != hdsp_fir_filter(buffer, samples_per_ptime_of_48khz_frame, &filter, frame_out,
-                                              samples_per_ptime_of_48khz_frame)) {
+        // upsample and filter in one pass (same as filtering the upsampled buffer with hdsp_fir_filter)
+        if (HDSP_STATUS_OK != hdsp_interpolate(frame_in, samples_in, &interp, frame_out,
+                                               samples_per_ptime_of_48khz_frame)) {
             fprintf(stderr, "Failed to filter\n");
             goto fail;
         }
@@ -0,0 +1,94 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test10.c - Test decimating FIR filter (hdsp_decimate against hdsp_conv_full + downsampling)
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 4800
+    #define DOWNSAMPLE_FACTOR 6
+
+    hdsp_filter_t filter = {0};
+    hdsp_decim_t decim = {0};
+    int16_t x[X_LEN] = {0};
+    double y_full[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double y_ref[X_LEN / DOWNSAMPLE_FACTOR] = {0};
+    double y[X_LEN / DOWNSAMPLE_FACTOR] = {0};
+    size_t frames[] = {480, 6, 96, 1200, 18, 3000};
+    size_t i = 0, j = 0, pos = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 300 / 48000) + 4000 * sin((double)i * 2 * M_PI * 7000 / 48000);
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+
+    // Reference: filter at full rate, then keep every 6th sample
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv_full(x, X_LEN, filter.b, filter.b_len, y_full),
+              "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_downsample_double(y_full, X_LEN, DOWNSAMPLE_FACTOR, y_ref,
+                                                       X_LEN / DOWNSAMPLE_FACTOR), "Downsampling failed");
+
+    // Whole signal at once
+    hdsp_test(HDSP_STATUS_OK == hdsp_decim_init(&decim, &filter, DOWNSAMPLE_FACTOR), "Decimator init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_decimate(x, X_LEN, &decim, y, X_LEN / DOWNSAMPLE_FACTOR), "Decimation failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN / DOWNSAMPLE_FACTOR);
+
+    // Frame by frame, frames of different lengths, state carried over
+    memset(y, 0, sizeof(y));
+    hdsp_test(HDSP_STATUS_OK == hdsp_decim_init(&decim, &filter, DOWNSAMPLE_FACTOR), "Decimator init failed");
+    pos = 0;
+    j = 0;
+    while (j < sizeof(frames) / sizeof(frames[0])) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_decimate(&x[pos], frames[j], &decim, &y[pos / DOWNSAMPLE_FACTOR],
+                                                  frames[j] / DOWNSAMPLE_FACTOR), "Decimation failed");
+        pos = pos + frames[j];
+        j = j + 1;
+    }
+    hdsp_test(pos == X_LEN, "Wrong number of samples");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN / DOWNSAMPLE_FACTOR);
+
+    // Bad input
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_decimate(x, 481, &decim, y, 80), "Should fail for frame not multiple of M");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_decimate(x, 480, &decim, y, 81), "Should fail for wrong output length");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_decim_init(&decim, &filter, 0), "Should fail for downsample factor 0");
+
+    return 0;
+}
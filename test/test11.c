@@ -0,0 +1,140 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test11.c - Test rational L/M resampler
+ */
+
+
+#include "hdsp.h"
+
+#define Y_MAX 20000
+
+static void test_ratio(uint32_t fs_in, uint32_t fs_out, int L, int M)
+{
+    hdsp_resampler_t resampler = {0};
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, fs_in, fs_out), "Resampler init failed");
+    hdsp_test(resampler.upsample_factor == L, "Wrong upsample factor");
+    hdsp_test(resampler.downsample_factor == M, "Wrong downsample factor");
+    fprintf(stderr, "%u -> %u: L/M=%d/%d, taps per phase=%zu\n", fs_in, fs_out, L, M, resampler.taps_per_phase);
+    hdsp_resampler_deinit(&resampler);
+}
+
+/**
+ * Resample a tone frame by frame and compare it to the tone sampled at the output rate.
+ * Returns max absolute error (after the filter's transient).
+ */
+static double test_tone(uint32_t fs_in, uint32_t fs_out, double f, size_t frame_len)
+{
+    static int16_t x[Y_MAX];
+    static double y[Y_MAX];
+    static double y2[Y_MAX];
+    hdsp_resampler_t resampler = {0};
+    size_t x_len = fs_in / 5, i = 0, pos = 0, n = 0, y_len = 0;
+    double delay = 0.0, err = 0.0, ref = 0.0;
+
+    while (i < x_len) {
+        x[i] = 10000 * sin(2 * M_PI * f * i / fs_in);
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, fs_in, fs_out), "Resampler init failed");
+    delay = hdsp_resampler_delay(&resampler);
+
+    // frame by frame
+    pos = 0;
+    while (pos + frame_len <= x_len) {
+        n = hdsp_resampler_output_len(&resampler, frame_len);
+        hdsp_test(HDSP_STATUS_OK == hdsp_resample(&x[pos], frame_len, &resampler, &y[y_len], Y_MAX - y_len, &i),
+                  "Resampling failed");
+        hdsp_test(i == n, "Wrong number of output samples");
+        y_len = y_len + n;
+        pos = pos + frame_len;
+    }
+    hdsp_test(y_len == ((uint64_t) pos * fs_out + fs_in - 1) / fs_in, "Wrong number of output samples in total");
+    hdsp_resampler_deinit(&resampler);
+
+    // all at once
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, fs_in, fs_out), "Resampler init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_resample(x, pos, &resampler, y2, Y_MAX, &n), "Resampling failed");
+    hdsp_test(n == y_len, "Wrong number of output samples");
+    hdsp_test_vectors_equal_double(y, y2, y_len);
+    hdsp_resampler_deinit(&resampler);
+
+    i = (size_t) (2 * delay) + 1;
+    while (i < y_len) {
+        ref = 10000 * sin(2 * M_PI * f * (i - delay) / fs_out);
+        err = hdsp_max(err, fabs(y[i] - ref));
+        i = i + 1;
+    }
+    fprintf(stderr, "%u -> %u, tone %f Hz: max error %f\n", fs_in, fs_out, f, err);
+    return err;
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_resampler_t resampler = {0};
+    int16_t x[480] = {0};
+    double y[480] = {0};
+    size_t n = 0;
+
+    test_ratio(44100, 48000, 160, 147);
+    test_ratio(22050, 48000, 320, 147);
+    test_ratio(11025, 48000, 640, 147);
+    test_ratio(32000, 48000, 3, 2);
+    test_ratio(8000, 48000, 6, 1);
+    test_ratio(48000, 8000, 1, 6);
+    test_ratio(48000, 44100, 147, 160);
+    test_ratio(16000, 16000, 1, 1);
+
+    // Error below -60 dB of the tone amplitude
+    hdsp_test(test_tone(44100, 48000, 1000, 441) < 10.0, "44100 -> 48000 error too big");
+    hdsp_test(test_tone(44100, 48000, 15000, 100) < 10.0, "44100 -> 48000 error too big");
+    hdsp_test(test_tone(48000, 44100, 3000, 480) < 10.0, "48000 -> 44100 error too big");
+    hdsp_test(test_tone(32000, 48000, 5000, 320) < 10.0, "32000 -> 48000 error too big");
+    hdsp_test(test_tone(8000, 48000, 440, 160) < 10.0, "8000 -> 48000 error too big");
+    hdsp_test(test_tone(48000, 8000, 440, 960) < 10.0, "48000 -> 8000 error too big");
+
+    // Output buffer too small
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, 44100, 48000), "Resampler init failed");
+    hdsp_test(hdsp_resampler_output_len(&resampler, 441) == 480, "Wrong output length");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_resample(x, 441, &resampler, y, 479, &n), "Should fail for short output");
+    hdsp_test(HDSP_STATUS_OK == hdsp_resample(x, 441, &resampler, y, 480, &n), "Resampling failed");
+    hdsp_test(n == 480, "Wrong number of output samples");
+    hdsp_resampler_deinit(&resampler);
+
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_resampler_init(&resampler, 0, 48000), "Should fail for zero rate");
+
+    return 0;
+}
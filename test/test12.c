@@ -0,0 +1,101 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test12.c - Test streaming FIR filter (frame by frame filtering against filtering whole signal at once)
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 9600
+    #define FRAME_LEN 960
+
+    hdsp_filter_t filter = {0};
+    hdsp_fir_stream_t stream = {0};
+    static int16_t x[X_LEN] = {0};
+    static double y_full[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    static double y_same[X_LEN] = {0};
+    static double y[X_LEN] = {0};
+    size_t frames[] = {1, 5, 56, 57, 100, 4000, 2, 2819, 960, 1600};
+    size_t i = 0, j = 0, pos = 0, delay = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + 2000 * sin((double)i * 2 * M_PI * 12000 / 48000);
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv_full(x, X_LEN, filter.b, filter.b_len, y_full),
+              "Conv did not work");
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_stream_init(&stream, &filter), "Streaming filter init failed");
+    hdsp_test(hdsp_fir_stream_delay(&stream) == (HDSP_FIR_LS_KAISER_57_4000_48000_LEN - 1) / 2, "Wrong delay");
+
+    // Equal frames
+    pos = 0;
+    while (pos < X_LEN) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_stream(&x[pos], FRAME_LEN, &stream, &y[pos], FRAME_LEN),
+                  "Streaming FIR filtering failed");
+        pos = pos + FRAME_LEN;
+    }
+    hdsp_test_vectors_equal_almost_double(y, y_full, X_LEN);
+
+    // Frames of different lengths, some shorter than filter
+    memset(y, 0, sizeof(y));
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_stream_init(&stream, &filter), "Streaming filter init failed");
+    pos = 0;
+    j = 0;
+    while (j < sizeof(frames) / sizeof(frames[0])) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_stream(&x[pos], frames[j], &stream, &y[pos], frames[j]),
+                  "Streaming FIR filtering failed");
+        pos = pos + frames[j];
+        j = j + 1;
+    }
+    hdsp_test(pos == X_LEN, "Wrong number of samples");
+    hdsp_test_vectors_equal_almost_double(y, y_full, X_LEN);
+
+    // Delayed by group delay, output is zero-phase filtered whole signal
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, y_same, X_LEN), "FIR filtering failed");
+    delay = hdsp_fir_stream_delay(&stream);
+    hdsp_test_vectors_equal_almost_double((&y[delay]), y_same, X_LEN - delay);
+
+    // Bad input
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_stream(x, FRAME_LEN, &stream, y, FRAME_LEN - 1),
+              "Should fail for output too short");
+
+    return 0;
+}
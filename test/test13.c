@@ -0,0 +1,131 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test13.c - Test asynchronous sample-rate converter
+ */
+
+
+#include "hdsp.h"
+
+#define X_MAX 48000
+#define Y_MAX 60000
+
+/**
+ * Convert a tone frame by frame and compare it to the tone sampled at the output rate.
+ * Returns max absolute error (after the kernel's transient).
+ */
+static double test_tone(uint32_t fs_in, uint32_t fs_out, double ratio, double f, size_t frame_len)
+{
+    static int16_t x[X_MAX];
+    static double y[Y_MAX];
+    hdsp_asrc_t asrc = {0};
+    size_t i = 0, n = 0, pos = 0, y_len = 0, x_len = hdsp_min(X_MAX, Y_MAX / (ratio * 1.01));
+    double delay = 0.0, err = 0.0, ref = 0.0;
+
+    while (i < X_MAX) {
+        x[i] = 10000 * sin(2 * M_PI * f * i / fs_in);
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_asrc_init(&asrc, fs_in, fs_out), "ASRC init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_asrc_set_ratio(&asrc, ratio), "Failed to set ratio");
+    delay = hdsp_asrc_delay(&asrc);
+
+    pos = 0;
+    while (pos + frame_len <= x_len) {
+        n = hdsp_asrc_output_len(&asrc, frame_len);
+        hdsp_test(HDSP_STATUS_OK == hdsp_asrc_process(&x[pos], frame_len, &asrc, &y[y_len], Y_MAX - y_len, &i),
+                  "ASRC failed");
+        hdsp_test(i == n, "Wrong number of output samples");
+        y_len = y_len + n;
+        pos = pos + frame_len;
+    }
+    hdsp_test(fabs(y_len - pos * ratio) < 2.0, "Wrong number of output samples in total");
+
+    i = (size_t) (2 * delay) + 1;
+    while (i < y_len) {
+        // output sample i is taken at input time i / ratio
+        ref = 10000 * sin(2 * M_PI * f * (i - delay) / ratio / fs_in);
+        err = hdsp_max(err, fabs(y[i] - ref));
+        i = i + 1;
+    }
+    fprintf(stderr, "%u -> %u (ratio %.9f), tone %f Hz: output samples %zu, max error %f\n",
+            fs_in, fs_out, ratio, f, y_len, err);
+    return err;
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_asrc_t asrc = {0};
+    int16_t x[480] = {0};
+    double y[600] = {0};
+    size_t n = 0;
+    double ppm = 0.0;
+    int i = 0;
+
+    // Nominal ratios, error below -60 dB of the tone amplitude
+    hdsp_test(test_tone(48000, 48000, 1.0, 1000, 480) < 10.0, "48000 -> 48000 error too big");
+    hdsp_test(test_tone(44100, 48000, 48000.0 / 44100.0, 3000, 441) < 10.0, "44100 -> 48000 error too big");
+    hdsp_test(test_tone(48000, 44100, 44100.0 / 48000.0, 3000, 480) < 10.0, "48000 -> 44100 error too big");
+    hdsp_test(test_tone(8000, 48000, 6.0, 440, 80) < 10.0, "8000 -> 48000 error too big");
+    hdsp_test(test_tone(48000, 8000, 1.0 / 6.0, 440, 960) < 10.0, "48000 -> 8000 error too big");
+
+    // Clock drift, +/- 100 ppm
+    hdsp_test(test_tone(48000, 48000, 1.0001, 1000, 480) < 10.0, "48000 -> 48000 +100 ppm error too big");
+    hdsp_test(test_tone(48000, 48000, 0.9999, 1000, 480) < 10.0, "48000 -> 48000 -100 ppm error too big");
+    hdsp_test(test_tone(8000, 8000, 1.00005, 300, 160) < 10.0, "8000 -> 8000 +50 ppm error too big");
+
+    // Drift tracking, buffer too full -> ratio goes down, too empty -> up, correction is limited
+    hdsp_test(HDSP_STATUS_OK == hdsp_asrc_init(&asrc, 48000, 48000), "ASRC init failed");
+    ppm = hdsp_asrc_track(&asrc, 960 + 48, 960, 48000);
+    hdsp_test(ppm < 0.0 && hdsp_asrc_get_ratio(&asrc) < 1.0, "Ratio should go down");
+    ppm = hdsp_asrc_track(&asrc, 960 - 480, 960, 48000);
+    hdsp_test(ppm > 0.0 && hdsp_asrc_get_ratio(&asrc) > 1.0, "Ratio should go up");
+    while (i < 10000) {
+        ppm = hdsp_asrc_track(&asrc, 0, 960, 48000);
+        i = i + 1;
+    }
+    hdsp_test(ppm == HDSP_ASRC_DRIFT_PPM_MAX, "Correction should be limited");
+    hdsp_test(HDSP_ASRC_DRIFT_PPM_MAX == hdsp_asrc_track(&asrc, 0, 960, 48000), "Correction should be limited");
+
+    // Bad input
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_asrc_init(&asrc, 48000, 1000), "Should fail for ratio below 1/8");
+    hdsp_test(HDSP_STATUS_OK == hdsp_asrc_init(&asrc, 8000, 8000), "ASRC init failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_asrc_set_ratio(&asrc, 0.0), "Should fail for zero ratio");
+    n = hdsp_asrc_output_len(&asrc, 480);
+    hdsp_test(n == 480, "Wrong output length");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_asrc_process(x, 480, &asrc, y, n - 1, &n), "Should fail for short output");
+
+    return 0;
+}
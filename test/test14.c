@@ -0,0 +1,131 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test14.c - Test multistage resampling planner and cascade
+ */
+
+
+#include "hdsp.h"
+
+#define X_MAX 96000
+#define Y_MAX 96000
+
+/**
+ * Resample a tone frame by frame and compare it to the tone sampled at the output rate.
+ * Returns max absolute error (after the filters' transient).
+ */
+static double test_tone(uint32_t fs_in, uint32_t fs_out, double f, size_t frame_len)
+{
+    static int16_t x[X_MAX];
+    static double y[Y_MAX];
+    hdsp_multistage_t ms = {0};
+    int factors[HDSP_MULTISTAGE_STAGES_MAX] = {0}, n_stages = 0, single[1] = {0};
+    size_t i = 0, n = 0, pos = 0, y_len = 0, x_len = hdsp_min(X_MAX, (double) Y_MAX * fs_in / fs_out / 1.01);
+    double delay = 0.0, err = 0.0, ref = 0.0, macs = 0.0, macs_single = 0.0;
+
+    while (i < x_len) {
+        x[i] = 10000 * sin(2 * M_PI * f * i / fs_in);
+        i = i + 1;
+    }
+
+    macs = hdsp_multistage_plan(fs_in, fs_out, factors, &n_stages);
+    single[0] = hdsp_max(fs_in, fs_out) / hdsp_min(fs_in, fs_out);
+    macs_single = hdsp_multistage_cost(fs_in, fs_out, single, 1);
+    fprintf(stderr, "%u -> %u: %d stage(s)", fs_in, fs_out, n_stages);
+    i = 0;
+    while (i < (size_t) n_stages) {
+        fprintf(stderr, " %s%d", i > 0 ? "x " : "", factors[i]);
+        i = i + 1;
+    }
+    fprintf(stderr, ", MACs per output sample %f (single stage %f)\n", macs, macs_single);
+    hdsp_test(macs > 0.0 && macs <= macs_single, "Plan should not be worse than single stage");
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_multistage_init(&ms, fs_in, fs_out, frame_len), "Multistage init failed");
+    hdsp_test(ms.n_stages == n_stages, "Wrong number of stages");
+    hdsp_test(HDSP_EQUAL_ALMOST_DOUBLES(ms.macs_per_output, macs), "Wrong MACs");
+    delay = hdsp_multistage_delay(&ms);
+
+    pos = 0;
+    while (pos + frame_len <= x_len) {
+        n = hdsp_multistage_output_len(&ms, frame_len);
+        hdsp_test(HDSP_STATUS_OK == hdsp_multistage_resample(&x[pos], frame_len, &ms, &y[y_len], Y_MAX - y_len, &i),
+                  "Resampling failed");
+        hdsp_test(i == n, "Wrong number of output samples");
+        y_len = y_len + n;
+        pos = pos + frame_len;
+    }
+    hdsp_test(y_len == ((uint64_t) pos * fs_out + fs_in - 1) / fs_in, "Wrong number of output samples in total");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_multistage_resample(x, frame_len + 1, &ms, y, Y_MAX, &i),
+              "Should fail for frame longer than max");
+    hdsp_multistage_deinit(&ms);
+
+    i = (size_t) (2 * delay) + 1;
+    while (i < y_len) {
+        ref = 10000 * sin(2 * M_PI * f * (i - delay) / fs_out);
+        err = hdsp_max(err, fabs(y[i] - ref));
+        i = i + 1;
+    }
+    fprintf(stderr, "%u -> %u, tone %f Hz: max error %f\n", fs_in, fs_out, f, err);
+    return err;
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_multistage_t ms = {0};
+    int factors[HDSP_MULTISTAGE_STAGES_MAX] = {0}, n_stages = 0;
+    int plan_2_3[2] = {2, 3}, plan_3_2[2] = {3, 2}, plan_6[1] = {6}, plan_5[1] = {5};
+
+    // 48000 -> 8000 in stages is several times cheaper than in one stage
+    hdsp_test(hdsp_multistage_plan(48000, 8000, factors, &n_stages) > 0.0, "Planning failed");
+    hdsp_test(n_stages == 2, "48000 -> 8000 should be done in 2 stages");
+    hdsp_test(hdsp_multistage_cost(48000, 8000, factors, n_stages) * 2.0 < hdsp_multistage_cost(48000, 8000, plan_6, 1),
+              "Multistage should be much cheaper");
+    hdsp_test(hdsp_multistage_cost(48000, 8000, plan_2_3, 2) > 0.0, "Plan 2 x 3 should be valid");
+    hdsp_test(hdsp_multistage_cost(48000, 8000, plan_3_2, 2) > 0.0, "Plan 3 x 2 should be valid");
+    hdsp_test(hdsp_multistage_cost(48000, 8000, plan_5, 1) == 0.0, "Plan 5 should be invalid");
+
+    hdsp_test(test_tone(48000, 8000, 440, 960) < 10.0, "48000 -> 8000 error too big");
+    hdsp_test(test_tone(48000, 8000, 3500, 480) < 10.0, "48000 -> 8000 error too big");
+    hdsp_test(test_tone(8000, 48000, 440, 160) < 10.0, "8000 -> 48000 error too big");
+    hdsp_test(test_tone(16000, 48000, 6000, 320) < 10.0, "16000 -> 48000 error too big");
+    hdsp_test(test_tone(96000, 8000, 1000, 1920) < 10.0, "96000 -> 8000 error too big");
+    hdsp_test(test_tone(8000, 16000, 1000, 160) < 10.0, "8000 -> 16000 error too big");
+
+    // Not an integer ratio
+    hdsp_test(hdsp_multistage_plan(44100, 48000, factors, &n_stages) == 0.0, "Planning should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_multistage_init(&ms, 44100, 48000, 441), "Init should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_multistage_init(&ms, 48000, 48000, 480), "Init should fail");
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test15.c - Test skipping of zero taps (Nyquist filters)
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 960
+
+    hdsp_filter_t filter = {0};
+    int16_t x[X_LEN] = {0};
+    double y_ref[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double y[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double z[X_LEN] = {0};
+    uint16_t b_nz_idx[HDSP_FIR_FILTER_LEN_MAX] = {0};
+    int32_t idx_start = 0, idx_end = 0;
+    size_t i = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    // Third-band filter (Nyquist-3): every third tap from the centre is zero
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, 71, 48000, 8000),
+              "Filter initialisation failed");
+    hdsp_test(filter.b_nz_len == 71 - 22, "Wrong number of non-zero taps");
+    i = 0;
+    while (i < filter.b_len) {
+        if (i != 35 && (i % 3) == 35 % 3) {
+            hdsp_test(filter.b[i] == 0.0, "Tap should be zero");
+        } else {
+            hdsp_test(filter.b[i] != 0.0, "Tap should not be zero");
+        }
+        i = i + 1;
+    }
+    hdsp_test(filter.b_nz_len == hdsp_fir_filter_nz_idx(&filter, b_nz_idx), "Wrong number of indices");
+    i = 1;
+    while (i < filter.b_nz_len) {
+        hdsp_test(b_nz_idx[i - 1] < b_nz_idx[i], "Indices should be ascending");
+        i = i + 1;
+    }
+
+    // Sparse convolution is the same as full convolution (of scalar kernel, which sums in the same order)
+    hdsp_test(HDSP_STATUS_OK == hdsp_simd_set(HDSP_SIMD_NONE), "Scalar kernel should be always supported");
+    hdsp_test(X_LEN + 71 - 1 == hdsp_conv_full(x, X_LEN, filter.b, filter.b_len, y_ref), "Conv did not work");
+    hdsp_test(X_LEN + 71 - 1 == hdsp_conv_full_sparse(x, X_LEN, filter.b, filter.b_len, b_nz_idx,
+                                                      filter.b_nz_len, y), "Sparse conv did not work");
+    hdsp_test_vectors_equal_double(y, y_ref, X_LEN + 71 - 1);
+
+    // Also when filter is longer than signal
+    hdsp_test(20 + 71 - 1 == hdsp_conv_full(x, 20, filter.b, filter.b_len, y_ref), "Conv did not work");
+    hdsp_test(20 + 71 - 1 == hdsp_conv_full_sparse(x, 20, filter.b, filter.b_len, b_nz_idx,
+                                                   filter.b_nz_len, y), "Sparse conv did not work");
+    hdsp_test_vectors_equal_double(y, y_ref, 20 + 71 - 1);
+
+    // FIR filter skips zero taps (and folds symmetric taps) and gives the same result, up to rounding
+    hdsp_test(X_LEN + 71 - 1 == hdsp_conv(x, X_LEN, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME, y_ref,
+                                          &idx_start, &idx_end), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_almost_double(z, (&y_ref[idx_start]), X_LEN);
+
+    // Half-band filter (Nyquist-2), windowed
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, 31, 48000, 12000),
+              "Filter initialisation failed");
+    hdsp_kaiser_window(y, 31, HDSP_KAISER_FILTER_BETA_DEFAULT);
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_shape(&filter, y, 31), "Filter shaping failed");
+    hdsp_test(filter.b_nz_len == 31 - 14, "Wrong number of non-zero taps");
+
+    // Filters without zero taps
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(filter.b_nz_len == filter.b_len, "All taps should be non-zero");
+
+    // Taps modified directly
+    filter.b[0] = 0.0;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+    hdsp_test(filter.b_nz_len == filter.b_len - 1, "Wrong number of non-zero taps");
+    hdsp_test(hdsp_fir_filter_nz_idx(&filter, b_nz_idx) == filter.b_nz_len && b_nz_idx[0] == 1,
+              "Wrong index of first non-zero tap");
+
+    // Negligible taps are skipped, but aren't modified
+    filter.b[1] = 1e-20;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+    hdsp_test(filter.b_nz_len == filter.b_len - 2 && hdsp_fir_filter_nz_idx(&filter, b_nz_idx) == filter.b_nz_len
+              && b_nz_idx[0] == 2, "Negligible tap should be skipped");
+    hdsp_test(filter.b[1] == 1e-20, "Taps should not be modified by analysis");
+
+    // Filter with all taps zero is analysed, and filters to zeros
+    memset(&filter, 0, sizeof(filter));
+    hdsp_test(!filter.analysed, "Filter should not be analysed");
+    filter.b_len = 31;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+    hdsp_test(filter.analysed && filter.b_nz_len == 0, "All taps should be zero");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    i = 0;
+    while (i < X_LEN) {
+        hdsp_test(z[i] == 0.0, "Output should be zero");
+        i = i + 1;
+    }
+
+    return 0;
+}
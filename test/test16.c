@@ -0,0 +1,139 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test16.c - Test symmetric (linear phase) FIR kernel
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 960
+
+    hdsp_filter_t filter = {0};
+    int16_t x[X_LEN] = {0};
+    double y_ref[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double y[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double z[X_LEN] = {0};
+    double w[HDSP_FIR_FILTER_LEN_MAX] = {0};
+    int32_t idx_start = 0, idx_end = 0;
+    size_t i = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    // Windowed designs are symmetric
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Filter should be symmetric");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_ls(&filter, 57, 48000, 4000),
+              "Failed to init LS filter");
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "LS filter should be symmetric");
+
+    // Folded convolution equals direct one, odd and even lengths, short input
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv_full(x, X_LEN, filter.b, filter.b_len, y_ref),
+              "Conv did not work");
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv_full_symmetric(x, X_LEN, filter.b, filter.b_len, y),
+              "Symmetric conv did not work");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN + filter.b_len - 1);
+    hdsp_test(10 + filter.b_len - 1 == hdsp_conv_full(x, 10, filter.b, filter.b_len, y_ref), "Conv did not work");
+    hdsp_test(10 + filter.b_len - 1 == hdsp_conv_full_symmetric(x, 10, filter.b, filter.b_len, y),
+              "Symmetric conv did not work");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, 10 + filter.b_len - 1);
+
+    hdsp_kaiser_window(w, 64, HDSP_KAISER_FILTER_BETA_DEFAULT);
+    hdsp_test(X_LEN + 64 - 1 == hdsp_conv_full(x, X_LEN, w, 64, y_ref), "Conv did not work");
+    hdsp_test(X_LEN + 64 - 1 == hdsp_conv_full_symmetric(x, X_LEN, w, 64, y), "Symmetric conv did not work");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN + 64 - 1);
+
+    // FIR filter uses folded kernel and gives the same result as direct convolution
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv(x, X_LEN, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME, y_ref,
+                                                    &idx_start, &idx_end), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_almost_double(z, (&y_ref[idx_start]), X_LEN);
+
+    // Symmetric filter with zero taps (half-band): folding and skipping combined
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, 31, 48000, 12000),
+              "Filter initialisation failed");
+    hdsp_kaiser_window(w, 31, HDSP_KAISER_FILTER_BETA_DEFAULT);
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_shape(&filter, w, 31), "Filter shaping failed");
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Half-band filter should be symmetric");
+    hdsp_test(filter.b_nz_len < filter.b_len, "Half-band filter should have zero taps");
+    hdsp_test(X_LEN + 31 - 1 == hdsp_conv(x, X_LEN, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME, y_ref,
+                                          &idx_start, &idx_end), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_almost_double(z, (&y_ref[idx_start]), X_LEN);
+
+    // Asymmetric filter keeps direct path
+    i = 0;
+    while (i < 20) {
+        filter.b[i] = 1.0 / (i + 1);
+        i = i + 1;
+    }
+    filter.b_len = 20;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_NONE, "Filter should not be symmetric");
+    hdsp_test(X_LEN + 20 - 1 == hdsp_conv(x, X_LEN, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME, y_ref,
+                                          &idx_start, &idx_end), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_double(z, (&y_ref[idx_start]), X_LEN);
+
+    // Nearly symmetric taps are symmetric, but aren't modified
+    filter.b_len = 21;
+    i = 0;
+    while (i < 21) {
+        filter.b[i] = 1.0 / (1 + (i < 10 ? i : 20 - i));
+        i = i + 1;
+    }
+    filter.b[20] += 1e-15;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Filter should be symmetric");
+    hdsp_test(filter.b[20] == 1.0 + 1e-15, "Taps should not be modified by analysis");
+
+    // Taps edited after initialisation, without analysis: filter is no longer folded
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    filter.b[0] *= 3;
+    filter.b[1] += 0.05;
+    hdsp_test(X_LEN + filter.b_len - 1 == hdsp_conv(x, X_LEN, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME, y_ref,
+                                                    &idx_start, &idx_end), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_almost_double(z, (&y_ref[idx_start]), X_LEN);
+
+    return 0;
+}
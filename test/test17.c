@@ -0,0 +1,121 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test17.c - Test FFT convolution (overlap-add and overlap-save)
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 2000
+    #define H_LEN 1500
+
+    hdsp_filter_t filter = {0};
+    hdsp_fir_stream_t stream = {0};
+    hdsp_fir_fft_stream_t fft_stream = {0};
+    int16_t x[X_LEN] = {0};
+    double h[HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double y_ref[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double y[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    int32_t idx_start = 0, idx_end = 0;
+    size_t i = 0, pos = 0, frame_len = 0;
+    size_t h_lens[] = {1, 2, 31, 32, 100, 513, H_LEN, HDSP_FIR_FILTER_LEN_MAX};
+    size_t x_lens[] = {1, 7, 160, 960, X_LEN};
+    size_t frame_lens[] = {480, 1, 37, 960, 1000, 13};
+    size_t hi = 0, xi = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+    i = 0;
+    while (i < HDSP_FIR_FILTER_LEN_MAX) {
+        h[i] = cos(i * 0.01) / (i + 1);
+        i = i + 1;
+    }
+
+    // Overlap-add equals direct convolution
+    for (hi = 0; hi < sizeof(h_lens) / sizeof(h_lens[0]); hi++) {
+        for (xi = 0; xi < sizeof(x_lens) / sizeof(x_lens[0]); xi++) {
+            size_t c_len = x_lens[xi] + h_lens[hi] - 1;
+            hdsp_test(c_len == hdsp_conv_full(x, x_lens[xi], h, h_lens[hi], y_ref), "Conv did not work");
+            hdsp_test(c_len == hdsp_conv_full_fft(x, x_lens[xi], h, h_lens[hi], y), "FFT conv did not work");
+            hdsp_test_vectors_equal_almost_double(y, y_ref, c_len);
+        }
+    }
+    hdsp_test(0 == hdsp_conv_full_fft(x, 0, h, 10, y), "Empty input should fail");
+    hdsp_test(0 == hdsp_conv_full_fft(x, 10, h, 0, y), "Empty filter should fail");
+
+    // hdsp_conv stays direct for long filters (no plan or scratch per call), result is exactly the same
+    hdsp_test(X_LEN + H_LEN - 1 == hdsp_conv_full(x, X_LEN, h, H_LEN, y_ref), "Conv did not work");
+    hdsp_test(X_LEN + H_LEN - 1 == hdsp_conv(x, X_LEN, h, H_LEN, HDSP_CONV_TYPE_SAME, y, &idx_start, &idx_end),
+              "Conv did not work");
+    hdsp_test(idx_start == H_LEN / 2 && idx_end == idx_start + X_LEN, "Wrong indices");
+    hdsp_test_vectors_equal_double(y, y_ref, X_LEN + H_LEN - 1);
+
+    // FIR filter with long filter
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, 1001, 48000, 1000),
+              "Filter initialisation failed");
+    hdsp_kaiser_window(h, 1001, HDSP_KAISER_FILTER_BETA_DEFAULT);
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_shape(&filter, h, 1001), "Filter shaping failed");
+    hdsp_test(X_LEN + 1001 - 1 == hdsp_conv_full(x, X_LEN, filter.b, filter.b_len, y_ref), "Conv did not work");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, y, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_almost_double(y, (&y_ref[1001 / 2]), X_LEN);
+
+    // Overlap-save streaming equals direct streaming, frames of different lengths (some longer than block)
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_stream_init(&stream, &filter), "Stream initialisation failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_fft_stream_init(&fft_stream, &filter, 480),
+              "FFT stream initialisation failed");
+    hdsp_test(fft_stream.fft_len == 1500, "Wrong FFT length");
+    hdsp_test(hdsp_fir_fft_stream_delay(&fft_stream) == hdsp_fir_stream_delay(&stream), "Wrong delay");
+    pos = 0;
+    i = 0;
+    while (pos < X_LEN) {
+        frame_len = hdsp_min(frame_lens[i % (sizeof(frame_lens) / sizeof(frame_lens[0]))], X_LEN - pos);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_stream(&x[pos], frame_len, &stream, &y_ref[pos], frame_len),
+                  "Stream filtering failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_fft_stream(&x[pos], frame_len, &fft_stream, &y[pos], frame_len),
+                  "FFT stream filtering failed");
+        pos = pos + frame_len;
+        i = i + 1;
+    }
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN);
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_fft_stream(x, 10, &fft_stream, y, 9), "Short output should fail");
+    hdsp_fir_fft_stream_deinit(&fft_stream);
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_fft_stream(x, 10, &fft_stream, y, 10),
+              "Deinitialised stream should fail");
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test18.c - Test FFT against naive DFT
+ */
+
+
+#include "hdsp.h"
+#include <time.h>
+
+#define N_MAX 1920
+
+static void dft(double *x, double *y, size_t n, double sgn)
+{
+    size_t k = 0, t = 0;
+
+    for (k = 0; k < n; k++) {
+        y[2 * k] = 0.0;
+        y[2 * k + 1] = 0.0;
+        for (t = 0; t < n; t++) {
+            double a = sgn * 2.0 * M_PI * (double) ((k * t) % n) / n;
+            y[2 * k] += x[2 * t] * cos(a) - x[2 * t + 1] * sin(a);
+            y[2 * k + 1] += x[2 * t] * sin(a) + x[2 * t + 1] * cos(a);
+        }
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+
+    static double x[2 * N_MAX], y[2 * N_MAX + 2], y_ref[2 * N_MAX], z[2 * N_MAX], r[2 * N_MAX];
+    size_t lens[] = {1, 2, 3, 4, 5, 6, 8, 12, 15, 16, 20, 30, 32, 60, 64, 96, 120, 160, 240, 256, 480, 960, 1024, 1920};
+    hdsp_fft_plan_t plan = {0};
+    size_t i = 0, k = 0, n = 0, reps = 0;
+    double t_fft = 0.0, t_dft = 0.0;
+
+    i = 0;
+    while (i < 2 * N_MAX) {
+        x[i] = sin(i * 0.37) + cos(i * i * 0.011);
+        i = i + 1;
+    }
+
+    hdsp_test(hdsp_fft_len_ceil(0) == 1, "Wrong FFT length");
+    hdsp_test(hdsp_fft_len_ceil(7) == 8, "Wrong FFT length");
+    hdsp_test(hdsp_fft_len_ceil(470) == 480, "Wrong FFT length");
+    hdsp_test(hdsp_fft_len_ceil(961) == 972, "Wrong FFT length");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fft_plan_init(&plan, 7, HDSP_FFT_TYPE_COMPLEX), "Length 7 should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fft_plan_init(&plan, 15, HDSP_FFT_TYPE_REAL), "Odd real length should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fft_plan_init(&plan, 0, HDSP_FFT_TYPE_COMPLEX), "Length 0 should fail");
+
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        n = lens[i];
+
+        // complex, forward and inverse
+        hdsp_test(HDSP_STATUS_OK == hdsp_fft_plan_init(&plan, n, HDSP_FFT_TYPE_COMPLEX), "Plan init failed");
+        dft(x, y_ref, n, -1.0);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fft(&plan, x, y), "FFT failed");
+        hdsp_test_vectors_equal_almost_double(y, y_ref, 2 * n);
+        dft(x, y_ref, n, 1.0);
+        hdsp_test(HDSP_STATUS_OK == hdsp_ifft(&plan, x, y), "IFFT failed");
+        hdsp_test_vectors_equal_almost_double(y, y_ref, 2 * n);
+        hdsp_test(HDSP_STATUS_FALSE == hdsp_fft(&plan, x, x), "In place transform should fail");
+        hdsp_test(HDSP_STATUS_FALSE == hdsp_fft_real(&plan, x, y), "Real transform with complex plan should fail");
+        hdsp_fft_plan_deinit(&plan);
+
+        // real, forward and inverse
+        if (n % 2) {
+            continue;
+        }
+        hdsp_test(HDSP_STATUS_OK == hdsp_fft_plan_init(&plan, n, HDSP_FFT_TYPE_REAL), "Plan init failed");
+        for (k = 0; k < n; k++) {
+            z[2 * k] = x[k];
+            z[2 * k + 1] = 0.0;
+        }
+        dft(z, y_ref, n, -1.0);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fft_real(&plan, x, y), "Real FFT failed");
+        hdsp_test_vectors_equal_almost_double(y, y_ref, n + 2);
+        hdsp_test(HDSP_STATUS_OK == hdsp_ifft_real(&plan, y, r), "Real IFFT failed");
+        for (k = 0; k < n; k++) {
+            r[k] = r[k] / n;
+        }
+        hdsp_test_vectors_equal_almost_double(r, x, n);
+        hdsp_fft_plan_deinit(&plan);
+    }
+
+    // FFT vs DFT time, 960 points
+    hdsp_test(HDSP_STATUS_OK == hdsp_fft_plan_init(&plan, 960, HDSP_FFT_TYPE_COMPLEX), "Plan init failed");
+    reps = 100;
+    t_fft = now();
+    for (i = 0; i < reps; i++) {
+        hdsp_fft(&plan, x, y);
+    }
+    t_fft = (now() - t_fft) / reps;
+    t_dft = now();
+    dft(x, y_ref, 960, -1.0);
+    t_dft = now() - t_dft;
+    hdsp_test_vectors_equal_almost_double(y, y_ref, 2 * 960);
+    printf("960 points: FFT %f us, DFT %f us\n", t_fft * 1e6, t_dft * 1e6);
+    hdsp_fft_plan_deinit(&plan);
+
+    return 0;
+}
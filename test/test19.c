@@ -0,0 +1,103 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test19.c - Test uniformly partitioned convolution
+ */
+
+
+#include "hdsp.h"
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 4800
+
+    hdsp_filter_t filter = {0};
+    hdsp_fir_stream_t stream = {0};
+    hdsp_fir_part_stream_t part = {0};
+    int16_t x[X_LEN] = {0};
+    double w[HDSP_FIR_FILTER_LEN_MAX] = {0};
+    static double y_ref[X_LEN], y[X_LEN];
+    size_t b_lens[] = {2, 31, 48, 480, 1001, HDSP_FIR_FILTER_LEN_MAX};
+    size_t block_lens[] = {48, 480};
+    size_t blocks_per_frame[] = {1, 3, 2, 10};
+    size_t i = 0, bi = 0, li = 0, pos = 0, frame_len = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    for (bi = 0; bi < sizeof(b_lens) / sizeof(b_lens[0]); bi++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, b_lens[bi],
+                                                                                      48000, 4000),
+                  "Filter initialisation failed");
+        hdsp_kaiser_window(w, b_lens[bi], HDSP_KAISER_FILTER_BETA_DEFAULT);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_shape(&filter, w, b_lens[bi]), "Filter shaping failed");
+
+        for (li = 0; li < sizeof(block_lens) / sizeof(block_lens[0]); li++) {
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_stream_init(&stream, &filter), "Stream initialisation failed");
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_part_stream_init(&part, &filter, block_lens[li]),
+                      "Partitioned stream initialisation failed");
+            hdsp_test(part.n_parts == (b_lens[bi] + block_lens[li] - 1) / block_lens[li],
+                      "Wrong number of partitions");
+            hdsp_test(hdsp_fir_part_stream_delay(&part) == hdsp_fir_stream_delay(&stream), "Wrong delay");
+
+            // frames of different number of blocks give the same output as direct streaming filter
+            pos = 0;
+            i = 0;
+            while (pos < X_LEN) {
+                frame_len = blocks_per_frame[i % (sizeof(blocks_per_frame) / sizeof(blocks_per_frame[0]))]
+                            * block_lens[li];
+                frame_len = hdsp_min(frame_len, X_LEN - pos);
+                hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_stream(&x[pos], frame_len, &stream,
+                                                                   &y_ref[pos], frame_len),
+                          "Stream filtering failed");
+                hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_part_stream(&x[pos], frame_len, &part,
+                                                                        &y[pos], frame_len),
+                          "Partitioned stream filtering failed");
+                pos = pos + frame_len;
+                i = i + 1;
+            }
+            hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN);
+
+            hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_part_stream(x, block_lens[li] + 1, &part, y, X_LEN),
+                      "Frame not made of whole blocks should fail");
+            hdsp_fir_part_stream_deinit(&part);
+        }
+    }
+
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_part_stream_init(&part, &filter, 0), "Block length 0 should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_part_stream_init(&part, &filter, 7), "Block length 7 should fail");
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test20.c - Test SIMD kernels of convolution
+ */
+
+
+#include "hdsp.h"
+#include <time.h>
+
+static void conv_ref(int16_t *x, size_t x_len, double *h, size_t h_len, double *y)
+{
+    size_t t = 0, tau = 0;
+
+    for (t = 0; t < x_len + h_len - 1; t++) {
+        y[t] = 0.0;
+        for (tau = 0; tau < x_len; tau++) {
+            if (t >= tau && t - tau < h_len) {
+                y[t] += x[tau] * h[t - tau];
+            }
+        }
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+
+    #define X_LEN 960
+    #define H_LEN 255
+
+    const char *names[] = {"none", "sse2", "avx2", "avx512", "neon"};
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    int16_t x[X_LEN] = {0};
+    double h[H_LEN] = {0};
+    double y_ref[X_LEN + H_LEN] = {0};
+    double y[X_LEN + H_LEN] = {0};
+    double z[X_LEN] = {0};
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    size_t i = 0, k = 0, h_len = 0, x_len = 0, reps = 0;
+    double t = 0.0, t_dense = 0.0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 48000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+    // extremes of int16 range must be converted correctly
+    x[1] = INT16_MIN;
+    x[2] = INT16_MAX;
+    x[17] = INT16_MIN;
+    i = 0;
+    while (i < H_LEN) {
+        h[i] = cos(i * 0.1) / (i + 1);
+        i = i + 1;
+    }
+
+    printf("default instruction set: %s\n", names[isa_default]);
+    hdsp_test(hdsp_simd_set(HDSP_SIMD_NONE) == HDSP_STATUS_OK, "Scalar kernel should be always supported");
+
+    for (k = 0; k < sizeof(isa) / sizeof(isa[0]); k++) {
+        if (hdsp_simd_set(isa[k]) != HDSP_STATUS_OK) {
+            printf("%s: not supported\n", names[k]);
+            continue;
+        }
+        hdsp_test(hdsp_simd_get() == isa[k], "Wrong instruction set");
+
+        // all lengths up to vector tails, filter shorter and longer than signal
+        for (h_len = 1; h_len <= 40; h_len++) {
+            for (x_len = 1; x_len <= 40; x_len += 3) {
+                conv_ref(x, x_len, h, h_len, y_ref);
+                hdsp_test(x_len + h_len - 1 == hdsp_conv_full(x, x_len, h, h_len, y), "Conv did not work");
+                hdsp_test_vectors_equal_almost_double(y, y_ref, x_len + h_len - 1);
+            }
+        }
+        conv_ref(x, X_LEN, h, H_LEN, y_ref);
+        reps = 20;
+        t = now();
+        for (i = 0; i < reps; i++) {
+            hdsp_test(X_LEN + H_LEN - 1 == hdsp_conv_full(x, X_LEN, h, H_LEN, y), "Conv did not work");
+        }
+        t = (now() - t) / reps;
+        hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN + H_LEN - 1);
+        printf("%s: %zu x %zu convolution in %f us\n", names[k], (size_t) X_LEN, (size_t) H_LEN, t * 1e6);
+
+        // mirrored taps folded by vector kernels, for filters shorter and longer than signal
+        for (h_len = 1; h_len <= 41; h_len += 2) {
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, h_len, 48000,
+                                                                                         12000), "Filter failed");
+            for (x_len = 1; x_len <= 40; x_len += 3) {
+                conv_ref(x, x_len, filter.b, h_len, y_ref);
+                hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, x_len, &filter, z, x_len), "FIR filtering failed");
+                hdsp_test_vectors_equal_almost_double(z, (&y_ref[h_len / 2]), x_len);
+            }
+            filter.b[0] = 0.5; // asymmetric, zero taps only
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter), "Analysis failed");
+            conv_ref(x, 40, filter.b, h_len, y_ref);
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, 40, &filter, z, 40), "FIR filtering failed");
+            hdsp_test_vectors_equal_almost_double(z, (&y_ref[h_len / 2]), 40);
+        }
+
+        // half-band filter: 3/4 of the taps are zero or mirrored (compact filter), vs zero taps multiplied too
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_by_spectrum_sampling(&filter, H_LEN, 48000, 12000),
+                  "Filter failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_init_from_filter(&fir, &filter), "Compact filter failed");
+        reps = 200;
+        t = now();
+        for (i = 0; i < reps; i++) {
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(x, X_LEN, &fir, y, X_LEN), "FIR filtering failed");
+        }
+        t = (now() - t) / reps;
+        hdsp_fir_deinit(&fir);
+        t_dense = now();
+        for (i = 0; i < reps; i++) {
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, z, X_LEN), "FIR filtering failed");
+        }
+        t_dense = (now() - t_dense) / reps;
+        hdsp_test_vectors_equal_almost_double(y, z, X_LEN);
+        printf("%s: %zu x %zu half-band FIR in %f us (%f us with zero taps multiplied)\n", names[k], (size_t) X_LEN,
+               (size_t) H_LEN, t * 1e6, t_dense * 1e6);
+    }
+
+    hdsp_test(hdsp_simd_set(isa_default) == HDSP_STATUS_OK, "Failed to restore instruction set");
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test21.c - Test single precision (float) processing path
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 960
+#define Y_MAX (6 * X_LEN)
+
+/**
+ * Returns the largest absolute difference between float and double vectors.
+ */
+static double max_error(float *a, double *b, size_t len)
+{
+    size_t i = 0;
+    double e = 0.0;
+
+    for (i = 0; i < len; i++) {
+        e = hdsp_max(e, fabs((double) a[i] - b[i]));
+    }
+    return e;
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_filter_t filter = {0};
+    hdsp_filter_float_t filter_float = {0};
+    hdsp_interp_t interp = {0};
+    hdsp_interp_float_t interp_float = {0};
+    hdsp_decim_t decim = {0};
+    hdsp_decim_float_t decim_float = {0};
+    hdsp_resampler_t resampler = {0};
+    hdsp_resampler_float_t resampler_float = {0};
+    int16_t x[X_LEN] = {0};
+    int16_t x16[Y_MAX] = {0};
+    float xf[Y_MAX] = {0};
+    float yf[Y_MAX + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    float zf[X_LEN] = {0};
+    double y[Y_MAX + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double z[X_LEN] = {0};
+    size_t i = 0, k = 0, n = 0, n_float = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 8000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+    hdsp_int16_2_float(x, X_LEN, xf);
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(HDSP_STATUS_OK == hdsp_filter_float_init(&filter_float, &filter), "Float filter init failed");
+    hdsp_test(filter_float.b_len == filter.b_len, "Wrong filter length");
+    hdsp_test(filter_float.b[filter.b_len / 2] == (float) filter.b[filter.b_len / 2], "Wrong tap");
+
+    for (k = 0; k < sizeof(isa) / sizeof(isa[0]); k++) {
+        if (hdsp_simd_set(isa[k]) != HDSP_STATUS_OK) {
+            continue;
+        }
+
+        // convolution
+        for (n = 1; n <= 40; n++) {
+            hdsp_test(n + filter.b_len - 1 == hdsp_conv_full(x, n, filter.b, filter.b_len, y), "Conv did not work");
+            hdsp_test(n + filter.b_len - 1 == hdsp_conv_full_float(xf, n, filter_float.b, filter_float.b_len, yf),
+                      "Float conv did not work");
+            hdsp_test(max_error(yf, y, n + filter.b_len - 1) < 0.01, "Float conv differs");
+        }
+
+        // FIR filter
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, y, X_LEN), "FIR filtering failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_float(xf, X_LEN, &filter_float, yf, X_LEN),
+                  "Float FIR filtering failed");
+        hdsp_test(max_error(yf, y, X_LEN) < 0.01, "Float FIR filter differs");
+    }
+    hdsp_test(hdsp_simd_set(isa_default) == HDSP_STATUS_OK, "Failed to restore instruction set");
+
+    // 8 kHz -> 48 kHz -> 8 kHz chain, polyphase interpolator and decimator
+    hdsp_test(HDSP_STATUS_OK == hdsp_interp_init(&interp, &filter, 6), "Interp init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_interp_float_init(&interp_float, &filter_float, 6), "Float interp init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_interpolate(x, X_LEN, &interp, y, 6 * X_LEN), "Interpolation failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_interpolate_float(xf, X_LEN, &interp_float, yf, 6 * X_LEN),
+              "Float interpolation failed");
+    hdsp_test(max_error(yf, y, 6 * X_LEN) < 0.01, "Float interpolation differs");
+
+    hdsp_double_2_int16(y, 6 * X_LEN, x16);
+    hdsp_int16_2_float(x16, 6 * X_LEN, xf);
+    hdsp_test(HDSP_STATUS_OK == hdsp_decim_init(&decim, &filter, 6), "Decim init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_decim_float_init(&decim_float, &filter_float, 6), "Float decim init failed");
+    for (i = 0; i < 6 * X_LEN; i += 6 * 160) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_decimate(&x16[i], 6 * 160, &decim, &z[i / 6], 160), "Decimation failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_decimate_float(&xf[i], 6 * 160, &decim_float, &zf[i / 6], 160),
+                  "Float decimation failed");
+    }
+    hdsp_test(max_error(zf, z, X_LEN) < 0.01, "Float decimation differs");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_decimate_float(xf, 7, &decim_float, zf, 1), "Partial frame should fail");
+
+    // rational resampler, 44100 -> 48000, frame by frame
+    hdsp_int16_2_float(x, X_LEN, xf);
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, 44100, 48000), "Resampler init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_float_init(&resampler_float, 44100, 48000),
+              "Float resampler init failed");
+    hdsp_test(hdsp_resampler_float_delay(&resampler_float) == hdsp_resampler_delay(&resampler), "Wrong delay");
+    n = 0;
+    n_float = 0;
+    for (i = 0; i < X_LEN; i += 96) {
+        size_t written = 0, written_float = 0;
+        hdsp_test(hdsp_resampler_float_output_len(&resampler_float, 96) == hdsp_resampler_output_len(&resampler, 96),
+                  "Wrong output length");
+        hdsp_test(HDSP_STATUS_OK == hdsp_resample(&x[i], 96, &resampler, &y[n], Y_MAX - n, &written),
+                  "Resampling failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_resample_float(&xf[i], 96, &resampler_float, &yf[n_float], Y_MAX - n_float,
+                                                        &written_float), "Float resampling failed");
+        n = n + written;
+        n_float = n_float + written_float;
+    }
+    hdsp_test(n == n_float, "Different number of output samples");
+    hdsp_test(max_error(yf, y, n) < 0.01, "Float resampling differs");
+    hdsp_resampler_deinit(&resampler);
+    hdsp_resampler_float_deinit(&resampler_float);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test22.c - Test fixed-point (Q15) FIR filter
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 960
+
+/**
+ * Reference fixed-point convolution, 64-bit accumulation, round half up, saturation.
+ */
+static void conv_full_q15_ref(int16_t *x, size_t x_len, hdsp_filter_q15_t *filter, int16_t *y)
+{
+    size_t t = 0, tau = 0, h_len = filter->b_len;
+    int64_t acc = 0;
+
+    for (t = 0; t < x_len + h_len - 1; t++) {
+        acc = 0;
+        for (tau = 0; tau < x_len; tau++) {
+            if (t >= tau && t - tau < h_len) {
+                acc += (int64_t) x[tau] * filter->b_rev[h_len - 1 - (t - tau)];
+            }
+        }
+        acc = (acc + (filter->shift > 0 ? (INT64_C(1) << (filter->shift - 1)) : 0)) >> filter->shift;
+        y[t] = (int16_t) hdsp_max(INT16_MIN, hdsp_min(INT16_MAX, acc));
+    }
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_filter_t filter = {0};
+    hdsp_filter_q15_t filter_q15 = {0};
+    int16_t x[X_LEN] = {0};
+    int16_t y[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    int16_t y_ref[X_LEN + HDSP_FIR_FILTER_LEN_MAX] = {0};
+    double snr_db = 0.0;
+    size_t i = 0, k = 0, n = 0, b_q_abs_sum = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 8000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(HDSP_STATUS_OK == hdsp_filter_q15_init(&filter_q15, &filter), "Q15 filter init failed");
+    hdsp_test(filter_q15.b_len == filter.b_len, "Wrong filter length");
+    hdsp_test(filter_q15.shift >= 15, "Block scaling should keep at least Q15 precision");
+    for (k = 0; k < filter.b_len; k++) {
+        hdsp_test(fabs(filter_q15.b_rev[filter.b_len - 1 - k] - ldexp(filter.b[k], filter_q15.shift)) <= 0.5,
+                  "Wrong tap quantization");
+        b_q_abs_sum += abs(filter_q15.b_rev[k]);
+    }
+    hdsp_test((double) b_q_abs_sum * 32768 < 2147483648.0, "Accumulator may overflow");
+
+    // integer kernels are exact, all instruction sets give the same result as the reference
+    for (k = 0; k < sizeof(isa) / sizeof(isa[0]); k++) {
+        if (hdsp_simd_set(isa[k]) != HDSP_STATUS_OK) {
+            continue;
+        }
+        for (n = 1; n <= 80; n++) {
+            conv_full_q15_ref(x, n, &filter_q15, y_ref);
+            hdsp_test(n + filter.b_len - 1 == hdsp_conv_full_q15(x, n, &filter_q15, y), "Q15 conv did not work");
+            hdsp_test(0 == memcmp(y, y_ref, (n + filter.b_len - 1) * sizeof(int16_t)), "Q15 conv differs");
+        }
+        conv_full_q15_ref(x, X_LEN, &filter_q15, y_ref);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_q15(x, X_LEN, &filter_q15, y, X_LEN), "Q15 FIR filtering failed");
+        hdsp_test(0 == memcmp(y, &y_ref[filter.b_len / 2], X_LEN * sizeof(int16_t)), "Q15 FIR filter differs");
+    }
+    hdsp_test(hdsp_simd_set(isa_default) == HDSP_STATUS_OK, "Failed to restore instruction set");
+
+    // SNR against double precision
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_q15_snr(&filter_q15, &filter, x, X_LEN, &snr_db), "SNR failed");
+    printf("Q15 FIR (%zu taps, shift %d): SNR %f dB\n", filter_q15.b_len, filter_q15.shift, snr_db);
+    hdsp_test(snr_db > 60.0, "Q15 SNR too low");
+
+    // gain > 1 on full scale input saturates instead of wrapping
+    memset(&filter, 0, sizeof(filter));
+    filter.b[0] = 1.5;
+    filter.b[1] = 1.5;
+    filter.b_len = 2;
+    hdsp_test(HDSP_STATUS_OK == hdsp_filter_q15_init(&filter_q15, &filter), "Q15 filter init failed");
+    for (i = 0; i < X_LEN; i++) {
+        x[i] = (i % 2) ? INT16_MIN : INT16_MAX;
+        x[i] = (i < X_LEN / 2) ? INT16_MAX : x[i];
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_q15(x, X_LEN, &filter_q15, y, X_LEN), "Q15 FIR filtering failed");
+    hdsp_test(y[10] == INT16_MAX, "Output should saturate");
+    hdsp_test(y[X_LEN - 2] == -1, "Wrong alternating output"); // 1.5 * (32767 - 32768), rounded
+    hdsp_test(y[X_LEN - 1] == INT16_MIN, "Output should saturate");
+
+    // errors
+    memset(&filter, 0, sizeof(filter));
+    filter.b_len = 3;
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_filter_q15_init(&filter_q15, &filter), "Zero taps should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_q15(x, X_LEN, &filter_q15, y, X_LEN - 1), "Short y should fail");
+
+    return 0;
+}
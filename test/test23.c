@@ -0,0 +1,114 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test23.c - Test 'same' and 'valid' convolution computed directly into output
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 400
+#define H_LEN 100
+
+int main(int argc, char **argv) {
+
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_filter_t filter = {0};
+    int16_t x[X_LEN] = {0};
+    double h[H_LEN] = {0};
+    double y_full[X_LEN + H_LEN - 1] = {0};
+    double y[X_LEN + 1] = {0};
+    double y_filter[X_LEN] = {0};
+    double *y_ref = NULL;
+    int32_t idx_start = 0, idx_end = 0;
+    size_t i = 0, k = 0, x_len = 0, h_len = 0;
+    uint16_t x_lens[] = {1, 2, 7, 31, 32, 99, 100, 101, 257, X_LEN};
+    uint16_t h_lens[] = {1, 2, 5, 31, 32, 33, 64, H_LEN};
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 8000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+    for (i = 0; i < H_LEN; i++) {
+        h[i] = sin(0.1 * i + 0.3) / (1.0 + i);
+    }
+
+    // short and long filters against the window of full-length convolution
+    for (i = 0; i < sizeof(x_lens) / sizeof(x_lens[0]); i++) {
+        for (k = 0; k < sizeof(h_lens) / sizeof(h_lens[0]); k++) {
+            x_len = x_lens[i];
+            h_len = h_lens[k];
+            hdsp_test(x_len + h_len - 1 == hdsp_conv(x, x_len, h, h_len, HDSP_CONV_TYPE_SAME, y_full,
+                                                     &idx_start, &idx_end), "Conv failed");
+            y[x_len] = 12345.0;
+            hdsp_test(x_len == hdsp_conv_same(x, x_len, h, h_len, y), "Same conv failed");
+            y_ref = &y_full[idx_start];
+            hdsp_test_vectors_equal_almost_double(y, y_ref, x_len);
+            hdsp_test(y[x_len] == 12345.0, "Same conv wrote past the output");
+
+            hdsp_test(x_len + h_len - 1 == hdsp_conv(x, x_len, h, h_len, HDSP_CONV_TYPE_VALID, y_full,
+                                                     &idx_start, &idx_end), "Conv failed");
+            if (x_len < h_len) {
+                hdsp_test(idx_start == -1 && 0 == hdsp_conv_valid(x, x_len, h, h_len, y), "Valid conv should be empty");
+                continue;
+            }
+            y[x_len - h_len + 1] = 12345.0;
+            hdsp_test(x_len - h_len + 1 == hdsp_conv_valid(x, x_len, h, h_len, y), "Valid conv failed");
+            y_ref = &y_full[idx_start];
+            hdsp_test_vectors_equal_almost_double(y, y_ref, x_len - h_len + 1);
+            hdsp_test(y[x_len - h_len + 1] == 12345.0, "Valid conv wrote past the output");
+        }
+    }
+
+    // FIR filter writes the 'same' part directly, all kernels (folded, sparse, plain)
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    for (k = 0; k < 2; k++) {
+        hdsp_test(k == 0 || hdsp_simd_set(HDSP_SIMD_NONE) == HDSP_STATUS_OK, "Failed to select scalar kernels");
+        for (i = 0; i < sizeof(x_lens) / sizeof(x_lens[0]); i++) {
+            x_len = x_lens[i];
+            hdsp_test(x_len + filter.b_len - 1 == hdsp_conv(x, x_len, filter.b, filter.b_len, HDSP_CONV_TYPE_SAME,
+                                                            y_full, &idx_start, &idx_end), "Conv failed");
+            y_filter[x_len - 1] = 0.0;
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, x_len, &filter, y_filter, x_len), "FIR filtering failed");
+            y_ref = &y_full[idx_start];
+            hdsp_test_vectors_equal_almost_double(y_filter, y_ref, x_len);
+        }
+    }
+    hdsp_test(hdsp_simd_set(isa_default) == HDSP_STATUS_OK, "Failed to restore instruction set");
+
+    hdsp_test(0 == hdsp_conv_same(NULL, 1, h, 1, y), "NULL input should fail");
+    hdsp_test(0 == hdsp_conv_valid(x, 1, h, 0, y), "Empty filter should fail");
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test24.c - Test FIR filtering context with caller's workspace
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 960
+#define LONG_LEN 600
+
+int main(int argc, char **argv) {
+
+    hdsp_filter_t filter = {0};
+    hdsp_filter_t filter_long = {0};
+    hdsp_fir_ctx_t ctx = {0};
+    int16_t x[X_LEN] = {0};
+    double y[X_LEN] = {0};
+    double y_ref[X_LEN] = {0};
+    double *workspace = NULL;
+    size_t i = 0, n = 0, size = 0, len = 0;
+    size_t frame_lens[] = {1, 31, 160, 333, X_LEN};
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 8000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    // long enough to be convolved by FFT with any instruction set
+    filter_long.b_len = LONG_LEN;
+    for (i = 0; i < LONG_LEN; i++) {
+        filter_long.b[i] = sin(0.05 * i + 0.2) / (1.0 + 0.1 * i);
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_analyse(&filter_long), "Filter analysis failed");
+
+    // workspace from caller
+    size = hdsp_fir_ctx_workspace_size(X_LEN, LONG_LEN);
+    hdsp_test(size > 0, "Long filter needs workspace");
+    workspace = malloc(size);
+    hdsp_test(workspace != NULL, "Out of memory");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_ctx_init(&ctx, X_LEN, LONG_LEN, workspace, size - 1),
+              "Too small workspace should fail");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_init(&ctx, X_LEN, LONG_LEN, workspace, size), "Context init failed");
+    hdsp_test(ctx.fft_len > 0 && ctx.workspace == workspace && !ctx.workspace_owned, "Wrong workspace");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_ctx(&ctx, x, X_LEN, y, X_LEN), "No filter should fail");
+
+    // both filters, frames of different lengths, same as hdsp_fir_filter
+    for (n = 0; n < 2; n++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_set_filter(&ctx, n ? &filter_long : &filter), "Set filter failed");
+        for (i = 0; i < sizeof(frame_lens) / sizeof(frame_lens[0]); i++) {
+            // macro has its own loop index i
+            len = frame_lens[i];
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, len, ctx.filter, y_ref, X_LEN), "FIR filtering failed");
+            hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_ctx(&ctx, x, len, y, X_LEN),
+                      "FIR filtering with context failed");
+            hdsp_test_vectors_equal_almost_double(y, y_ref, len);
+        }
+    }
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_ctx(&ctx, x, X_LEN + 1, y, X_LEN + 1), "Long frame should fail");
+    hdsp_fir_ctx_deinit(&ctx);
+    free(workspace);
+
+    // workspace allocated by context
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_init(&ctx, 160, filter.b_len, NULL, 0), "Context init failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_ctx_set_filter(&ctx, &filter_long), "Too long filter should fail");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_set_filter(&ctx, &filter), "Set filter failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, 160, &filter, y_ref, 160), "FIR filtering failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_ctx(&ctx, x, 160, y, 160), "FIR filtering with context failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, 160);
+    hdsp_fir_ctx_deinit(&ctx);
+
+    // short filter needs no workspace
+    hdsp_test(0 == hdsp_fir_ctx_workspace_size(X_LEN, 7), "Short filter needs no workspace");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_init(&ctx, X_LEN, 7, NULL, 0), "Context init failed");
+    hdsp_test(ctx.fft_len == 0 && ctx.workspace == NULL, "Short filter needs no workspace");
+    hdsp_fir_ctx_deinit(&ctx);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test25.c - Test compact FIR filter handle
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 960
+#define LONG_LEN 5000
+
+int main(int argc, char **argv) {
+
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    hdsp_fir_t view = {0};
+    hdsp_fir_ctx_t ctx = {0};
+    int16_t x[X_LEN] = {0};
+    double y[X_LEN] = {0};
+    double y_ref[X_LEN] = {0};
+    double *b = NULL;
+    size_t i = 0;
+
+    while (i < X_LEN) {
+        x[i] = 8000 * sin((double)i * 2 * M_PI * 440 / 8000) + (int16_t) (i * 7919 % 2000) - 1000;
+        i = i + 1;
+    }
+
+    printf("sizeof(hdsp_filter_t) %zu, sizeof(hdsp_fir_t) %zu\n", sizeof(hdsp_filter_t), sizeof(hdsp_fir_t));
+    hdsp_test(sizeof(hdsp_fir_t) < 128, "Handle should be compact");
+    hdsp_test(sizeof(hdsp_filter_t) < 2 * HDSP_FIR_FILTER_LEN_MAX * sizeof(double) + 128,
+              "Filter should hold taps only (no indices of non-zero taps)");
+
+    // handle from filter, same result as hdsp_fir_filter
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init_from_filter(&fir, &filter), "Compact filter init failed");
+    hdsp_test(((uintptr_t) fir.b % HDSP_FIR_ALIGN) == 0, "Taps not aligned");
+    hdsp_test(fir.b_len == filter.b_len && fir.b_nz_len == filter.b_nz_len && fir.symmetry == filter.symmetry,
+              "Wrong analysis");
+    hdsp_test(0 == memcmp(fir.b, filter.b, filter.b_len * sizeof(double)), "Wrong taps");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, y_ref, X_LEN), "FIR filtering failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(x, X_LEN, &fir, y, X_LEN), "Compact filtering failed");
+    hdsp_test_vectors_equal_double(y, y_ref, X_LEN);
+
+    // view of filter
+    view = hdsp_fir_view(&filter);
+    hdsp_test(view.b == filter.b && view.mem == NULL, "View should borrow taps");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(x, X_LEN, &view, y, X_LEN), "View filtering failed");
+    hdsp_test_vectors_equal_double(y, y_ref, X_LEN);
+    hdsp_fir_deinit(&view);
+
+    // context with handle
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_init(&ctx, X_LEN, fir.b_len, NULL, 0), "Context init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_ctx_set_fir(&ctx, &fir), "Set filter failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_ctx(&ctx, x, X_LEN, y, X_LEN), "FIR filtering with context failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN);
+    hdsp_fir_ctx_deinit(&ctx);
+    hdsp_fir_deinit(&fir);
+    hdsp_test(fir.b == NULL && fir.b_len == 0, "Deinit should reset handle");
+
+    // longer than hdsp_filter_t can hold
+    b = malloc(LONG_LEN * sizeof(double));
+    hdsp_test(b != NULL, "Out of memory");
+    for (i = 0; i < LONG_LEN; i++) {
+        b[i] = (i % 3) ? sin(0.01 * i) / (1.0 + 0.01 * i) : 0.0;
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init(&fir, b, LONG_LEN, 48000, 4000), "Compact filter init failed");
+    hdsp_test(fir.b_nz_len < LONG_LEN && fir.symmetry == HDSP_FILTER_SYMMETRY_NONE, "Wrong analysis");
+    hdsp_test(X_LEN == hdsp_conv_same(x, X_LEN, b, LONG_LEN, y_ref), "Same conv failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(x, X_LEN, &fir, y, X_LEN), "Compact filtering failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, X_LEN);
+    hdsp_fir_deinit(&fir);
+    free(b);
+
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_init(&fir, y, 0, 48000, 4000), "Empty filter should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_compact(x, X_LEN, &fir, y, X_LEN), "Empty filter should fail");
+
+    return 0;
+}
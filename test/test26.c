@@ -0,0 +1,131 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test26.c - Test batched multi-channel FIR filtering
+ */
+
+
+#include "hdsp.h"
+
+#define N_CHANNELS 300
+#define X_LEN 160
+#define LONG_LEN 600
+#define SHORT_LEN 31
+
+static int16_t x[N_CHANNELS * X_LEN];
+static int16_t xi[N_CHANNELS * X_LEN];
+static int16_t xd[N_CHANNELS * X_LEN];
+static double y[N_CHANNELS * X_LEN];
+static double yi[N_CHANNELS * X_LEN];
+
+int main(int argc, char **argv) {
+
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir[3] = {{0}};
+    int16_t *xp[N_CHANNELS] = {0};
+    double *yp[N_CHANNELS] = {0};
+    double y_ref[X_LEN] = {0};
+    double b[LONG_LEN] = {0};
+    size_t c = 0, t = 0, k = 0, f = 0, n = 0;
+    size_t n_channels[] = {1, 3, 37, N_CHANNELS};
+    size_t x_lens[] = {20, X_LEN};
+
+    for (c = 0; c < N_CHANNELS; c++) {
+        for (t = 0; t < X_LEN; t++) {
+            x[c * X_LEN + t] = 8000 * sin((double)t * 2 * M_PI * (100 + 10 * c) / 8000)
+                               + (int16_t) ((t + c) * 7919 % 2000) - 1000;
+            xi[t * N_CHANNELS + c] = x[c * X_LEN + t];
+        }
+        xp[c] = &x[c * X_LEN];
+        yp[c] = &y[c * X_LEN];
+    }
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init_from_filter(&fir[0], &filter), "Compact filter init failed");
+    for (k = 0; k < LONG_LEN; k++) {
+        b[k] = sin(0.05 * k + 0.2) / (1.0 + 0.1 * k);
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init(&fir[1], b, LONG_LEN, 48000, 4000), "Compact filter init failed");
+    // asymmetric with a zero tap, shorter than frame
+    b[5] = 0.0;
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init(&fir[2], b, SHORT_LEN, 48000, 4000), "Compact filter init failed");
+
+    for (k = 0; k < sizeof(isa) / sizeof(isa[0]); k++) {
+        if (hdsp_simd_set(isa[k]) != HDSP_STATUS_OK) {
+            continue;
+        }
+        for (f = 0; f < 3; f++) {
+            for (n = 0; n < sizeof(x_lens) / sizeof(x_lens[0]); n++) {
+                // planar, channels read first x_lens[n] samples of each frame
+                hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_batch(xp, N_CHANNELS, x_lens[n], &fir[f], yp, X_LEN),
+                          "Batch filtering failed");
+                for (c = 0; c < N_CHANNELS; c += 13) {
+                    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(xp[c], x_lens[n], &fir[f], y_ref, X_LEN),
+                              "Compact filtering failed");
+                    hdsp_test_vectors_equal_almost_double(yp[c], y_ref, x_lens[n]);
+                }
+            }
+            // interleaved, first n_channels[n] channels packed densely, frames shorter than filter use no
+            // register-blocked kernel
+            for (n = 0; n < sizeof(n_channels) / sizeof(n_channels[0]) * 2; n++) {
+                for (t = 0; t < X_LEN; t++) {
+                    memcpy(&xd[t * n_channels[n / 2]], &xi[t * N_CHANNELS], n_channels[n / 2] * sizeof(int16_t));
+                }
+                hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_batch_interleaved(xd, n_channels[n / 2], x_lens[n % 2],
+                                                                               &fir[f], yi, X_LEN),
+                          "Interleaved batch filtering failed");
+                for (c = 0; c < n_channels[n / 2]; c += 7) {
+                    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(xp[c], x_lens[n % 2], &fir[f], y_ref, X_LEN),
+                              "Compact filtering failed");
+                    for (t = 0; t < x_lens[n % 2]; t++) {
+                        hdsp_test(fabs(yi[t * n_channels[n / 2] + c] - y_ref[t]) < 1e-6, "Interleaved batch differs");
+                    }
+                }
+            }
+        }
+    }
+    hdsp_test(hdsp_simd_set(isa_default) == HDSP_STATUS_OK, "Failed to restore instruction set");
+
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_batch(xp, N_CHANNELS, X_LEN, &fir[0], yp, X_LEN - 1),
+              "Short output should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_batch_interleaved(xi, 0, X_LEN, &fir[0], yi, X_LEN),
+              "No channels should fail");
+    hdsp_fir_deinit(&fir[0]);
+    hdsp_fir_deinit(&fir[1]);
+    hdsp_fir_deinit(&fir[2]);
+
+    return 0;
+}
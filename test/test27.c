@@ -0,0 +1,178 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test27.c - Test scheduler of per-stream DSP jobs
+ */
+
+
+#include <stdatomic.h>
+
+#include "hdsp.h"
+
+#define N_STREAMS 200
+#define N_JOBS 50
+#define X_LEN 441
+
+struct job {
+    size_t stream;
+    size_t seq;
+};
+
+static struct job jobs[N_STREAMS][N_JOBS];
+static atomic_int in_flight[N_STREAMS];
+static size_t last_seq[N_STREAMS];
+static atomic_int errors;
+static atomic_int completed;
+static atomic_int release;
+
+static void run(void *arg)
+{
+    struct job *job = arg;
+    volatile double v = 0.0;
+    int k = 0;
+
+    if (atomic_exchange(&in_flight[job->stream], 1) != 0) {
+        atomic_fetch_add(&errors, 1);
+    }
+    if (last_seq[job->stream] + 1 != job->seq) {
+        atomic_fetch_add(&errors, 1);
+    }
+    last_seq[job->stream] = job->seq;
+    for (k = 0; k < 1000; k++) {
+        v += sin(k);
+    }
+    atomic_store(&in_flight[job->stream], 0);
+}
+
+static void done(void *arg)
+{
+    atomic_fetch_add(&completed, 1);
+}
+
+static void block(void *arg)
+{
+    while (!atomic_load(&release)) {
+    }
+}
+
+int main(int argc, char **argv) {
+
+    hdsp_sched_t *sched = NULL;
+    hdsp_sched_stream_t *streams[N_STREAMS] = {0};
+    hdsp_sched_stream_t *stream = NULL;
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    hdsp_sched_fir_job_t fir_job = {0};
+    hdsp_sched_resample_job_t resample_jobs[10] = {{0}};
+    hdsp_resampler_t resampler = {0};
+    hdsp_resampler_t resampler_ref = {0};
+    int16_t x[10 * X_LEN] = {0};
+    double y[10 * X_LEN * 2] = {0};
+    double y_ref[10 * X_LEN * 2] = {0};
+    size_t s = 0, j = 0, n = 0, n_ref = 0, written = 0;
+
+    for (j = 0; j < 10 * X_LEN; j++) {
+        x[j] = 8000 * sin((double)j * 2 * M_PI * 440 / 44100) + (int16_t) (j * 7919 % 2000) - 1000;
+    }
+
+    sched = hdsp_sched_create(4);
+    hdsp_test(sched != NULL && hdsp_sched_threads(sched) == 4, "Scheduler create failed");
+
+    // jobs of a stream run in order, never concurrently, all are completed
+    for (s = 0; s < N_STREAMS; s++) {
+        streams[s] = hdsp_sched_stream_create(sched, N_JOBS);
+        hdsp_test(streams[s] != NULL, "Stream create failed");
+    }
+    for (j = 0; j < N_JOBS; j++) {
+        for (s = 0; s < N_STREAMS; s++) {
+            jobs[s][j].stream = s;
+            jobs[s][j].seq = j + 1;
+            hdsp_test(HDSP_STATUS_OK == hdsp_sched_submit(streams[s], run, done, &jobs[s][j]), "Submit failed");
+        }
+    }
+    hdsp_sched_wait(sched);
+    hdsp_test(atomic_load(&errors) == 0, "Jobs of a stream out of order or concurrent");
+    hdsp_test(atomic_load(&completed) == N_STREAMS * N_JOBS, "Not all jobs completed");
+    for (s = 0; s < N_STREAMS; s++) {
+        hdsp_test(last_seq[s] == N_JOBS, "Not all jobs run");
+        hdsp_sched_stream_destroy(streams[s]);
+    }
+
+    // full queue
+    stream = hdsp_sched_stream_create(sched, 1);
+    hdsp_test(stream != NULL, "Stream create failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_sched_submit(stream, block, NULL, NULL), "Submit failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_sched_submit(stream, block, NULL, NULL), "Full queue should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_sched_submit(stream, NULL, NULL, NULL), "No job should fail");
+    atomic_store(&release, 1);
+    hdsp_sched_stream_destroy(stream);
+
+    // FIR job
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_init_from_filter(&fir, &filter), "Compact filter init failed");
+    stream = hdsp_sched_stream_create(sched, 10);
+    fir_job = (hdsp_sched_fir_job_t) {x, X_LEN, &fir, y, X_LEN, HDSP_STATUS_FALSE};
+    hdsp_test(HDSP_STATUS_OK == hdsp_sched_submit(stream, hdsp_sched_run_fir, NULL, &fir_job), "Submit failed");
+    hdsp_sched_wait(sched);
+    hdsp_test(fir_job.status == HDSP_STATUS_OK, "FIR job failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x, X_LEN, &filter, y_ref, X_LEN), "FIR filtering failed");
+    hdsp_test_vectors_equal_double(y, y_ref, X_LEN);
+
+    // resampling jobs keep state of resampler from frame to frame
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler, 44100, 48000), "Resampler init failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&resampler_ref, 44100, 48000), "Resampler init failed");
+    for (j = 0; j < 10; j++) {
+        resample_jobs[j] = (hdsp_sched_resample_job_t) {&x[j * X_LEN], X_LEN, &resampler, &y[j * 2 * X_LEN], 2 * X_LEN,
+                                                        0, HDSP_STATUS_FALSE};
+        hdsp_test(HDSP_STATUS_OK == hdsp_sched_submit(stream, hdsp_sched_run_resample, NULL, &resample_jobs[j]),
+                  "Submit failed");
+    }
+    hdsp_sched_stream_destroy(stream);
+    for (j = 0; j < 10; j++) {
+        hdsp_test(resample_jobs[j].status == HDSP_STATUS_OK, "Resampling job failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_resample(&x[j * X_LEN], X_LEN, &resampler_ref, &y_ref[n_ref],
+                                                  20 * X_LEN - n_ref, &written), "Resampling failed");
+        hdsp_test(written == resample_jobs[j].y_written, "Wrong number of samples");
+        hdsp_test_vectors_equal_double((&y[j * 2 * X_LEN]), (&y_ref[n_ref]), written);
+        n = n + resample_jobs[j].y_written;
+        n_ref = n_ref + written;
+    }
+    hdsp_resampler_deinit(&resampler);
+    hdsp_resampler_deinit(&resampler_ref);
+    hdsp_fir_deinit(&fir);
+
+    hdsp_sched_destroy(sched);
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test28.c - Test lock-free frame rings
+ */
+
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "hdsp.h"
+
+#define FRAME_LEN 160
+#define N_FRAMES 20000
+#define N_PRODUCERS 4
+
+static hdsp_ring_t *ring;
+
+/**
+ * Writes frames straight into ring, frame k of producer p is filled with its number and k.
+ */
+static void *producer(void *arg)
+{
+    size_t p = (size_t) arg, k = 0, i = 0;
+    int16_t *frame = NULL;
+
+    for (k = 0; k < N_FRAMES; k++) {
+        while (!(frame = hdsp_ring_reserve(ring))) {
+            sched_yield();
+        }
+        frame[0] = p;
+        for (i = 1; i < FRAME_LEN; i++) {
+            frame[i] = (int16_t) (k + i);
+        }
+        hdsp_ring_commit(ring, frame, FRAME_LEN * sizeof(int16_t));
+    }
+    return NULL;
+}
+
+/**
+ * Consumes n_producers * N_FRAMES frames, checks frames of each producer come in order and intact.
+ * Returns the number of errors.
+ */
+static size_t consume(size_t n_producers)
+{
+    size_t next[N_PRODUCERS] = {0}, n = 0, len = 0, errors = 0, i = 0, p = 0;
+    int16_t *frame = NULL;
+
+    while (n < n_producers * N_FRAMES) {
+        frame = hdsp_ring_peek(ring, &len);
+        if (!frame) {
+            sched_yield();
+            continue;
+        }
+        p = frame[0];
+        if (p >= n_producers || len != FRAME_LEN * sizeof(int16_t)) {
+            errors++;
+        } else {
+            for (i = 1; i < FRAME_LEN; i++) {
+                errors += (frame[i] != (int16_t) (next[p] + i));
+            }
+            next[p]++;
+        }
+        hdsp_ring_release(ring);
+        n++;
+    }
+    return errors;
+}
+
+int main(int argc, char **argv) {
+
+    pthread_t threads[N_PRODUCERS];
+    int16_t x[FRAME_LEN] = {0};
+    int16_t y[6 * FRAME_LEN] = {0};
+    int16_t y_ref[6 * FRAME_LEN] = {0};
+    int16_t *frame = NULL, *frame2 = NULL;
+    size_t k = 0, len = 0;
+
+    // single thread: full, empty, order, copying push/pop
+    ring = hdsp_ring_create(3, FRAME_LEN * sizeof(int16_t), HDSP_RING_SPSC);
+    hdsp_test(ring != NULL && hdsp_ring_capacity(ring) == 4, "Ring create failed");
+    hdsp_test(hdsp_ring_peek(ring, &len) == NULL, "Ring should be empty");
+    for (k = 0; k < 4; k++) {
+        x[0] = k;
+        hdsp_test(HDSP_STATUS_OK == hdsp_ring_push(ring, x, sizeof(x)), "Push failed");
+    }
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_ring_push(ring, x, sizeof(x)), "Ring should be full");
+    hdsp_test(hdsp_ring_reserve(ring) == NULL, "Ring should be full");
+    for (k = 0; k < 4; k++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_ring_pop(ring, x, &len), "Pop failed");
+        hdsp_test(x[0] == (int16_t) k && len == sizeof(x), "Wrong frame");
+    }
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_ring_pop(ring, x, &len), "Ring should be empty");
+
+    // short frame: only its bytes are copied out
+    x[0] = 1;
+    hdsp_test(HDSP_STATUS_OK == hdsp_ring_push(ring, x, sizeof(x[0])), "Push failed");
+    x[0] = x[1] = 7;
+    hdsp_test(HDSP_STATUS_OK == hdsp_ring_pop(ring, x, &len), "Pop failed");
+    hdsp_test(x[0] == 1 && x[1] == 7 && len == sizeof(x[0]), "Pop should copy the pushed length only");
+
+    // zero-copy: frame is decoded into ring and upsampled in place
+    frame = hdsp_ring_reserve(ring);
+    hdsp_test(frame != NULL && ((uintptr_t) frame % HDSP_RING_ALIGN) == 0, "Reserve failed");
+    for (k = 0; k < FRAME_LEN; k++) {
+        frame[k] = x[k] = (int16_t) (k * 100);
+    }
+    hdsp_ring_commit(ring, frame, FRAME_LEN * sizeof(int16_t));
+    frame2 = hdsp_ring_peek(ring, &len);
+    hdsp_test(frame2 == frame && len == FRAME_LEN * sizeof(int16_t), "Peek should return the committed frame");
+    hdsp_test(HDSP_STATUS_OK == hdsp_upsample_int16(frame2, len / sizeof(int16_t), 6, y, 6 * FRAME_LEN),
+              "Upsampling failed");
+    hdsp_ring_release(ring);
+    hdsp_test(HDSP_STATUS_OK == hdsp_upsample_int16(x, FRAME_LEN, 6, y_ref, 6 * FRAME_LEN), "Upsampling failed");
+    hdsp_test(0 == memcmp(y, y_ref, sizeof(y)), "Upsampled frames differ");
+    hdsp_ring_destroy(ring);
+
+    // single producer thread
+    ring = hdsp_ring_create(16, FRAME_LEN * sizeof(int16_t), HDSP_RING_SPSC);
+    hdsp_test(ring != NULL, "Ring create failed");
+    hdsp_test(0 == pthread_create(&threads[0], NULL, producer, (void *) 0), "Thread create failed");
+    hdsp_test(0 == consume(1), "SPSC frames out of order or corrupted");
+    pthread_join(threads[0], NULL);
+    hdsp_ring_destroy(ring);
+
+    // many producer threads
+    ring = hdsp_ring_create(16, FRAME_LEN * sizeof(int16_t), HDSP_RING_MPSC);
+    hdsp_test(ring != NULL, "Ring create failed");
+    for (k = 0; k < N_PRODUCERS; k++) {
+        hdsp_test(0 == pthread_create(&threads[k], NULL, producer, (void *) k), "Thread create failed");
+    }
+    hdsp_test(0 == consume(N_PRODUCERS), "MPSC frames out of order or corrupted");
+    for (k = 0; k < N_PRODUCERS; k++) {
+        pthread_join(threads[k], NULL);
+    }
+    hdsp_test(hdsp_ring_peek(ring, &len) == NULL, "Ring should be empty");
+    hdsp_ring_destroy(ring);
+
+    hdsp_test(hdsp_ring_create(0, 1, HDSP_RING_SPSC) == NULL, "Empty ring should fail");
+
+    return 0;
+}
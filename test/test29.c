@@ -0,0 +1,196 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test29.c - Test saturating, rounding and dithering sample format conversions
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 1003 // not a multiple of vector width, to run tails too
+#define DITHER_LEN 100000
+
+/**
+ * Expected value of x rounded half to even and saturated to [lo, hi] (NaN to 0).
+ */
+static double ref(double x, double lo, double hi)
+{
+    if (isnan(x)) {
+        return 0;
+    }
+    if (x <= lo) {
+        return lo;
+    }
+    if (x >= hi) {
+        return hi;
+    }
+    return nearbyint(x);
+}
+
+int main(int argc, char **argv) {
+
+    static double xd[X_LEN] = {0};
+    static float xf[X_LEN] = {0};
+    static int16_t y16[X_LEN] = {0}, y16_ref[X_LEN] = {0};
+    static int32_t y32[X_LEN] = {0}, x32[X_LEN] = {0};
+    static int16_t x16[X_LEN] = {0};
+    static double yd64[X_LEN] = {0};
+    static float yf32[X_LEN] = {0};
+    static double dd[DITHER_LEN] = {0};
+    static int16_t yd[DITHER_LEN] = {0}, yd_ref[DITHER_LEN] = {0};
+    static const double special[] = {0.5, 1.5, 2.5, -0.5, -2.5, 32766.5, 32767.49, 32767.5, -32768.5, -32769.0,
+                                     40000.0, -40000.0, 1e10, -1e10, 2147483647.4, 2147483647.6, -2147483648.6,
+                                     3e9, -3e9, 2147483520.0};
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    hdsp_dither_t dither = {0};
+    size_t i = 0, k = 0, n_special = sizeof(special) / sizeof(special[0]);
+    double mean = 0.0;
+    int ok = 0;
+
+    srand(29);
+    for (k = 0; k < X_LEN; k++) {
+        xd[k] = ((double) rand() / RAND_MAX - 0.5) * 80000.0;
+        if (k % 7 == 0) {
+            xd[k] = special[(k / 7) % n_special];
+        }
+        if (k % 101 == 0) {
+            xd[k] = (k % 202) ? NAN : -INFINITY;
+        }
+        xf[k] = (float) xd[k];
+    }
+    xd[X_LEN - 1] = INFINITY;
+    xf[X_LEN - 1] = INFINITY;
+
+    for (k = 0; k < DITHER_LEN; k++) {
+        dd[k] = 0.25;
+    }
+
+    for (i = 0; i < sizeof(isa) / sizeof(isa[0]); i++) {
+        if (HDSP_STATUS_OK != hdsp_simd_set(isa[i])) {
+            continue;
+        }
+
+        hdsp_double_2_int16_sat(xd, X_LEN, y16, NULL);
+        ok = 1;
+        for (k = 0; k < X_LEN; k++) {
+            ok = ok && (y16[k] == ref(xd[k], INT16_MIN, INT16_MAX));
+        }
+        hdsp_test(ok, "hdsp_double_2_int16_sat failed");
+
+        hdsp_float_2_int16_sat(xf, X_LEN, y16, NULL);
+        ok = 1;
+        for (k = 0; k < X_LEN; k++) {
+            ok = ok && (y16[k] == ref(xf[k], INT16_MIN, INT16_MAX));
+        }
+        hdsp_test(ok, "hdsp_float_2_int16_sat failed");
+
+        hdsp_double_2_int32_sat(xd, X_LEN, y32);
+        ok = 1;
+        for (k = 0; k < X_LEN; k++) {
+            ok = ok && (y32[k] == ref(xd[k], INT32_MIN, INT32_MAX));
+        }
+        hdsp_test(ok, "hdsp_double_2_int32_sat failed");
+
+        hdsp_float_2_int32_sat(xf, X_LEN, y32);
+        ok = 1;
+        for (k = 0; k < X_LEN; k++) {
+            ok = ok && (y32[k] == ref(xf[k], INT32_MIN, INT32_MAX));
+        }
+        hdsp_test(ok, "hdsp_float_2_int32_sat failed");
+
+        // dither: unbiased (mean of output follows input below 1 LSB), same noise with any instruction set
+        hdsp_dither_init(&dither, 29);
+        hdsp_double_2_int16_sat(dd, DITHER_LEN - 5, yd, &dither);
+        hdsp_double_2_int16_sat(dd, 5, &yd[DITHER_LEN - 5], &dither);
+        mean = 0.0;
+        ok = 1;
+        for (k = 0; k < DITHER_LEN; k++) {
+            mean += yd[k];
+            ok = ok && (yd[k] >= -1 && yd[k] <= 1);
+        }
+        mean /= DITHER_LEN;
+        hdsp_test(ok && fabs(mean - 0.25) < 0.01, "Dithered output is biased");
+        if (isa[i] == HDSP_SIMD_NONE) {
+            memcpy(yd_ref, yd, sizeof(yd));
+        }
+        hdsp_test(0 == memcmp(yd, yd_ref, sizeof(yd)), "Dither differs between instruction sets");
+
+        hdsp_dither_init(&dither, 29);
+        hdsp_float_2_int16_sat(xf, X_LEN, y16, &dither);
+        if (isa[i] == HDSP_SIMD_NONE) {
+            memcpy(y16_ref, y16, sizeof(y16));
+        }
+        hdsp_test(0 == memcmp(y16, y16_ref, sizeof(y16)), "Float dither differs between instruction sets");
+        ok = 1;
+        for (k = 0; k < X_LEN; k++) {
+            ok = ok && (abs(y16[k] - (int) ref(xf[k], INT16_MIN, INT16_MAX)) <= 1);
+        }
+        hdsp_test(ok, "Dither larger than 1 LSB");
+    }
+    hdsp_simd_set(isa_default);
+
+    // integer and widening conversions
+    for (k = 0; k < X_LEN; k++) {
+        x32[k] = (int32_t) ((k % 2) ? k * 4000003u : -k * 3999971u);
+        x16[k] = (int16_t) (k * 77);
+    }
+    hdsp_int32_2_int16_sat(x32, X_LEN, y16);
+    ok = 1;
+    for (k = 0; k < X_LEN; k++) {
+        ok = ok && (y16[k] == ref(x32[k], INT16_MIN, INT16_MAX));
+    }
+    hdsp_test(ok, "hdsp_int32_2_int16_sat failed");
+
+    hdsp_int32_2_double(x32, X_LEN, yd64);
+    hdsp_int32_2_float(x32, X_LEN, yf32);
+    ok = 1;
+    for (k = 0; k < X_LEN; k++) {
+        ok = ok && (yd64[k] == x32[k]) && (yf32[k] == (float) x32[k]);
+    }
+    hdsp_test(ok, "Conversion of int32 failed");
+
+    hdsp_int16_2_double(x16, X_LEN, yd64);
+    hdsp_int16_2_float(x16, X_LEN, yf32);
+    ok = 1;
+    for (k = 0; k < X_LEN; k++) {
+        ok = ok && (yd64[k] == x16[k]) && (yf32[k] == x16[k]);
+    }
+    hdsp_test(ok, "Conversion of int16 failed");
+
+    hdsp_float_2_double(xf, X_LEN, yd64);
+    hdsp_double_2_float(yd64, X_LEN, yf32);
+    hdsp_test(0 == memcmp(xf, yf32, sizeof(xf)), "Conversion between float and double failed");
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test30.c - Test interleaved multichannel upsampling, downsampling and resampling
+ */
+
+
+#include "hdsp.h"
+
+#define CHANNELS_MAX 5
+#define FRAME_LEN 441
+#define N_FRAMES 4
+#define Y_LEN_MAX (6 * FRAME_LEN + 1)
+
+/**
+ * Resample N_FRAMES frames of n_channels interleaved channels at once and each channel on its own,
+ * compare output frame by frame.
+ */
+static void test_resample(uint32_t fs_in_hz, uint32_t fs_out_hz, size_t n_channels)
+{
+    static int16_t xi[FRAME_LEN * CHANNELS_MAX], x[CHANNELS_MAX][FRAME_LEN];
+    static double yi[Y_LEN_MAX * CHANNELS_MAX], y[CHANNELS_MAX][Y_LEN_MAX], yc[Y_LEN_MAX];
+    hdsp_resampler_t ri = {0}, r[CHANNELS_MAX] = {0};
+    size_t c = 0, t = 0, f = 0, yi_written = 0, y_written = 0;
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init_interleaved(&ri, fs_in_hz, fs_out_hz, n_channels),
+              "Interleaved resampler init failed");
+    for (c = 0; c < n_channels; c++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_resampler_init(&r[c], fs_in_hz, fs_out_hz), "Resampler init failed");
+    }
+    if (n_channels > 1) {
+        hdsp_test(HDSP_STATUS_FALSE == hdsp_resample(x[0], FRAME_LEN, &ri, yc, Y_LEN_MAX, &y_written),
+                  "Mono resampling of interleaved resampler should fail");
+    }
+
+    for (f = 0; f < N_FRAMES; f++) {
+        for (c = 0; c < n_channels; c++) {
+            for (t = 0; t < FRAME_LEN; t++) {
+                x[c][t] = 10000 * sin(2 * M_PI * (300.0 + 700.0 * c) * (f * FRAME_LEN + t) / fs_in_hz) + 50 * c;
+                xi[t * n_channels + c] = x[c][t];
+            }
+        }
+        hdsp_test(HDSP_STATUS_OK == hdsp_resample_interleaved(xi, FRAME_LEN, &ri, yi, Y_LEN_MAX, &yi_written),
+                  "Interleaved resampling failed");
+        for (c = 0; c < n_channels; c++) {
+            hdsp_test(HDSP_STATUS_OK == hdsp_resample(x[c], FRAME_LEN, &r[c], y[c], Y_LEN_MAX, &y_written),
+                      "Resampling failed");
+            hdsp_test(y_written == yi_written, "Different number of output frames");
+            for (t = 0; t < y_written; t++) {
+                yc[t] = yi[t * n_channels + c];
+            }
+            hdsp_test_vectors_equal_almost_double(yc, y[c], y_written);
+        }
+    }
+
+    hdsp_resampler_deinit(&ri);
+    for (c = 0; c < n_channels; c++) {
+        hdsp_resampler_deinit(&r[c]);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    int16_t x[2 * FRAME_LEN] = {0}, y[2 * 6 * FRAME_LEN] = {0};
+    int16_t xc[FRAME_LEN] = {0}, yc[6 * FRAME_LEN] = {0}, y_ref[6 * FRAME_LEN] = {0};
+    double xd[3 * FRAME_LEN] = {0}, yd[3 * FRAME_LEN] = {0};
+    float xf[3 * FRAME_LEN] = {0}, yf[3 * FRAME_LEN] = {0};
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, HDSP_SIMD_SSE2, HDSP_SIMD_AVX2, HDSP_SIMD_AVX512, HDSP_SIMD_NEON};
+    hdsp_simd_t isa_default = hdsp_simd_get();
+    size_t c = 0, t = 0, i = 0, n_channels = 0;
+
+    // stereo zero insertion, each channel as by hdsp_upsample_int16
+    for (t = 0; t < 2 * FRAME_LEN; t++) {
+        x[t] = (int16_t) (t * 37 - 9000);
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_upsample_int16_interleaved(x, 2, FRAME_LEN, 6, y, 6 * FRAME_LEN),
+              "Interleaved upsampling failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_upsample_int16_interleaved(x, 2, FRAME_LEN, 6, y, 6 * FRAME_LEN - 1),
+              "Interleaved upsampling should fail");
+    for (c = 0; c < 2; c++) {
+        for (t = 0; t < FRAME_LEN; t++) {
+            xc[t] = x[2 * t + c];
+        }
+        hdsp_test(HDSP_STATUS_OK == hdsp_upsample_int16(xc, FRAME_LEN, 6, y_ref, 6 * FRAME_LEN), "Upsampling failed");
+        for (t = 0; t < 6 * FRAME_LEN; t++) {
+            yc[t] = y[2 * t + c];
+        }
+        hdsp_test_vectors_equal(yc, y_ref, 6 * FRAME_LEN);
+    }
+
+    // 3 channels, every 4th frame
+    for (t = 0; t < 3 * FRAME_LEN; t++) {
+        xd[t] = t * 0.5;
+        xf[t] = t * 0.25f;
+        x[t % (2 * FRAME_LEN)] = (int16_t) t;
+    }
+    hdsp_test(HDSP_STATUS_OK == hdsp_downsample_double_interleaved(xd, 3, FRAME_LEN, 4, yd, FRAME_LEN / 4),
+              "Interleaved downsampling failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_downsample_float_interleaved(xf, 3, FRAME_LEN, 4, yf, FRAME_LEN / 4),
+              "Interleaved downsampling failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_downsample_int16_interleaved(x, 2, FRAME_LEN, 4, y, FRAME_LEN / 4),
+              "Interleaved downsampling failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_downsample_int16_interleaved(x, 2, FRAME_LEN, 4, y, FRAME_LEN / 4 + 1),
+              "Interleaved downsampling should fail");
+    for (t = 0; t < FRAME_LEN / 4; t++) {
+        for (c = 0; c < 3; c++) {
+            hdsp_test(yd[3 * t + c] == xd[3 * 4 * t + c] && yf[3 * t + c] == xf[3 * 4 * t + c], "Wrong frame");
+        }
+        for (c = 0; c < 2; c++) {
+            hdsp_test(y[2 * t + c] == x[2 * 4 * t + c], "Wrong frame");
+        }
+    }
+
+    // resampling: stereo (shuffled taps) and odd channel counts (vector and scalar channels) with each kernel
+    for (i = 0; i < sizeof(isa) / sizeof(isa[0]); i++) {
+        if (HDSP_STATUS_OK != hdsp_simd_set(isa[i])) {
+            continue;
+        }
+        for (n_channels = 1; n_channels <= CHANNELS_MAX; n_channels++) {
+            test_resample(44100, 48000, n_channels);
+            test_resample(8000, 48000, n_channels);
+            test_resample(48000, 16000, n_channels);
+        }
+    }
+    hdsp_simd_set(isa_default);
+
+    return 0;
+}
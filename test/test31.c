@@ -0,0 +1,181 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test31.c - Test strided views in convolution, FIR filtering and conversions
+ */
+
+
+#include "hdsp.h"
+
+#define X_LEN 3000
+#define M 6
+#define H_LEN 601
+
+int main(int argc, char **argv) {
+
+    static int16_t x[2 * X_LEN], xc[X_LEN], xd[X_LEN / M], y16[2 * X_LEN], y16_ref[X_LEN];
+    static double xs[2 * X_LEN], y[2 * (X_LEN + H_LEN)], y_ref[X_LEN + H_LEN], yc[X_LEN + H_LEN], h[H_LEN];
+    static float yf[X_LEN];
+    static int32_t y32[2 * X_LEN];
+    static int16_t frames[2 * X_LEN];
+    hdsp_simd_t isa[] = {HDSP_SIMD_NONE, hdsp_simd_get()};
+    hdsp_conv_type_t types[] = {HDSP_CONV_TYPE_FULL, HDSP_CONV_TYPE_SAME, HDSP_CONV_TYPE_VALID};
+    hdsp_filter_t filter = {0};
+    hdsp_fir_t fir = {0};
+    hdsp_dither_t dither = {0};
+    hdsp_view_t v = {0};
+    size_t t = 0, i = 0, k = 0, n = 0, y_written = 0;
+
+    srand(31);
+    for (t = 0; t < X_LEN; t++) {
+        x[2 * t] = 8000 * sin(2 * M_PI * 440 * t / 48000.0);
+        x[2 * t + 1] = rand() % 20000 - 10000;
+        xc[t] = x[2 * t + 1];
+        xs[2 * t] = 1e5 * sin(t * 0.01);
+        xs[2 * t + 1] = 40000 * sin(t * 0.003) + 0.5;
+    }
+    for (t = 0; t < H_LEN; t++) {
+        h[t] = (double) rand() / RAND_MAX - 0.5;
+    }
+
+    // views
+    v = hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16);
+    hdsp_test(v.stride == 2 && v.len == X_LEN && ((int16_t *) v.data)[0] == x[1], "Channel view failed");
+    v = hdsp_view_slice(hdsp_view_decimate(v, M), 3, 10);
+    hdsp_test(v.len == 10 && v.stride == 2 * M && ((int16_t *) v.data)[0] == x[2 * 3 * M + 1], "View failed");
+    hdsp_test(hdsp_view_slice(v, 5, 6).data == NULL, "Slice past the end should be empty");
+    hdsp_test(hdsp_view_channel(x, 2, X_LEN, 2, HDSP_SAMPLE_INT16).data == NULL, "No such channel");
+    hdsp_test(hdsp_view_decimate(hdsp_view(x, 2 * X_LEN, HDSP_SAMPLE_INT16), 0).data == NULL, "Factor 0");
+
+    // conversions: channel of interleaved doubles to contiguous int16 with dither, as contiguous one
+    for (t = 0; t < X_LEN; t++) {
+        y[t] = xs[2 * t + 1];
+    }
+    hdsp_dither_init(&dither, 31);
+    hdsp_double_2_int16_sat(y, X_LEN, y16_ref, &dither);
+    hdsp_dither_init(&dither, 31);
+    hdsp_test(HDSP_STATUS_OK == hdsp_convert_view(hdsp_view_channel(xs, 2, X_LEN, 1, HDSP_SAMPLE_DOUBLE),
+                                                  hdsp_view(y16, X_LEN, HDSP_SAMPLE_INT16), &dither),
+              "Conversion failed");
+    hdsp_test_vectors_equal(y16, y16_ref, X_LEN);
+    // int16 channel to float, float to int32 channel of interleaved int32
+    hdsp_test(HDSP_STATUS_OK == hdsp_convert_view(hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16),
+                                                  hdsp_view(yf, X_LEN, HDSP_SAMPLE_FLOAT), NULL),
+              "Conversion failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_convert_view(hdsp_view(yf, X_LEN, HDSP_SAMPLE_FLOAT),
+                                                  hdsp_view_channel(y32, 2, X_LEN, 0, HDSP_SAMPLE_INT32), NULL),
+              "Conversion failed");
+    for (t = 0; t < X_LEN; t++) {
+        hdsp_test(yf[t] == xc[t] && y32[2 * t] == xc[t], "Wrong converted sample");
+    }
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_convert_view(hdsp_view(yf, X_LEN, HDSP_SAMPLE_FLOAT),
+                                                     hdsp_view(y16, X_LEN - 1, HDSP_SAMPLE_INT16), NULL),
+              "Conversion to shorter view should fail");
+
+    for (i = 0; i < sizeof(isa) / sizeof(isa[0]); i++) {
+        hdsp_simd_set(isa[i]);
+
+        // FIR: decimated channel filtered into channel of interleaved doubles, as downsample + filter
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000), "Filter failed");
+        fir = hdsp_fir_view(&filter);
+        hdsp_test(HDSP_STATUS_OK == hdsp_downsample_int16(xc, X_LEN, M, xd, X_LEN / M), "Downsampling failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_compact(xd, X_LEN / M, &fir, y_ref, X_LEN / M), "Filter failed");
+        v = hdsp_view_decimate(hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16), M);
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_view(v, &fir, hdsp_view_channel(y, 2, X_LEN / M, 1,
+                                                                                     HDSP_SAMPLE_DOUBLE)),
+                  "View filter failed");
+        for (t = 0; t < X_LEN / M; t++) {
+            yc[t] = y[2 * t + 1];
+        }
+        hdsp_test_vectors_equal_almost_double(yc, y_ref, X_LEN / M);
+
+        // straight into int16 frames
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_view(v, &fir, hdsp_view_channel(y16, 2, X_LEN / M, 0,
+                                                                                     HDSP_SAMPLE_INT16)),
+                  "View filter failed");
+        hdsp_double_2_int16_sat(y_ref, X_LEN / M, y16_ref, NULL);
+        for (t = 0; t < X_LEN / M; t++) {
+            hdsp_test(y16[2 * t] == y16_ref[t], "Wrong int16 output");
+        }
+        hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_view(hdsp_view(yf, X_LEN, HDSP_SAMPLE_FLOAT), &fir,
+                                                            hdsp_view(y, X_LEN, HDSP_SAMPLE_DOUBLE)),
+                  "Float input should fail");
+
+        // convolution of strided channel with long filter (in place for contiguous input, in blocks for views)
+        for (k = 0; k < sizeof(types) / sizeof(types[0]); k++) {
+            n = (types[k] == HDSP_CONV_TYPE_FULL) ? X_LEN + H_LEN - 1
+                : (types[k] == HDSP_CONV_TYPE_SAME) ? X_LEN : X_LEN - H_LEN + 1;
+            hdsp_test(HDSP_STATUS_OK == hdsp_conv_view(hdsp_view(xc, X_LEN, HDSP_SAMPLE_INT16), h, H_LEN, types[k],
+                                                       hdsp_view(y_ref, n, HDSP_SAMPLE_DOUBLE), &y_written)
+                      && y_written == n, "Convolution failed");
+            hdsp_test(HDSP_STATUS_OK == hdsp_conv_view(hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16), h, H_LEN,
+                                                       types[k], hdsp_view_channel(y, 2, n, 0, HDSP_SAMPLE_DOUBLE),
+                                                       &y_written) && y_written == n, "View convolution failed");
+            for (t = 0; t < n; t++) {
+                yc[t] = y[2 * t];
+            }
+            hdsp_test_vectors_equal_almost_double(yc, y_ref, n);
+            hdsp_test(HDSP_STATUS_FALSE == hdsp_conv_view(hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16), h,
+                                                          H_LEN, types[k], hdsp_view(y, n - 1, HDSP_SAMPLE_DOUBLE),
+                                                          &y_written), "Too short output should fail");
+        }
+        // same part of full convolution by hdsp_conv_same
+        hdsp_test(X_LEN == hdsp_conv_same(xc, X_LEN, h, H_LEN, y_ref), "Convolution failed");
+        hdsp_test(HDSP_STATUS_OK == hdsp_conv_view(hdsp_view_channel(x, 2, X_LEN, 1, HDSP_SAMPLE_INT16), h, H_LEN,
+                                                   HDSP_CONV_TYPE_SAME, hdsp_view(yc, X_LEN, HDSP_SAMPLE_DOUBLE),
+                                                   &y_written), "View convolution failed");
+        hdsp_test_vectors_equal_almost_double(yc, y_ref, X_LEN);
+    }
+
+    // output sharing samples with input: other channel of the same frames is fine, the same channel is not
+    memcpy(frames, x, sizeof(frames));
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_view(hdsp_view_channel(frames, 2, X_LEN, 1, HDSP_SAMPLE_INT16), &fir,
+                                                     hdsp_view_channel(frames, 2, X_LEN, 0, HDSP_SAMPLE_INT16)),
+              "Filtering into other channel failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_view(hdsp_view_channel(frames, 2, X_LEN, 1, HDSP_SAMPLE_INT16),
+                                                        &fir, hdsp_view_channel(frames, 2, X_LEN, 1,
+                                                                                HDSP_SAMPLE_INT16)),
+              "Filtering in place should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_conv_view(hdsp_view(frames, X_LEN, HDSP_SAMPLE_INT16), h, H_LEN,
+                                                  HDSP_CONV_TYPE_SAME, hdsp_view(&frames[X_LEN / 2], X_LEN,
+                                                                                 HDSP_SAMPLE_INT16), &y_written),
+              "Convolution into overlapping view should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_convert_view(hdsp_view(frames, X_LEN, HDSP_SAMPLE_INT16),
+                                                     hdsp_view(frames, X_LEN / 2, HDSP_SAMPLE_INT32), NULL),
+              "Conversion into overlapping view of other type should fail");
+    hdsp_test(HDSP_STATUS_OK == hdsp_convert_view(hdsp_view_channel(frames, 2, X_LEN, 0, HDSP_SAMPLE_INT16),
+                                                  hdsp_view_channel(frames, 2, X_LEN, 0, HDSP_SAMPLE_INT16), NULL),
+              "Conversion in place failed");
+
+    return 0;
+}
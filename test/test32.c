@@ -0,0 +1,141 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test32.c - Test runtime weighted least squares and Parks-McClellan lowpass designs
+ */
+
+
+#include "hdsp.h"
+
+#define N_SPECS 3
+
+static hdsp_filter_t filter;
+
+/**
+ * Returns 1 if filter meets spec, checks that filter is linear phase.
+ */
+static int test_meets_spec(const hdsp_lowpass_spec_t *spec)
+{
+    double passband_ripple_db = 0.0, stopband_attenuation_db = 0.0;
+
+    hdsp_test(filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Filter should be symmetric");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_lowpass_measure(&filter, spec, &passband_ripple_db,
+                                                                &stopband_attenuation_db),
+              "Measurement failed");
+    return passband_ripple_db <= spec->passband_ripple_db
+            && stopband_attenuation_db >= spec->stopband_attenuation_db;
+}
+
+int main(void)
+{
+    hdsp_lowpass_spec_t specs[N_SPECS] = {
+        {48000, 4000, 7140, 0.1, 60},
+        {44100, 18000, 20000, 0.01, 96},
+        {16000, 3400, 4000, 0.2, 70}
+    };
+    hdsp_lowpass_spec_t spec = {0};
+    size_t s = 0, n = 0, n_kaiser = 0, n_wls = 0, n_remez = 0;
+    double passband_ripple_db = 0.0, stopband_attenuation_db = 0.0, delta_p = 0.0, delta_s = 0.0, ratio = 0.0;
+
+    for (s = 0; s < N_SPECS; s++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_design_lowpass(&filter, &specs[s],
+                                                                   HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING),
+                  "Kaiser design failed");
+        hdsp_test(test_meets_spec(&specs[s]), "Kaiser design should meet the spec");
+        n_kaiser = filter.b_len;
+        hdsp_test(n_kaiser % 2 == 1, "Kaiser design should be of odd length");
+
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_design_lowpass(&filter, &specs[s],
+                                                                   HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES),
+                  "Least squares design failed");
+        hdsp_test(test_meets_spec(&specs[s]), "Least squares design should meet the spec");
+        hdsp_test(filter.design_method == HDSP_FILTER_DESIGN_METHOD_LEAST_SQUARES, "Wrong design method");
+        n_wls = filter.b_len;
+        hdsp_test(n_wls % 2 == 1, "Least squares design should be of odd length");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_wls(&filter, n_wls - 2, &specs[s]),
+                  "Least squares design failed");
+        hdsp_test(!test_meets_spec(&specs[s]), "Least squares design should be the shortest");
+
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_design_lowpass(&filter, &specs[s],
+                                                                   HDSP_FILTER_DESIGN_METHOD_REMEZ),
+                  "Remez design failed");
+        hdsp_test(test_meets_spec(&specs[s]), "Remez design should meet the spec");
+        hdsp_test(filter.design_method == HDSP_FILTER_DESIGN_METHOD_REMEZ, "Wrong design method");
+        n_remez = filter.b_len;
+        hdsp_test(n_remez % 2 == 1, "Remez design should be of odd length");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_remez(&filter, n_remez - 2, &specs[s]),
+                  "Remez design failed");
+        hdsp_test(!test_meets_spec(&specs[s]), "Remez design should be the shortest");
+
+        fprintf(stderr, "spec %zu: Kaiser %zu, least squares %zu, Remez %zu taps\n", s, n_kaiser, n_wls, n_remez);
+        hdsp_test(n_remez < n_wls && n_wls < n_kaiser, "Optimal designs should be shorter");
+    }
+
+    // equiripple: passband and stopband errors are in ratio of tolerances, for odd and even lengths
+    for (n = 50; n <= 51; n++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_remez(&filter, n, &specs[0]), "Remez design failed");
+        hdsp_test(filter.b_len == n && filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Wrong filter");
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_lowpass_measure(&filter, &specs[0], &passband_ripple_db,
+                                                                    &stopband_attenuation_db),
+                  "Measurement failed");
+        delta_p = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB_TO_LINEAR(passband_ripple_db);
+        delta_s = HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB_TO_LINEAR(stopband_attenuation_db);
+        ratio = HDSP_KAISER_FILTER_PASSBAND_RIPPLE_DB_TO_LINEAR(specs[0].passband_ripple_db);
+        ratio = ratio / HDSP_KAISER_FILTER_STOPBAND_ATTENUATION_DB_TO_LINEAR(specs[0].stopband_attenuation_db);
+        hdsp_test(fabs(delta_p / delta_s / ratio - 1.0) < 0.05, "Errors should be in ratio of tolerances");
+
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_wls(&filter, n, &specs[0]),
+                  "Least squares design failed");
+        hdsp_test(filter.b_len == n && filter.symmetry == HDSP_FILTER_SYMMETRY_EVEN, "Wrong filter");
+    }
+
+    // fixed length Remez design for default spec
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass(&filter, 45, 48000, 4000, HDSP_FILTER_DESIGN_METHOD_REMEZ),
+              "Remez design failed");
+    hdsp_test(filter.b_len == 45 && filter.design_method == HDSP_FILTER_DESIGN_METHOD_REMEZ, "Wrong filter");
+    hdsp_test(test_meets_spec(&specs[0]), "Remez design should meet default spec");
+
+    // invalid specs
+    spec = specs[0];
+    spec.stopband_freq_hz = spec.passband_freq_hz;
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_design_lowpass(&filter, &spec, HDSP_FILTER_DESIGN_METHOD_REMEZ),
+              "Design should fail");
+    spec.stopband_freq_hz = spec.fs_hz / 2;
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_init_lowpass_remez(&filter, 45, &spec), "Design should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_init_lowpass_wls(&filter, 45, &spec), "Design should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_init_lowpass_wls(&filter, 45, NULL), "Design should fail");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_filter_init_lowpass_remez(&filter, HDSP_FIR_FILTER_LEN_MAX + 1, &specs[0]),
+              "Design should fail");
+
+    return 0;
+}
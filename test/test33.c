@@ -0,0 +1,163 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ * test33.c - Test reference counted cache of designed filters
+ */
+
+
+#include <pthread.h>
+
+#include "hdsp.h"
+
+#define N_DESIGNS 4
+#define N_THREADS 4
+#define N_GETS 2000
+
+static hdsp_fir_cache_t *cache;
+static hdsp_fir_design_t designs[N_DESIGNS];
+static hdsp_filter_t filters[N_DESIGNS];
+
+/**
+ * Takes and releases designs in turns, checks taps are those of the design.
+ */
+static void *user(void *arg)
+{
+    size_t t = (size_t) arg, k = 0, d = 0;
+    const hdsp_fir_t *fir = NULL;
+
+    for (k = 0; k < N_GETS; k++) {
+        d = (k + t) % N_DESIGNS;
+        fir = hdsp_fir_cache_get(cache, &designs[d]);
+        hdsp_test(fir != NULL, "Cache get failed");
+        hdsp_test(fir->b_len == filters[d].b_len && 0 == memcmp(fir->b, filters[d].b, fir->b_len * sizeof(double)),
+                  "Wrong taps");
+        hdsp_fir_cache_put(cache, fir);
+    }
+    return NULL;
+}
+
+/**
+ * Evicts unreferenced designs while users get and put them.
+ */
+static void *trimmer(void *arg)
+{
+    size_t k = 0;
+
+    (void) arg;
+    for (k = 0; k < N_GETS / 10; k++) {
+        hdsp_fir_cache_trim(cache);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    hdsp_filter_t filter;
+    hdsp_fir_design_t design = {0};
+    const hdsp_fir_t *fir[N_DESIGNS] = {0}, *fir2 = NULL;
+    pthread_t threads[N_THREADS + 1];
+    size_t d = 0;
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_design_kaiser_opt(&designs[0], 48000, 4000), "Design failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_design_kaiser_opt(&designs[1], 48000, 8000), "Design failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_fir_design_kaiser_opt(&design, 44100, 4000), "Design should fail");
+    designs[2] = (hdsp_fir_design_t) {48000, 3800, 70, HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING,
+                                      HDSP_WINDOW_HAMMING, 0.0};
+    designs[3] = (hdsp_fir_design_t) {48000, 4000, 45, HDSP_FILTER_DESIGN_METHOD_REMEZ, HDSP_WINDOW_NONE, 0.0};
+    for (d = 0; d < N_DESIGNS; d++) {
+        hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_design(&filters[d], &designs[d]), "Design failed");
+    }
+
+    // design key of hdsp_fir_filter_init_lowpass_kaiser_opt gives its taps
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000), "Design failed");
+    hdsp_test(filter.b_len == filters[0].b_len, "Wrong length");
+    hdsp_test_vectors_equal_double(filter.b, filters[0].b, filter.b_len);
+
+    // hits share taps, beta doesn't matter without Kaiser window
+    cache = hdsp_fir_cache_create(2);
+    hdsp_test(cache != NULL, "Cache create failed");
+    fir[0] = hdsp_fir_cache_get(cache, &designs[0]);
+    hdsp_test(fir[0] != NULL && fir[0]->b_len == filters[0].b_len, "Cache get failed");
+    hdsp_test(0 == memcmp(fir[0]->b, filters[0].b, fir[0]->b_len * sizeof(double)), "Wrong taps");
+    hdsp_test(fir[0]->symmetry == HDSP_FILTER_SYMMETRY_EVEN && fir[0]->fs_hz == 48000, "Wrong filter");
+    hdsp_test(fir[0] == hdsp_fir_cache_get(cache, &designs[0]), "Design should be shared");
+    design = designs[3];
+    design.beta = 5.0;
+    fir[3] = hdsp_fir_cache_get(cache, &designs[3]);
+    hdsp_test(fir[3] == hdsp_fir_cache_get(cache, &design), "Design should be shared");
+    design = designs[0];
+    design.beta = 5.0;
+    fir2 = hdsp_fir_cache_get(cache, &design);
+    hdsp_test(fir2 != NULL && fir2 != fir[0], "Kaiser beta should make a different design");
+    hdsp_test(hdsp_fir_cache_size(cache) == 3, "Referenced designs should be kept over capacity");
+
+    // unreferenced designs are evicted, least recently used first
+    hdsp_fir_cache_put(cache, fir[0]);
+    hdsp_fir_cache_put(cache, fir[0]);
+    hdsp_fir_cache_put(cache, fir2);
+    hdsp_test(hdsp_fir_cache_size(cache) == 3, "Designs should be kept until there is need for room");
+    fir[1] = hdsp_fir_cache_get(cache, &designs[1]);
+    hdsp_test(fir[1] != NULL && hdsp_fir_cache_size(cache) == 2, "Unreferenced designs should be evicted");
+    fir2 = hdsp_fir_cache_get(cache, &design);
+    hdsp_test(fir2 != NULL && hdsp_fir_cache_size(cache) == 3, "Referenced designs should be kept");
+    hdsp_fir_cache_put(cache, fir2);
+    hdsp_test(hdsp_fir_cache_trim(cache) == 1 && hdsp_fir_cache_size(cache) == 2, "Trim should evict one design");
+    hdsp_fir_cache_put(cache, fir[1]);
+    hdsp_fir_cache_put(cache, fir[3]);
+    hdsp_fir_cache_put(cache, fir[3]);
+    hdsp_test(hdsp_fir_cache_trim(cache) == 2 && hdsp_fir_cache_size(cache) == 0, "Trim should evict all");
+
+    design.n = 0;
+    hdsp_test(hdsp_fir_cache_get(cache, &design) == NULL, "Invalid design should fail");
+    hdsp_test(hdsp_fir_cache_get(cache, NULL) == NULL, "Invalid design should fail");
+
+    // concurrent users and evictions
+    for (d = 0; d < N_THREADS; d++) {
+        hdsp_test(0 == pthread_create(&threads[d], NULL, user, (void *) d), "Thread create failed");
+    }
+    hdsp_test(0 == pthread_create(&threads[N_THREADS], NULL, trimmer, NULL), "Thread create failed");
+    for (d = 0; d <= N_THREADS; d++) {
+        pthread_join(threads[d], NULL);
+    }
+    hdsp_test(hdsp_fir_cache_size(cache) <= N_DESIGNS, "Too many designs");
+    hdsp_fir_cache_destroy(cache);
+
+    // process-wide cache
+    fir[0] = hdsp_fir_cache_get(NULL, &designs[0]);
+    hdsp_test(fir[0] != NULL && fir[0] == hdsp_fir_cache_get(NULL, &designs[0]), "Design should be shared");
+    hdsp_fir_cache_put(NULL, fir[0]);
+    hdsp_fir_cache_put(NULL, fir[0]);
+    hdsp_test(hdsp_fir_cache_size(NULL) == 1 && hdsp_fir_cache_trim(NULL) == 1, "Wrong process-wide cache");
+
+    return 0;
+}
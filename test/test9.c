@@ -0,0 +1,106 @@
+/*
+ * This file is part of libhdsp - Handy DSP routines library
+ *
+ * Copyright (c) 2023 Data And Signal - IT Solutions
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following
+ *   disclaimer in the documentation and/or other materials provided
+ *   with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Piotr Gregor <piotr@dataandsignal.com>
+ * Data And Signal - IT Solutions
+ *
+ * test9.c - Test polyphase interpolator (hdsp_interpolate against hdsp_upsample_int16 + hdsp_fir_filter)
+ */
+
+
+#include "hdsp.h"
+
+static void test_interp(hdsp_filter_t *filter, int16_t *x, size_t x_len, int upsample_factor)
+{
+    int16_t x_u[960] = {0};
+    double y_ref[960] = {0};
+    double y[960] = {0};
+    hdsp_interp_t interp = {0};
+    size_t y_len = x_len * upsample_factor;
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_upsample_int16(x, x_len, upsample_factor, x_u, y_len), "Upsampling failed");
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter(x_u, y_len, filter, y_ref, y_len), "FIR filtering failed");
+
+    hdsp_test(HDSP_STATUS_OK == hdsp_interp_init(&interp, filter, upsample_factor), "Interpolator init failed");
+    hdsp_test(interp.phase_offset[upsample_factor] == filter->b_len, "Wrong number of polyphase taps");
+    hdsp_test(HDSP_STATUS_OK == hdsp_interpolate(x, x_len, &interp, y, y_len), "Interpolation failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, y_len);
+
+    // Redo, interpolator has no state
+    hdsp_test(HDSP_STATUS_OK == hdsp_interpolate(x, x_len, &interp, y, y_len), "Interpolation failed");
+    hdsp_test_vectors_equal_almost_double(y, y_ref, y_len);
+}
+
+int main(int argc, char **argv) {
+
+    #define FRAME_LEN_MS 20
+    #define F_X 200
+
+    hdsp_filter_t filter = {0};
+    hdsp_interp_t interp = {0};
+    int16_t x[320] = {0};
+    double y[960] = {0};
+    int i = 0;
+
+    while (i < 320) {
+        x[i] = 10000 * sin((double)i * 2 * M_PI * F_X / 16000) + 100 * (i % 7);
+        i = i + 1;
+    }
+
+    // 8000 -> 48000
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 4000),
+              "Failed to init Kaiser lowpass 4000/48000 filter");
+    test_interp(&filter, x, FRAME_LEN_MS * 8000 / 1000, 6);
+
+    // 16000 -> 48000
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass_kaiser_opt(&filter, 48000, 8000),
+              "Failed to init Kaiser lowpass 8000/48000 filter");
+    test_interp(&filter, x, FRAME_LEN_MS * 16000 / 1000, 3);
+
+    // Even length filter, filter longer than a frame
+    hdsp_test(HDSP_STATUS_OK == hdsp_fir_filter_init_lowpass(&filter, 70, 48000, 3800,
+                                                             HDSP_FILTER_DESIGN_METHOD_SPECTRUM_SAMPLING),
+              "Failed to init spectrum sampling filter");
+    test_interp(&filter, x, 10, 6);
+    test_interp(&filter, x, 160, 6);
+
+    // No upsampling
+    test_interp(&filter, x, 320, 1);
+
+    // Bad input
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_interp_init(&interp, &filter, 0), "Should fail for upsample factor 0");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_interp_init(&interp, &filter, HDSP_INTERP_FACTOR_MAX + 1),
+              "Should fail for upsample factor too big");
+    hdsp_test(HDSP_STATUS_OK == hdsp_interp_init(&interp, &filter, 6), "Interpolator init failed");
+    hdsp_test(HDSP_STATUS_FALSE == hdsp_interpolate(x, 160, &interp, y, 959), "Should fail for wrong output length");
+
+    return 0;
+}